@@ -32,6 +32,239 @@ class Dycore {
 
   SArray<real,3,hs,hs,hs> weno_recon_lower;
 
+  // MPI domain decomposition in x and y, following the layout of the spam dycore's Parallel class. Each process owns
+  // global cells [i_beg,i_end] x [j_beg,j_end], and the process grid is periodic in both directions. With one
+  // process in a direction, halos in that direction wrap around locally without MPI
+  struct Parallel {
+    bool inner_mpi = false;
+    int  nranks    = 1;
+    int  myrank    = 0;
+    bool mainproc  = true;
+    int  nprocx    = 1;
+    int  nprocy    = 1;
+    int  px        = 0;
+    int  py        = 0;
+    int  i_beg     = 0;
+    int  i_end     = -1;
+    int  j_beg     = 0;
+    int  j_end     = -1;
+    int  nx_glob   = -1;
+    int  ny_glob   = -1;
+    real xlen_glob = -1;
+    real ylen_glob = -1;
+    SArray<int,1,2> x_neigh;   // Ranks of the left and right neighbors
+    SArray<int,1,2> y_neigh;   // Ranks of the lower and upper neighbors
+  };
+  Parallel par;
+
+  // MPI requests for the messages in flight between halo_exchange_begin and halo_exchange_end
+  struct HaloRequests {
+    MPI_Request req[8];
+    int         num = 0;
+  };
+
+  // Persistent arrays used by timeStep and compute_tendencies. These are sized in init() and are only re-sized
+  // when the coupler's dimensions change so that no device allocations happen inside the time loop
+  struct Workspace {
+    real5d state;          // State with halos
+    real5d tracers;        // Tracers with halos
+    real5d state_tmp;      // SSPRK3 intermediate state
+    real5d state_tend;     // State tendencies
+    real5d tracers_tmp;    // SSPRK3 intermediate tracers
+    real5d tracers_tend;   // Tracer tendencies (and FCT starting point on input to compute_tendencies)
+    real5d state_save;     // Low-storage SSPRK(4,3) state at the beginning of the step (no halos)
+    real5d tracers_save;   // Low-storage SSPRK(4,3) tracers at the beginning of the step (no halos)
+    real4d pressure;       // Pressure perturbation with halos
+    real5d state_flux_x;
+    real5d state_flux_y;
+    real5d state_flux_z;
+    real5d tracers_flux_x;
+    real5d tracers_flux_y;
+    real5d tracers_flux_z;
+    real4d dt4d;           // Per-cell stable time step for compute_time_step
+    // Packed halo buffers holding state, tracers, and pressure. The first dimension is the neighbor (0: left / lower,
+    // 1: right / upper), so each neighbor gets a single contiguous message. Only allocated for nprocx or nprocy > 1
+    real6d     halo_send_x;
+    real6d     halo_recv_x;
+    real6d     halo_send_y;
+    real6d     halo_recv_y;
+    realHost6d halo_send_x_host;
+    realHost6d halo_recv_x_host;
+    realHost6d halo_send_y_host;
+    realHost6d halo_recv_y_host;
+    // FCT-limited tracer fluxes on the x and y domain edges, exchanged so that both processes sharing an edge use the
+    // same limited flux. Same neighbor layout as the halo buffers
+    real5d     edge_send_x;
+    real5d     edge_recv_x;
+    real5d     edge_send_y;
+    real5d     edge_recv_y;
+    realHost5d edge_send_x_host;
+    realHost5d edge_recv_x_host;
+    realHost5d edge_send_y_host;
+    realHost5d edge_recv_y_host;
+    int    nx          = -1;
+    int    ny          = -1;
+    int    nz          = -1;
+    int    nens        = -1;
+    int    num_tracers = -1;
+    bool   low_storage = false;
+  };
+  Workspace workspace;
+
+  int num_workspace_allocations = 0;  // Total number of times the workspace was (re-)allocated
+  int num_time_loop_allocations = 0;  // Number of workspace (re-)allocations that happened inside timeStep
+
+
+
+  // Returns true if the "awfl_time_integrator" coupler option selects the two-register SSPRK(4,3) integrator
+  // ("ssprk43_ls") rather than the default SSPRK3 integrator ("ssprk3")
+  static bool use_low_storage_integrator( pam::PamCoupler const &coupler ) {
+    if (! coupler.option_exists("awfl_time_integrator")) return false;
+    auto integrator = coupler.get_option<std::string>("awfl_time_integrator");
+    if (integrator == "ssprk3"    ) return false;
+    if (integrator == "ssprk43_ls") return true;
+    endrun("ERROR: Invalid awfl_time_integrator option. Valid options are \"ssprk3\" and \"ssprk43_ls\"");
+    return false;
+  }
+
+
+
+  // Size the workspace for the coupler's current dimensions and time integrator. This does nothing if the
+  // workspace already matches them. Returns true if device allocations were performed
+  bool allocate_workspace( pam::PamCoupler const &coupler ) {
+    auto num_tracers = coupler.get_num_tracers();
+    auto nens        = coupler.get_nens();
+    auto nx          = coupler.get_nx();
+    auto ny          = coupler.get_ny();
+    auto nz          = coupler.get_nz();
+    auto low_storage = use_low_storage_integrator( coupler );
+    if ( workspace.nx   == nx   && workspace.ny == ny && workspace.nz == nz &&
+         workspace.nens == nens && workspace.num_tracers == num_tracers && workspace.low_storage == low_storage ) {
+      return false;
+    }
+    // Cells [0:hs-1] are the left halos, and cells [nx+hs:nx+2*hs-1] are the right halos
+    workspace.state          = real5d("state"         ,num_state  ,nz+2*hs,ny+2*hs,nx+2*hs,nens);
+    workspace.tracers        = real5d("tracers"       ,num_tracers,nz+2*hs,ny+2*hs,nx+2*hs,nens);
+    if (low_storage) {
+      // The low-storage integrator updates state and tracers in place and only needs one extra register
+      workspace.state_save   = real5d("state_save"    ,num_state  ,nz     ,ny     ,nx     ,nens);
+      workspace.tracers_save = real5d("tracers_save"  ,num_tracers,nz     ,ny     ,nx     ,nens);
+      workspace.state_tmp    = real5d();
+      workspace.state_tend   = real5d();
+      workspace.tracers_tmp  = real5d();
+      workspace.tracers_tend = real5d();
+    } else {
+      workspace.state_tmp    = real5d("state_tmp"     ,num_state  ,nz+2*hs,ny+2*hs,nx+2*hs,nens);
+      workspace.state_tend   = real5d("state_tend"    ,num_state  ,nz     ,ny     ,nx     ,nens);
+      workspace.tracers_tmp  = real5d("tracers_tmp"   ,num_tracers,nz+2*hs,ny+2*hs,nx+2*hs,nens);
+      workspace.tracers_tend = real5d("tracers_tend"  ,num_tracers,nz     ,ny     ,nx     ,nens);
+      workspace.state_save   = real5d();
+      workspace.tracers_save = real5d();
+    }
+    workspace.pressure       = real4d("pressure"      ,nz+2*hs,ny+2*hs,nx+2*hs,nens);
+    workspace.state_flux_x   = real5d("state_flux_x"  ,num_state  ,nz,ny,nx+1,nens);
+    workspace.state_flux_y   = real5d("state_flux_y"  ,num_state  ,nz,ny+1,nx,nens);
+    workspace.state_flux_z   = real5d("state_flux_z"  ,num_state  ,nz+1,ny,nx,nens);
+    workspace.tracers_flux_x = real5d("tracers_flux_x",num_tracers,nz,ny,nx+1,nens);
+    workspace.tracers_flux_y = real5d("tracers_flux_y",num_tracers,nz,ny+1,nx,nens);
+    workspace.tracers_flux_z = real5d("tracers_flux_z",num_tracers,nz+1,ny,nx,nens);
+    workspace.dt4d           = real4d("dt4d"          ,nz,ny,nx,nens);
+    int npack = num_state + num_tracers + 1;
+    if (par.nprocx > 1) {
+      workspace.halo_send_x      = real6d("halo_send_x",2,npack,nz,ny,hs,nens);
+      workspace.halo_recv_x      = real6d("halo_recv_x",2,npack,nz,ny,hs,nens);
+      workspace.halo_send_x_host = workspace.halo_send_x.createHostCopy();
+      workspace.halo_recv_x_host = workspace.halo_recv_x.createHostCopy();
+      workspace.edge_send_x      = real5d("edge_send_x",2,num_tracers,nz,ny,nens);
+      workspace.edge_recv_x      = real5d("edge_recv_x",2,num_tracers,nz,ny,nens);
+      workspace.edge_send_x_host = workspace.edge_send_x.createHostCopy();
+      workspace.edge_recv_x_host = workspace.edge_recv_x.createHostCopy();
+    }
+    if (par.nprocy > 1) {
+      workspace.halo_send_y      = real6d("halo_send_y",2,npack,nz,hs,nx,nens);
+      workspace.halo_recv_y      = real6d("halo_recv_y",2,npack,nz,hs,nx,nens);
+      workspace.halo_send_y_host = workspace.halo_send_y.createHostCopy();
+      workspace.halo_recv_y_host = workspace.halo_recv_y.createHostCopy();
+      workspace.edge_send_y      = real5d("edge_send_y",2,num_tracers,nz,nx,nens);
+      workspace.edge_recv_y      = real5d("edge_recv_y",2,num_tracers,nz,nx,nens);
+      workspace.edge_send_y_host = workspace.edge_send_y.createHostCopy();
+      workspace.edge_recv_y_host = workspace.edge_recv_y.createHostCopy();
+    }
+    workspace.nx          = nx;
+    workspace.ny          = ny;
+    workspace.nz          = nz;
+    workspace.nens        = nens;
+    workspace.num_tracers = num_tracers;
+    workspace.low_storage = low_storage;
+    num_workspace_allocations++;
+    return true;
+  }
+
+
+
+  // Determine this process's place in the x/y domain decomposition. Decomposition is enabled by the "inner_mpi"
+  // coupler option, in which case "nprocx", "nprocy", "crm_nx_glob", and "crm_ny_glob" must also be set, and the
+  // coupler's nx and ny must be the local sizes from the same partitioning used by the standalone driver
+  void setup_parallel( pam::PamCoupler const &coupler ) {
+    auto nx = coupler.get_nx();
+    auto ny = coupler.get_ny();
+    par.inner_mpi = coupler.get_option<bool>("inner_mpi",false);
+    if (par.inner_mpi) {
+      MPI_Comm_size( MPI_COMM_WORLD , &par.nranks );
+      MPI_Comm_rank( MPI_COMM_WORLD , &par.myrank );
+      par.nprocx  = coupler.get_option<int>("nprocx");
+      par.nprocy  = coupler.get_option<int>("nprocy");
+      par.nx_glob = coupler.get_option<int>("crm_nx_glob");
+      par.ny_glob = coupler.get_option<int>("crm_ny_glob");
+      // The coupler's domain lengths are per-process so that dx and dy are correct for all modules
+      par.xlen_glob = coupler.get_dx() * par.nx_glob;
+      par.ylen_glob = coupler.get_dy() * par.ny_glob;
+    } else {
+      par.nranks  = 1;
+      par.myrank  = 0;
+      par.nprocx  = 1;
+      par.nprocy  = 1;
+      par.nx_glob = nx;
+      par.ny_glob = ny;
+      par.xlen_glob = coupler.get_xlen();
+      par.ylen_glob = coupler.get_ylen();
+    }
+    par.mainproc = par.myrank == 0;
+    if (par.nprocx * par.nprocy != par.nranks) endrun("ERROR: nranks != nprocx * nprocy");
+
+    // Get my process grid IDs
+    par.py = par.myrank / par.nprocx;
+    par.px = par.myrank - par.nprocx * par.py;
+
+    // Get my beginning and ending global indices
+    double nper;
+    nper = ((double) par.nx_glob) / par.nprocx;
+    par.i_beg = (int) round( nper* par.px    );
+    par.i_end = (int) round( nper*(par.px+1) )-1;
+    nper = ((double) par.ny_glob) / par.nprocy;
+    par.j_beg = (int) round( nper* par.py    );
+    par.j_end = (int) round( nper*(par.py+1) )-1;
+    if (par.i_end - par.i_beg + 1 != nx || par.j_end - par.j_beg + 1 != ny) {
+      endrun("ERROR: The coupler's nx and ny do not match the AWFL domain decomposition");
+    }
+    if ( (par.nprocx > 1 && nx < hs) || (par.nprocy > 1 && ny < hs) ) {
+      endrun("ERROR: Each process must own at least hs cells in each decomposed direction");
+    }
+
+    // Determine my neighbors in the periodic process grid
+    auto wrap = [] (int i, int n) { return (i+n)%n; };
+    par.x_neigh(0) = par.py*par.nprocx + wrap(par.px-1,par.nprocx);
+    par.x_neigh(1) = par.py*par.nprocx + wrap(par.px+1,par.nprocx);
+    par.y_neigh(0) = wrap(par.py-1,par.nprocy)*par.nprocx + par.px;
+    par.y_neigh(1) = wrap(par.py+1,par.nprocy)*par.nprocx + par.px;
+  }
+
+
+
+  // Number of times the workspace had to be (re-)allocated from inside timeStep. This should be zero unless the
+  // coupler's dimensions changed after init()
+  int get_num_time_loop_allocations() const { return num_time_loop_allocations; }
+
 
 
   real2d compute_mass( pam::PamCoupler const &coupler , realConst5d state , realConst5d tracers ) const {
@@ -53,9 +286,12 @@ class Dycore {
           else if (ivar == num_tracers  ) { tmp(k,j,i) = state  (idR ,hs+k,hs+j,hs+i,iens)*dz(k,iens); }
           else if (ivar == num_tracers+1) { tmp(k,j,i) = state  (idT ,hs+k,hs+j,hs+i,iens)*dz(k,iens); }
         });
-        mass(ivar,iens) = yakl::intrinsics::sum(tmp)/tmp.size();
+        mass(ivar,iens) = yakl::intrinsics::sum(tmp)/(nz*par.nx_glob*par.ny_glob);
       }
     }
+    if (par.nranks > 1) {
+      MPI_Allreduce( MPI_IN_PLACE , mass.data() , mass.size() , AWFL_MPI_REAL , MPI_SUM , MPI_COMM_WORLD );
+    }
     return mass.createDeviceCopy();
   }
 
@@ -82,7 +318,7 @@ class Dycore {
     auto dm_temp  = dm.get<real const,4>("temp"       );
     auto dm_rho_v = dm.get<real const,4>("water_vapor");
     auto dz       = dm.get<real const,2>("vertical_cell_dz");
-    real4d dt4d("dt4d",nz,ny,nx,nens);
+    auto dt4d     = workspace.dt4d;
     parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
       real rho_d = dm_rho_d(k,j,i,iens);
       real u     = dm_uvel (k,j,i,iens);
@@ -98,12 +334,17 @@ class Dycore {
       real dtz = cfl * dz(k,iens) / (std::abs(w)+cs);
       dt4d(k,j,i,iens) = std::min( std::min( dtx , dty ) , dtz );
     });
-    return yakl::intrinsics::minval( dt4d );
+    real dt_loc = yakl::intrinsics::minval( dt4d );
+    if (par.nranks == 1) return dt_loc;
+    real dt_glob;
+    MPI_Allreduce( &dt_loc , &dt_glob , 1 , AWFL_MPI_REAL , MPI_MIN , MPI_COMM_WORLD );
+    return dt_glob;
   }
 
 
 
-  // Perform a single time step using SSPRK3 time stepping
+  // Perform a single time step using SSPRK3 time stepping, or the low-storage SSPRK(4,3) integrator when the
+  // "awfl_time_integrator" coupler option is "ssprk43_ls"
   void timeStep(pam::PamCoupler &coupler) {
     using yakl::c::parallel_for;
     using yakl::c::SimpleBounds;
@@ -119,10 +360,17 @@ class Dycore {
 
     real dt_phys = coupler.get_option<real>("crm_dt");
 
-    // Create arrays to hold state and tracers with halos on the left and right of the domain
-    // Cells [0:hs-1] are the left halos, and cells [nx+hs:nx+2*hs-1] are the right halos
-    real5d state  ("state"  ,num_state  ,nz+2*hs,ny+2*hs,nx+2*hs,nens);
-    real5d tracers("tracers",num_tracers,nz+2*hs,ny+2*hs,nx+2*hs,nens);
+    // The workspace was sized in init(). This only allocates if the coupler's dimensions have changed since then
+    if (allocate_workspace( coupler )) num_time_loop_allocations++;
+
+    // Arrays to hold state and tracers with halos on the left and right of the domain
+    auto state        = workspace.state;
+    auto tracers      = workspace.tracers;
+    // SSPRK3 requires temporary arrays to hold intermediate state and tracers arrays (unallocated for SSPRK(4,3))
+    auto state_tmp    = workspace.state_tmp;
+    auto state_tend   = workspace.state_tend;
+    auto tracers_tmp  = workspace.tracers_tmp;
+    auto tracers_tend = workspace.tracers_tend;
 
     // Populate the state and tracers arrays using data from the coupler, convert to the dycore's desired state
     convert_coupler_to_dynamics( coupler , state , tracers );
@@ -144,81 +392,98 @@ class Dycore {
     int ncycles = (int) std::ceil( dt_phys / dt_dyn );
     dt_dyn = dt_phys / ncycles;
 
-    for (int icycle = 0; icycle < ncycles; icycle++) {
-      // SSPRK3 requires temporary arrays to hold intermediate state and tracers arrays
-      real5d state_tmp   ("state_tmp"   ,num_state  ,nz+2*hs,ny+2*hs,nx+2*hs,nens);
-      real5d state_tend  ("state_tend"  ,num_state  ,nz     ,ny     ,nx     ,nens);
-      real5d tracers_tmp ("tracers_tmp" ,num_tracers,nz+2*hs,ny+2*hs,nx+2*hs,nens);
-      real5d tracers_tend("tracers_tend",num_tracers,nz     ,ny     ,nx     ,nens);
-      //////////////
-      // Stage 1
-      //////////////
-      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<5>(num_tracers,nz,ny,nx,nens) , YAKL_LAMBDA (int l, int k, int j, int i, int iens) {
-        // Store the starting point for FCT positivity in the next stage
-        tracers_tend(l,k,j,i,iens) = tracers(l,hs+k,hs+j,hs+i,iens);
-      });
-      compute_tendencies( coupler , state     , state_tend , tracers     , tracers_tend , dt_dyn );
-      // Apply tendencies
-      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
-        for (int l = 0; l < num_state  ; l++) {
-          state_tmp  (l,hs+k,hs+j,hs+i,iens) = state  (l,hs+k,hs+j,hs+i,iens) + dt_dyn * state_tend  (l,k,j,i,iens);
-        }
-        for (int l = 0; l < num_tracers; l++) {
-          tracers_tmp(l,hs+k,hs+j,hs+i,iens) = tracers(l,hs+k,hs+j,hs+i,iens) + dt_dyn * tracers_tend(l,k,j,i,iens);
-          // For machine precision negative values after FCT-enforced positivity application
-          if (tracer_positive(l)) {
-            tracers_tmp(l,hs+k,hs+j,hs+i,iens) = std::max( 0._fp , tracers_tmp(l,hs+k,hs+j,hs+i,iens) );
-          }
+    if (workspace.low_storage) {
+      auto state_save   = workspace.state_save;
+      auto tracers_save = workspace.tracers_save;
+      for (int icycle = 0; icycle < ncycles; icycle++) {
+        // Save the state at the beginning of the step for the third stage
+        parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
+          for (int l = 0; l < num_state  ; l++) { state_save  (l,k,j,i,iens) = state  (l,hs+k,hs+j,hs+i,iens); }
+          for (int l = 0; l < num_tracers; l++) { tracers_save(l,k,j,i,iens) = tracers(l,hs+k,hs+j,hs+i,iens); }
+        });
+        // SSPRK(4,3) in Shu-Osher form. Each stage is a convex combination of positive registers plus one forward
+        // Euler update, so FCT keeps the tracers non-negative
+        // u1 = u0 + dt/2 F(u0)
+        compute_stage( coupler , state , state_save , tracers , tracers_save , 1._fp       , 0._fp       , dt_dyn/2 , true );
+        // u2 = u1 + dt/2 F(u1)
+        compute_stage( coupler , state , state_save , tracers , tracers_save , 1._fp       , 0._fp       , dt_dyn/2 , true );
+        // u3 = 2/3 u0 + 1/3 u2 + dt/6 F(u2)
+        compute_stage( coupler , state , state_save , tracers , tracers_save , 1._fp/3._fp , 2._fp/3._fp , dt_dyn/6 , true );
+        // u4 = u3 + dt/2 F(u3)
+        compute_stage( coupler , state , state_save , tracers , tracers_save , 1._fp       , 0._fp       , dt_dyn/2 , true );
+      }
+    } else {
+      for (int icycle = 0; icycle < ncycles; icycle++) {
+        //////////////
+        // Stage 1
+        //////////////
+        parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<5>(num_tracers,nz,ny,nx,nens) , YAKL_LAMBDA (int l, int k, int j, int i, int iens) {
           // Store the starting point for FCT positivity in the next stage
-          tracers_tend(l,k,j,i,iens) = (3._fp/4._fp) * tracers    (l,hs+k,hs+j,hs+i,iens) + 
-                                       (1._fp/4._fp) * tracers_tmp(l,hs+k,hs+j,hs+i,iens);
-        }
-      });
-      //////////////
-      // Stage 2
-      //////////////
-      compute_tendencies( coupler , state_tmp , state_tend , tracers_tmp , tracers_tend , (1._fp/4._fp) * dt_dyn );
-      // Apply tendencies
-      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
-        for (int l = 0; l < num_state  ; l++) {
-          state_tmp  (l,hs+k,hs+j,hs+i,iens) = (3._fp/4._fp) * state      (l,hs+k,hs+j,hs+i,iens) + 
-                                               (1._fp/4._fp) * state_tmp  (l,hs+k,hs+j,hs+i,iens) +
-                                               (1._fp/4._fp) * dt_dyn * state_tend  (l,k,j,i,iens);
-        }
-        for (int l = 0; l < num_tracers; l++) {
-          tracers_tmp(l,hs+k,hs+j,hs+i,iens) = (3._fp/4._fp) * tracers    (l,hs+k,hs+j,hs+i,iens) + 
-                                               (1._fp/4._fp) * tracers_tmp(l,hs+k,hs+j,hs+i,iens) +
-                                               (1._fp/4._fp) * dt_dyn * tracers_tend(l,k,j,i,iens);
-          // For machine precision negative values after FCT-enforced positivity application
-          if (tracer_positive(l)) {
-            tracers_tmp(l,hs+k,hs+j,hs+i,iens) = std::max( 0._fp , tracers_tmp(l,hs+k,hs+j,hs+i,iens) );
+          tracers_tend(l,k,j,i,iens) = tracers(l,hs+k,hs+j,hs+i,iens);
+        });
+        compute_tendencies( coupler , state     , state_tend , tracers     , tracers_tend , dt_dyn );
+        // Apply tendencies
+        parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
+          for (int l = 0; l < num_state  ; l++) {
+            state_tmp  (l,hs+k,hs+j,hs+i,iens) = state  (l,hs+k,hs+j,hs+i,iens) + dt_dyn * state_tend  (l,k,j,i,iens);
           }
-          // Store the starting point for FCT positivity in the next stage
-          tracers_tend(l,k,j,i,iens) = (1._fp/3._fp) * tracers    (l,hs+k,hs+j,hs+i,iens) +
-                                       (2._fp/3._fp) * tracers_tmp(l,hs+k,hs+j,hs+i,iens);
-        }
-      });
-      //////////////
-      // Stage 3
-      //////////////
-      compute_tendencies( coupler , state_tmp , state_tend , tracers_tmp , tracers_tend , (2._fp/3._fp) * dt_dyn );
-      // Apply tendencies
-      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
-        for (int l = 0; l < num_state  ; l++) {
-          state      (l,hs+k,hs+j,hs+i,iens) = (1._fp/3._fp) * state      (l,hs+k,hs+j,hs+i,iens) +
-                                               (2._fp/3._fp) * state_tmp  (l,hs+k,hs+j,hs+i,iens) +
-                                               (2._fp/3._fp) * dt_dyn * state_tend  (l,k,j,i,iens);
-        }
-        for (int l = 0; l < num_tracers; l++) {
-          tracers    (l,hs+k,hs+j,hs+i,iens) = (1._fp/3._fp) * tracers    (l,hs+k,hs+j,hs+i,iens) +
-                                               (2._fp/3._fp) * tracers_tmp(l,hs+k,hs+j,hs+i,iens) +
-                                               (2._fp/3._fp) * dt_dyn * tracers_tend(l,k,j,i,iens);
-          // For machine precision negative values after FCT-enforced positivity application
-          if (tracer_positive(l)) {
-            tracers    (l,hs+k,hs+j,hs+i,iens) = std::max( 0._fp , tracers    (l,hs+k,hs+j,hs+i,iens) );
+          for (int l = 0; l < num_tracers; l++) {
+            tracers_tmp(l,hs+k,hs+j,hs+i,iens) = tracers(l,hs+k,hs+j,hs+i,iens) + dt_dyn * tracers_tend(l,k,j,i,iens);
+            // For machine precision negative values after FCT-enforced positivity application
+            if (tracer_positive(l)) {
+              tracers_tmp(l,hs+k,hs+j,hs+i,iens) = std::max( 0._fp , tracers_tmp(l,hs+k,hs+j,hs+i,iens) );
+            }
+            // Store the starting point for FCT positivity in the next stage
+            tracers_tend(l,k,j,i,iens) = (3._fp/4._fp) * tracers    (l,hs+k,hs+j,hs+i,iens) + 
+                                         (1._fp/4._fp) * tracers_tmp(l,hs+k,hs+j,hs+i,iens);
           }
-        }
-      });
+        });
+        //////////////
+        // Stage 2
+        //////////////
+        compute_tendencies( coupler , state_tmp , state_tend , tracers_tmp , tracers_tend , (1._fp/4._fp) * dt_dyn );
+        // Apply tendencies
+        parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
+          for (int l = 0; l < num_state  ; l++) {
+            state_tmp  (l,hs+k,hs+j,hs+i,iens) = (3._fp/4._fp) * state      (l,hs+k,hs+j,hs+i,iens) + 
+                                                 (1._fp/4._fp) * state_tmp  (l,hs+k,hs+j,hs+i,iens) +
+                                                 (1._fp/4._fp) * dt_dyn * state_tend  (l,k,j,i,iens);
+          }
+          for (int l = 0; l < num_tracers; l++) {
+            tracers_tmp(l,hs+k,hs+j,hs+i,iens) = (3._fp/4._fp) * tracers    (l,hs+k,hs+j,hs+i,iens) + 
+                                                 (1._fp/4._fp) * tracers_tmp(l,hs+k,hs+j,hs+i,iens) +
+                                                 (1._fp/4._fp) * dt_dyn * tracers_tend(l,k,j,i,iens);
+            // For machine precision negative values after FCT-enforced positivity application
+            if (tracer_positive(l)) {
+              tracers_tmp(l,hs+k,hs+j,hs+i,iens) = std::max( 0._fp , tracers_tmp(l,hs+k,hs+j,hs+i,iens) );
+            }
+            // Store the starting point for FCT positivity in the next stage
+            tracers_tend(l,k,j,i,iens) = (1._fp/3._fp) * tracers    (l,hs+k,hs+j,hs+i,iens) +
+                                         (2._fp/3._fp) * tracers_tmp(l,hs+k,hs+j,hs+i,iens);
+          }
+        });
+        //////////////
+        // Stage 3
+        //////////////
+        compute_tendencies( coupler , state_tmp , state_tend , tracers_tmp , tracers_tend , (2._fp/3._fp) * dt_dyn );
+        // Apply tendencies
+        parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
+          for (int l = 0; l < num_state  ; l++) {
+            state      (l,hs+k,hs+j,hs+i,iens) = (1._fp/3._fp) * state      (l,hs+k,hs+j,hs+i,iens) +
+                                                 (2._fp/3._fp) * state_tmp  (l,hs+k,hs+j,hs+i,iens) +
+                                                 (2._fp/3._fp) * dt_dyn * state_tend  (l,k,j,i,iens);
+          }
+          for (int l = 0; l < num_tracers; l++) {
+            tracers    (l,hs+k,hs+j,hs+i,iens) = (1._fp/3._fp) * tracers    (l,hs+k,hs+j,hs+i,iens) +
+                                                 (2._fp/3._fp) * tracers_tmp(l,hs+k,hs+j,hs+i,iens) +
+                                                 (2._fp/3._fp) * dt_dyn * tracers_tend(l,k,j,i,iens);
+            // For machine precision negative values after FCT-enforced positivity application
+            if (tracer_positive(l)) {
+              tracers    (l,hs+k,hs+j,hs+i,iens) = std::max( 0._fp , tracers    (l,hs+k,hs+j,hs+i,iens) );
+            }
+          }
+        });
+      }
     }
 
     #ifdef PAM_DEBUG
@@ -265,6 +530,25 @@ class Dycore {
                            real5d const &tracers      ,
                            real5d const &tracers_tend ,
                            real dt                    ) const {
+    compute_stage( coupler , state , state_tend , tracers , tracers_tend , 0._fp , 1._fp , dt , false );
+  }
+
+
+
+  // Compute the flux divergence and gravity source for one RK stage. If update_in_place is false, state_aux and
+  // tracers_aux receive the tendencies, and tracers_aux holds the FCT starting point on input. If update_in_place is
+  // true, state_aux and tracers_aux hold a saved register, and the stage is applied directly to state and tracers:
+  //     state = c_cur*state + c_aux*state_aux + dt*tendency
+  // with c_cur*tracers + c_aux*tracers_aux as the FCT starting point. This avoids storing tendencies at all.
+  void compute_stage( pam::PamCoupler &coupler  ,
+                      real5d const &state       ,
+                      real5d const &state_aux   ,
+                      real5d const &tracers     ,
+                      real5d const &tracers_aux ,
+                      real c_cur                ,
+                      real c_aux                ,
+                      real dt                   ,
+                      bool update_in_place      ) const {
     using yakl::c::parallel_for;
     using yakl::c::SimpleBounds;
     using std::min;
@@ -277,34 +561,154 @@ class Dycore {
     auto dx           = coupler.get_dx();
     auto dy           = coupler.get_dy();
     auto sim2d        = ny == 1;
-    auto C0           = coupler.get_option<real>("C0"     );
-    auto gamma_d      = coupler.get_option<real>("gamma_d");
     auto grav         = coupler.get_option<real>("grav"   );
     auto num_tracers  = coupler.get_num_tracers();
     auto grav_balance = coupler.get_option<bool>("balance_hydrostasis_with_gravity");
 
-    // The store a single values flux at cell edges
     auto &dm                   = coupler.get_data_manager_device_readwrite();
     auto tracer_positive       = dm.get<bool const,1>("tracer_positive");
     auto dz                    = dm.get<real const,2>("vertical_cell_dz");
-    auto vert_weno_recon_lower = dm.get<real const,5>("vert_weno_recon_lower");
-    auto vert_sten_to_coefs    = dm.get<real const,4>("vert_sten_to_coefs");
     auto hy_dens_cells         = dm.get<real const,2>("hy_dens_cells");
-    auto hy_pressure_cells     = dm.get<real const,2>("hy_pressure_cells");
     auto grav_var              = dm.get<real const,2>("variable_gravity");
 
-    YAKL_SCOPE( weno_recon_lower , this->weno_recon_lower );
+    // The store a single values flux at cell edges
+    auto pressure       = workspace.pressure;
+    auto state_flux_x   = workspace.state_flux_x;
+    auto state_flux_y   = workspace.state_flux_y;
+    auto state_flux_z   = workspace.state_flux_z;
+    auto tracers_flux_x = workspace.tracers_flux_x;
+    auto tracers_flux_y = workspace.tracers_flux_y;
+    auto tracers_flux_z = workspace.tracers_flux_z;
+
+    convert_to_primitives( coupler , state , tracers , pressure , false );
+
+    // Compute upwind fluxes at cell edges. With a decomposed domain, edges that need no halo data from other
+    // processes are computed while the halo exchange is in flight, and the boundary strip is computed afterward
+    auto halo_requests = halo_exchange_begin( coupler , state , tracers , pressure );
+    if (par.nprocx > 1 || par.nprocy > 1) {
+      compute_fluxes( coupler , state , tracers , pressure , state_flux_x , state_flux_y , state_flux_z ,
+                      tracers_flux_x , tracers_flux_y , tracers_flux_z , FLUX_REGION_INTERIOR );
+      halo_exchange_end( coupler , state , tracers , pressure , halo_requests );
+      compute_fluxes( coupler , state , tracers , pressure , state_flux_x , state_flux_y , state_flux_z ,
+                      tracers_flux_x , tracers_flux_y , tracers_flux_z , FLUX_REGION_BOUNDARY );
+    } else {
+      halo_exchange_end( coupler , state , tracers , pressure , halo_requests );
+      compute_fluxes( coupler , state , tracers , pressure , state_flux_x , state_flux_y , state_flux_z ,
+                      tracers_flux_x , tracers_flux_y , tracers_flux_z , FLUX_REGION_ALL );
+    }
 
-    // Use TransformMatrices class to create matrices & GLL points to convert degrees of freedom as needed
-    SArray<real,2,ord,ord> sten_to_coefs;
-    SArray<real,2,ord,2  > coefs_to_gll;
-    TransformMatrices::coefs_to_gll_lower(coefs_to_gll );
-    TransformMatrices::sten_to_coefs     (sten_to_coefs);
-    SArray<real,1,hs+1> idl;
-    real                sigma;
-    weno::wenoSetIdealSigma<ord>(idl,sigma);
+    // Flux Corrected Transport to enforce positivity for tracer species that must remain non-negative
+    // This looks like it has a race condition, but it does not. Only one of the adjacent cells can ever change
+    // a given edge flux because it's only changed if its sign oriented outward from a cell.
+    // Also, multiply density back onto the state and tracers
+    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) ,
+                                      YAKL_LAMBDA (int k, int j, int i, int iens) {
+      state(idU,hs+k,hs+j,hs+i,iens) *= state(idR,hs+k,hs+j,hs+i,iens);
+      state(idV,hs+k,hs+j,hs+i,iens) *= state(idR,hs+k,hs+j,hs+i,iens);
+      state(idW,hs+k,hs+j,hs+i,iens) *= state(idR,hs+k,hs+j,hs+i,iens);
+      state(idT,hs+k,hs+j,hs+i,iens) *= state(idR,hs+k,hs+j,hs+i,iens);
+      for (int tr=0; tr < num_tracers; tr++) {
+        tracers(tr,hs+k,hs+j,hs+i,iens) *= state(idR,hs+k,hs+j,hs+i,iens);
+        if (tracer_positive(tr)) {
+          real tracer_start = update_in_place ? c_cur * tracers(tr,hs+k,hs+j,hs+i,iens) + c_aux * tracers_aux(tr,k,j,i,iens) :
+                                                tracers_aux(tr,k,j,i,iens);
+          real mass_available = max(tracer_start,0._fp) * dx * dy * dz(k,iens);
+          real flux_out_x = ( max(tracers_flux_x(tr,k,j,i+1,iens),0._fp) - min(tracers_flux_x(tr,k,j,i,iens),0._fp) ) / dx;
+          real flux_out_y = ( max(tracers_flux_y(tr,k,j+1,i,iens),0._fp) - min(tracers_flux_y(tr,k,j,i,iens),0._fp) ) / dy;
+          real flux_out_z = ( max(tracers_flux_z(tr,k+1,j,i,iens),0._fp) - min(tracers_flux_z(tr,k,j,i,iens),0._fp) ) / dz(k,iens);
+          real mass_out = (flux_out_x + flux_out_y + flux_out_z) * dt * dx * dy * dz(k,iens);
+          if (mass_out > mass_available) {
+            real mult = mass_available / mass_out;
+            if (tracers_flux_x(tr,k,j,i+1,iens) > 0) tracers_flux_x(tr,k,j,i+1,iens) *= mult;
+            if (tracers_flux_x(tr,k,j,i  ,iens) < 0) tracers_flux_x(tr,k,j,i  ,iens) *= mult;
+            if (tracers_flux_y(tr,k,j+1,i,iens) > 0) tracers_flux_y(tr,k,j+1,i,iens) *= mult;
+            if (tracers_flux_y(tr,k,j  ,i,iens) < 0) tracers_flux_y(tr,k,j  ,i,iens) *= mult;
+            if (tracers_flux_z(tr,k+1,j,i,iens) > 0) tracers_flux_z(tr,k+1,j,i,iens) *= mult;
+            if (tracers_flux_z(tr,k  ,j,i,iens) < 0) tracers_flux_z(tr,k  ,j,i,iens) *= mult;
+          }
+        }
+      }
+    });
 
-    real4d pressure("pressure",nz+2*hs,ny+2*hs,nx+2*hs,nens);
+    // Processes sharing an x or y domain edge each limit their own copy of its tracer flux, so get the neighbors' copies
+    auto nprocx      = par.nprocx;
+    auto nprocy      = par.nprocy;
+    auto edge_recv_x = workspace.edge_recv_x;
+    auto edge_recv_y = workspace.edge_recv_y;
+    exchange_edge_fluxes( coupler , tracers_flux_x , tracers_flux_y );
+
+    // Compute tendencies as the flux divergence + gravity source term, and apply them if updating in place
+    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
+      // Density is read before the loop because it may be overwritten before the gravity source is computed
+      real rho = state(idR,hs+k,hs+j,hs+i,iens);
+      for (int l = 0; l < num_state; l++) {
+        real tend = -( state_flux_x(l,k  ,j  ,i+1,iens) - state_flux_x(l,k,j,i,iens) ) / dx
+                    -( state_flux_y(l,k  ,j+1,i  ,iens) - state_flux_y(l,k,j,i,iens) ) / dy
+                    -( state_flux_z(l,k+1,j  ,i  ,iens) - state_flux_z(l,k,j,i,iens) ) / dz(k,iens);
+        if (l == idW) {
+          if (grav_balance) {
+            tend += -grav_var(k,iens) * rho;
+          } else {
+            tend += -grav * ( rho - hy_dens_cells(k,iens) );
+          }
+        }
+        if (l == idV && sim2d) tend = 0;
+        if (update_in_place) {
+          state(l,hs+k,hs+j,hs+i,iens) = c_cur * state(l,hs+k,hs+j,hs+i,iens) + c_aux * state_aux(l,k,j,i,iens) + dt * tend;
+        } else {
+          state_aux(l,k,j,i,iens) = tend;
+        }
+      }
+      for (int l = 0; l < num_tracers; l++) {
+        real fx   = tracers_flux_x(l,k  ,j  ,i  ,iens);
+        real fxp1 = tracers_flux_x(l,k  ,j  ,i+1,iens);
+        real fy   = tracers_flux_y(l,k  ,j  ,i  ,iens);
+        real fyp1 = tracers_flux_y(l,k  ,j+1,i  ,iens);
+        real fz   = tracers_flux_z(l,k  ,j  ,i  ,iens);
+        real fzp1 = tracers_flux_z(l,k+1,j  ,i  ,iens);
+        if (i == 0   ) {
+          fx = std::min( fx , nprocx > 1 ? edge_recv_x(0,l,k,j,iens) : tracers_flux_x(l,k,j,nx,iens) );
+        }
+        if (i == nx-1) { fxp1 = std::min( fxp1 , nprocx > 1 ? edge_recv_x(1,l,k,j,iens) : tracers_flux_x(l,k,j,0 ,iens) ); }
+        if (j == 0   ) { fy   = std::min( fy   , nprocy > 1 ? edge_recv_y(0,l,k,i,iens) : tracers_flux_y(l,k,ny,i,iens) ); }
+        if (j == ny-1) { fyp1 = std::min( fyp1 , nprocy > 1 ? edge_recv_y(1,l,k,i,iens) : tracers_flux_y(l,k,0 ,i,iens) ); }
+        real tend = -( fxp1 - fx ) / dx
+                    -( fyp1 - fy ) / dy
+                    -( fzp1 - fz ) / dz(k,iens);
+        if (update_in_place) {
+          real val = c_cur * tracers(l,hs+k,hs+j,hs+i,iens) + c_aux * tracers_aux(l,k,j,i,iens) + dt * tend;
+          // For machine precision negative values after FCT-enforced positivity application
+          if (tracer_positive(l)) val = max( 0._fp , val );
+          tracers(l,hs+k,hs+j,hs+i,iens) = val;
+        } else {
+          tracers_aux(l,k,j,i,iens) = tend;
+        }
+      }
+    });
+
+  }
+
+
+
+  // Compute the pressure perturbation, divide density from all other quantities before interpolation, and fill
+  // the halos of state, tracers, and pressure unless the caller exchanges them itself
+  void convert_to_primitives( pam::PamCoupler const &coupler        ,
+                              real5d          const &state          ,
+                              real5d          const &tracers        ,
+                              real4d          const &pressure       ,
+                              bool                   exchange_halos = true ) const {
+    using yakl::c::parallel_for;
+    using yakl::c::SimpleBounds;
+
+    auto nens              = coupler.get_nens();
+    auto nx                = coupler.get_nx();
+    auto ny                = coupler.get_ny();
+    auto nz                = coupler.get_nz();
+    auto C0                = coupler.get_option<real>("C0"     );
+    auto gamma_d           = coupler.get_option<real>("gamma_d");
+    auto num_tracers       = coupler.get_num_tracers();
+    auto grav_balance      = coupler.get_option<bool>("balance_hydrostasis_with_gravity");
+    auto hy_pressure_cells = coupler.get_data_manager_device_readonly().get<real const,2>("hy_pressure_cells");
 
     // Compute pressure perturbation, density perturbation, and divide density from all other quantities before interpolation
     parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
@@ -320,23 +724,165 @@ class Dycore {
       for (int tr=0; tr < num_tracers; tr++) { tracers(tr,hs+k,hs+j,hs+i,iens) /= state(idR,hs+k,hs+j,hs+i,iens); }
     });
 
-    halo_exchange( coupler , state , tracers , pressure );
+    if (exchange_halos) halo_exchange( coupler , state , tracers , pressure );
+  }
+
+
 
-    real5d state_flux_x  ("state_flux_x"  ,num_state  ,nz,ny,nx+1,nens);
-    real5d state_flux_y  ("state_flux_y"  ,num_state  ,nz,ny+1,nx,nens);
-    real5d state_flux_z  ("state_flux_z"  ,num_state  ,nz+1,ny,nx,nens);
-    real5d tracers_flux_x("tracers_flux_x",num_tracers,nz,ny,nx+1,nens);
-    real5d tracers_flux_y("tracers_flux_y",num_tracers,nz,ny+1,nx,nens);
-    real5d tracers_flux_z("tracers_flux_z",num_tracers,nz+1,ny,nx,nens);
+  // Compute upwind fluxes at cell edges. AWFL_STAGED_RECON selects the register-staged kernel at build time
+  void compute_fluxes( pam::PamCoupler const &coupler        ,
+                       realConst5d            state          ,
+                       realConst5d            tracers        ,
+                       realConst4d            pressure       ,
+                       real5d          const &state_flux_x   ,
+                       real5d          const &state_flux_y   ,
+                       real5d          const &state_flux_z   ,
+                       real5d          const &tracers_flux_x ,
+                       real5d          const &tracers_flux_y ,
+                       real5d          const &tracers_flux_z ,
+                       int                    region         ) const {
+    #ifdef AWFL_STAGED_RECON
+      compute_fluxes_staged   ( coupler , state , tracers , pressure , state_flux_x , state_flux_y , state_flux_z ,
+                                tracers_flux_x , tracers_flux_y , tracers_flux_z , region );
+    #else
+      compute_fluxes_reference( coupler , state , tracers , pressure , state_flux_x , state_flux_y , state_flux_z ,
+                                tracers_flux_x , tracers_flux_y , tracers_flux_z , region );
+    #endif
+  }
+
+
+
+  // Select which cell edges compute_fluxes_* computes. Interior edges have stencils that only touch this process's
+  // cells and halos that do not come from other processes, so they can be computed while a halo exchange is in flight
+  int static constexpr FLUX_REGION_ALL      = 0;
+  int static constexpr FLUX_REGION_INTERIOR = 1;
+  int static constexpr FLUX_REGION_BOUNDARY = 2;
+
+
+
+  // Determine which directions' fluxes to compute at edge (i,j) for the given region. The x-edge stencils at edge i
+  // cover cells i-hs through i+hs-1, so they are interior for hs <= i <= nx-hs when x is decomposed (same for y)
+  YAKL_INLINE static void flux_region_mask( int region , int i , int j , int nx , int ny , int nprocx , int nprocy ,
+                                            bool &do_x , bool &do_y , bool &do_z ) {
+    if (region == FLUX_REGION_ALL) {
+      do_x = true;
+      do_y = true;
+      do_z = true;
+    } else {
+      bool x_interior = nprocx == 1 || (i >= hs && i <= nx-hs);
+      bool y_interior = nprocy == 1 || (j >= hs && j <= ny-hs);
+      bool interior   = region == FLUX_REGION_INTERIOR;
+      do_x = x_interior == interior;
+      do_y = y_interior == interior;
+      do_z = interior;
+    }
+  }
+
+
+
+  // Number of edge coordinates in [0,n] that lie in the boundary strips of a decomposed direction (none otherwise)
+  YAKL_INLINE static int num_strip_edges( int n , int nproc ) {
+    if (nproc == 1) return 0;
+    return n+1 <= 2*hs ? n+1 : 2*hs;
+  }
+
+
+
+  // The s-th edge coordinate in [0,n] inside the boundary strips (i < hs or i > n-hs) of a direction with nstrip of them
+  YAKL_INLINE static int strip_edge( int s , int n , int nstrip ) {
+    if (nstrip == n+1) return s;
+    return s < hs ? s : n-hs+1+(s-hs);
+  }
+
+
+
+  // Number of (j,i) edge columns a compute_fluxes_* launch must cover for this region. FLUX_REGION_BOUNDARY only
+  // covers the halo-adjacent strips, so the pass after the halo exchange costs a small fraction of a full flux kernel
+  YAKL_INLINE static int num_region_edges( int region , int nx , int ny , int nprocx , int nprocy ) {
+    if (region != FLUX_REGION_BOUNDARY) return (ny+1)*(nx+1);
+    int nxs = num_strip_edges(nx,nprocx);
+    int nys = num_strip_edges(ny,nprocy);
+    // All rows of the x strips, plus the rows of the y strips outside the x strips
+    return (ny+1)*nxs + nys*(nx+1-nxs);
+  }
+
+
+
+  // Map a compact launch index over the region's (j,i) edge columns back to (j,i)
+  YAKL_INLINE static void region_edge( int region , int ind , int nx , int ny , int nprocx , int nprocy ,
+                                       int &j , int &i ) {
+    if (region != FLUX_REGION_BOUNDARY) {
+      j = ind / (nx+1);
+      i = ind % (nx+1);
+      return;
+    }
+    int nxs = num_strip_edges(nx,nprocx);
+    int nys = num_strip_edges(ny,nprocy);
+    if (ind < (ny+1)*nxs) {
+      j = ind / nxs;
+      i = strip_edge( ind % nxs , nx , nxs );
+    } else {
+      int nxc = nx+1-nxs;
+      int r   = ind - (ny+1)*nxs;
+      j = strip_edge( r / nxc , ny , nys );
+      i = nxs > 0 ? hs + r % nxc : r % nxc;
+    }
+  }
+
+
+
+  // Compute upwind fluxes of state and tracers at cell edges from primitive variables with filled halos
+  void compute_fluxes_reference( pam::PamCoupler const &coupler        ,
+                                 realConst5d            state          ,
+                                 realConst5d            tracers        ,
+                                 realConst4d            pressure       ,
+                                 real5d          const &state_flux_x   ,
+                                 real5d          const &state_flux_y   ,
+                                 real5d          const &state_flux_z   ,
+                                 real5d          const &tracers_flux_x ,
+                                 real5d          const &tracers_flux_y ,
+                                 real5d          const &tracers_flux_z ,
+                                 int                    region = FLUX_REGION_ALL ) const {
+    using yakl::c::parallel_for;
+    using yakl::c::SimpleBounds;
+
+    auto nens         = coupler.get_nens();
+    auto nx           = coupler.get_nx();
+    auto ny           = coupler.get_ny();
+    auto nz           = coupler.get_nz();
+    auto sim2d        = ny == 1;
+    auto num_tracers  = coupler.get_num_tracers();
+
+    auto &dm                   = coupler.get_data_manager_device_readonly();
+    auto vert_weno_recon_lower = dm.get<real const,5>("vert_weno_recon_lower");
+    auto vert_sten_to_coefs    = dm.get<real const,4>("vert_sten_to_coefs");
+
+    YAKL_SCOPE( weno_recon_lower , this->weno_recon_lower );
+
+    // Use TransformMatrices class to create matrices & GLL points to convert degrees of freedom as needed
+    SArray<real,2,ord,ord> sten_to_coefs;
+    SArray<real,2,ord,2  > coefs_to_gll;
+    TransformMatrices::coefs_to_gll_lower(coefs_to_gll );
+    TransformMatrices::sten_to_coefs     (sten_to_coefs);
+    SArray<real,1,hs+1> idl;
+    real                sigma;
+    weno::wenoSetIdealSigma<ord>(idl,sigma);
 
     // Compute samples of state and tracers at cell edges using cell-centered reconstructions at high-order with WENO
     // At the end of this, we will have two samples per cell edge in each dimension, one from each adjacent cell.
-    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz+1,ny+1,nx+1,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
+    auto nprocx = par.nprocx;
+    auto nprocy = par.nprocy;
+    int nedges = num_region_edges( region , nx , ny , nprocx , nprocy );
+    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<3>(nz+1,nedges,nens) , YAKL_LAMBDA (int k, int ind, int iens) {
       real constexpr cs = 350;
+      int j, i;
+      region_edge( region , ind , nx , ny , nprocx , nprocy , j , i );
+      bool do_x, do_y, do_z;
+      flux_region_mask( region , i , j , nx , ny , nprocx , nprocy , do_x , do_y , do_z );
       ////////////////////////////////////////////////////////
       // X-direction
       ////////////////////////////////////////////////////////
-      if (j < ny && k < nz) {
+      if (do_x && j < ny && k < nz) {
         SArray<real,1,ord> stencil;
         // ACOUSTIC
         real ru, pp;
@@ -388,7 +934,7 @@ class Dycore {
       ////////////////////////////////////////////////////////
       // Y-direction
       ////////////////////////////////////////////////////////
-      if (i < nx && k < nz) {
+      if (do_y && i < nx && k < nz) {
         if (! sim2d) {
           SArray<real,1,ord> stencil;
           // ACOUSTIC
@@ -449,7 +995,7 @@ class Dycore {
       ////////////////////////////////////////////////////////
       // Z-direction
       ////////////////////////////////////////////////////////
-      if (i < nx && j < ny) {
+      if (do_z && i < nx && j < ny) {
         SArray<real,1,ord> stencil;
         SArray<real,2,ord,ord>  s2c_loc[2];
         SArray<real,3,hs,hs,hs> wrl_loc[2];
@@ -517,69 +1063,251 @@ class Dycore {
         }
       }
     });
+  }
 
-    // Flux Corrected Transport to enforce positivity for tracer species that must remain non-negative
-    // This looks like it has a race condition, but it does not. Only one of the adjacent cells can ever change
-    // a given edge flux because it's only changed if its sign oriented outward from a cell.
-    // Also, multiply density back onto the state and tracers
-    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) ,
-                                      YAKL_LAMBDA (int k, int j, int i, int iens) {
-      state(idU,hs+k,hs+j,hs+i,iens) *= state(idR,hs+k,hs+j,hs+i,iens);
-      state(idV,hs+k,hs+j,hs+i,iens) *= state(idR,hs+k,hs+j,hs+i,iens);
-      state(idW,hs+k,hs+j,hs+i,iens) *= state(idR,hs+k,hs+j,hs+i,iens);
-      state(idT,hs+k,hs+j,hs+i,iens) *= state(idR,hs+k,hs+j,hs+i,iens);
-      for (int tr=0; tr < num_tracers; tr++) {
-        tracers(tr,hs+k,hs+j,hs+i,iens) *= state(idR,hs+k,hs+j,hs+i,iens);
-        if (tracer_positive(tr)) {
-          real mass_available = max(tracers_tend(tr,k,j,i,iens),0._fp) * dx * dy * dz(k,iens);
-          real flux_out_x = ( max(tracers_flux_x(tr,k,j,i+1,iens),0._fp) - min(tracers_flux_x(tr,k,j,i,iens),0._fp) ) / dx;
-          real flux_out_y = ( max(tracers_flux_y(tr,k,j+1,i,iens),0._fp) - min(tracers_flux_y(tr,k,j,i,iens),0._fp) ) / dy;
-          real flux_out_z = ( max(tracers_flux_z(tr,k+1,j,i,iens),0._fp) - min(tracers_flux_z(tr,k,j,i,iens),0._fp) ) / dz(k,iens);
-          real mass_out = (flux_out_x + flux_out_y + flux_out_z) * dt * dx * dy * dz(k,iens);
-          if (mass_out > mass_available) {
-            real mult = mass_available / mass_out;
-            if (tracers_flux_x(tr,k,j,i+1,iens) > 0) tracers_flux_x(tr,k,j,i+1,iens) *= mult;
-            if (tracers_flux_x(tr,k,j,i  ,iens) < 0) tracers_flux_x(tr,k,j,i  ,iens) *= mult;
-            if (tracers_flux_y(tr,k,j+1,i,iens) > 0) tracers_flux_y(tr,k,j+1,i,iens) *= mult;
-            if (tracers_flux_y(tr,k,j  ,i,iens) < 0) tracers_flux_y(tr,k,j  ,i,iens) *= mult;
-            if (tracers_flux_z(tr,k+1,j,i,iens) > 0) tracers_flux_z(tr,k+1,j,i,iens) *= mult;
-            if (tracers_flux_z(tr,k  ,j,i,iens) < 0) tracers_flux_z(tr,k  ,j,i,iens) *= mult;
-          }
+
+
+  // Register-staged variant of compute_fluxes_reference that produces bitwise-identical fluxes. Each thread loads
+  // density, edge-normal velocity, and pressure once per direction rather than once per upwind side, and each
+  // advected quantity is loaded only for the chosen upwind side. This is not a shared-memory tiled kernel: YAKL's
+  // parallel_for has no portable block-shared storage, so the per-level vertical reconstruction matrices are still
+  // loaded once by every thread and neighboring threads rely on the cache to share them
+  void compute_fluxes_staged( pam::PamCoupler const &coupler        ,
+                              realConst5d            state          ,
+                              realConst5d            tracers        ,
+                              realConst4d            pressure       ,
+                              real5d          const &state_flux_x   ,
+                              real5d          const &state_flux_y   ,
+                              real5d          const &state_flux_z   ,
+                              real5d          const &tracers_flux_x ,
+                              real5d          const &tracers_flux_y ,
+                              real5d          const &tracers_flux_z ,
+                              int                    region = FLUX_REGION_ALL ) const {
+    using yakl::c::parallel_for;
+    using yakl::c::SimpleBounds;
+
+    auto nens         = coupler.get_nens();
+    auto nx           = coupler.get_nx();
+    auto ny           = coupler.get_ny();
+    auto nz           = coupler.get_nz();
+    auto sim2d        = ny == 1;
+    auto num_tracers  = coupler.get_num_tracers();
+
+    auto &dm                   = coupler.get_data_manager_device_readonly();
+    auto vert_weno_recon_lower = dm.get<real const,5>("vert_weno_recon_lower");
+    auto vert_sten_to_coefs    = dm.get<real const,4>("vert_sten_to_coefs");
+
+    YAKL_SCOPE( weno_recon_lower , this->weno_recon_lower );
+
+    // Use TransformMatrices class to create matrices & GLL points to convert degrees of freedom as needed
+    SArray<real,2,ord,ord> sten_to_coefs;
+    SArray<real,2,ord,2  > coefs_to_gll;
+    TransformMatrices::coefs_to_gll_lower(coefs_to_gll );
+    TransformMatrices::sten_to_coefs     (sten_to_coefs);
+    SArray<real,1,hs+1> idl;
+    real                sigma;
+    weno::wenoSetIdealSigma<ord>(idl,sigma);
+
+    // Compute samples of state and tracers at cell edges using cell-centered reconstructions at high-order with WENO
+    // Density, the edge-normal velocity, and pressure are needed on both upwind sides of an edge, so their ord+1
+    // cell values are loaded once per direction and both upwind stencils are sliced from registers
+    auto nprocx = par.nprocx;
+    auto nprocy = par.nprocy;
+    int nedges = num_region_edges( region , nx , ny , nprocx , nprocy );
+    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<3>(nz+1,nedges,nens) , YAKL_LAMBDA (int k, int ind, int iens) {
+      real constexpr cs = 350;
+      int j, i;
+      region_edge( region , ind , nx , ny , nprocx , nprocy , j , i );
+      bool do_x, do_y, do_z;
+      flux_region_mask( region , i , j , nx , ny , nprocx , nprocy , do_x , do_y , do_z );
+      ////////////////////////////////////////////////////////
+      // X-direction
+      ////////////////////////////////////////////////////////
+      if (do_x && j < ny && k < nz) {
+        SArray<real,1,ord+1> r_st, u_st, p_st;
+        for (int s=0; s < ord+1; s++) {
+          r_st(s) = state(idR,hs+k,hs+j,i+s,iens);
+          u_st(s) = state(idU,hs+k,hs+j,i+s,iens);
+          p_st(s) = pressure(hs+k,hs+j,i+s,iens);
+        }
+        SArray<real,1,ord> stencil;
+        // ACOUSTIC
+        real ru, pp;
+        {
+          // rho*u (left estimate)
+          for (int s=0; s < ord; s++) { stencil(s) = r_st(s  )*u_st(s  ); }
+          real ru_L = reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1);
+          // rho*u (right estimate)
+          for (int s=0; s < ord; s++) { stencil(s) = r_st(s+1)*u_st(s+1); }
+          real ru_R = reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,0);
+          // pressure perturbation (left estimate)
+          for (int s=0; s < ord; s++) { stencil(s) = p_st(s  ); }
+          real pp_L = reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1);
+          // pressure perturbation (right estimate)
+          for (int s=0; s < ord; s++) { stencil(s) = p_st(s+1); }
+          real pp_R = reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,0);
+          // Characteristics & upwind values
+          real w1 = 0.5_fp * (pp_R-cs*ru_R);
+          real w2 = 0.5_fp * (pp_L+cs*ru_L);
+          pp = w1+w2;
+          ru = (w2-w1)/cs;
+          state_flux_x(idR,k,j,i,iens) = ru;
+        }
+        // ADVECTIVE
+        int i_upw = ru > 0 ? 0 : 1;
+        // u-velocity
+        for (int s=0; s < ord; s++) { stencil(s) = u_st(i_upw+s); }
+        state_flux_x(idU,k,j,i,iens) = ru * reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1-i_upw) + pp;
+        // v-velocity
+        for (int s=0; s < ord; s++) { stencil(s) = state(idV,hs+k,hs+j,i+i_upw+s,iens); }
+        state_flux_x(idV,k,j,i,iens) = ru * reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1-i_upw);
+        // w-velocity
+        for (int s=0; s < ord; s++) { stencil(s) = state(idW,hs+k,hs+j,i+i_upw+s,iens); }
+        state_flux_x(idW,k,j,i,iens) = ru * reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1-i_upw);
+        // theta
+        for (int s=0; s < ord; s++) { stencil(s) = state(idT,hs+k,hs+j,i+i_upw+s,iens); }
+        state_flux_x(idT,k,j,i,iens) = ru * reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1-i_upw);
+        // tracers
+        for (int tr=0; tr < num_tracers; tr++) {
+          for (int s=0; s < ord; s++) { stencil(s) = tracers(tr,hs+k,hs+j,i+i_upw+s,iens); }
+          tracers_flux_x(tr,k,j,i,iens) = ru * reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1-i_upw);
         }
       }
-    });
 
-    // Compute tendencies as the flux divergence + gravity source term
-    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
-      for (int l = 0; l < num_state; l++) {
-        state_tend  (l,k,j,i,iens) = -( state_flux_x(l,k  ,j  ,i+1,iens) - state_flux_x(l,k,j,i,iens) ) / dx
-                                     -( state_flux_y(l,k  ,j+1,i  ,iens) - state_flux_y(l,k,j,i,iens) ) / dy
-                                     -( state_flux_z(l,k+1,j  ,i  ,iens) - state_flux_z(l,k,j,i,iens) ) / dz(k,iens);
-        if (l == idW) {
-          if (grav_balance) {
-            state_tend(l,k,j,i,iens) += -grav_var(k,iens) * state(idR,hs+k,hs+j,hs+i,iens);
-          } else {
-            state_tend(l,k,j,i,iens) += -grav * ( state(idR,hs+k,hs+j,hs+i,iens) - hy_dens_cells(k,iens) );
+      ////////////////////////////////////////////////////////
+      // Y-direction
+      ////////////////////////////////////////////////////////
+      if (do_y && i < nx && k < nz) {
+        if (! sim2d) {
+          SArray<real,1,ord+1> r_st, v_st, p_st;
+          for (int s=0; s < ord+1; s++) {
+            r_st(s) = state(idR,hs+k,j+s,hs+i,iens);
+            v_st(s) = state(idV,hs+k,j+s,hs+i,iens);
+            p_st(s) = pressure(hs+k,j+s,hs+i,iens);
+          }
+          SArray<real,1,ord> stencil;
+          // ACOUSTIC
+          real rv, pp;
+          {
+            // rho*v (left estimate)
+            for (int s=0; s < ord; s++) { stencil(s) = r_st(s  )*v_st(s  ); }
+            real rv_L = reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1);
+            // rho*v (right estimate)
+            for (int s=0; s < ord; s++) { stencil(s) = r_st(s+1)*v_st(s+1); }
+            real rv_R = reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,0);
+            // pressure perturbation (left estimate)
+            for (int s=0; s < ord; s++) { stencil(s) = p_st(s  ); }
+            real pp_L = reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1);
+            // pressure perturbation (right estimate)
+            for (int s=0; s < ord; s++) { stencil(s) = p_st(s+1); }
+            real pp_R = reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,0);
+            // Characteristics & upwind values
+            real w1 = 0.5_fp * (pp_R-cs*rv_R);
+            real w2 = 0.5_fp * (pp_L+cs*rv_L);
+            pp = w1+w2;
+            rv = (w2-w1)/cs;
+            state_flux_y(idR,k,j,i,iens) = rv;
+          }
+          // ADVECTIVE
+          int j_upw = rv > 0 ? 0 : 1;
+          // u-velocity
+          for (int s=0; s < ord; s++) { stencil(s) = state(idU,hs+k,j+j_upw+s,hs+i,iens); }
+          state_flux_y(idU,k,j,i,iens) = rv * reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1-j_upw);
+          // v-velocity
+          for (int s=0; s < ord; s++) { stencil(s) = v_st(j_upw+s); }
+          state_flux_y(idV,k,j,i,iens) = rv * reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1-j_upw) + pp;
+          // w-velocity
+          for (int s=0; s < ord; s++) { stencil(s) = state(idW,hs+k,j+j_upw+s,hs+i,iens); }
+          state_flux_y(idW,k,j,i,iens) = rv * reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1-j_upw);
+          // theta
+          for (int s=0; s < ord; s++) { stencil(s) = state(idT,hs+k,j+j_upw+s,hs+i,iens); }
+          state_flux_y(idT,k,j,i,iens) = rv * reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1-j_upw);
+          // tracers
+          for (int tr=0; tr < num_tracers; tr++) {
+            for (int s=0; s < ord; s++) { stencil(s) = tracers(tr,hs+k,j+j_upw+s,hs+i,iens); }
+            tracers_flux_y(tr,k,j,i,iens) = rv * reconstruct(stencil,coefs_to_gll,sten_to_coefs,weno_recon_lower,idl,sigma,1-j_upw);
           }
+        } else {
+          state_flux_y(idR,k,j,i,iens) = 0;
+          state_flux_y(idU,k,j,i,iens) = 0;
+          state_flux_y(idV,k,j,i,iens) = 0;
+          state_flux_y(idW,k,j,i,iens) = 0;
+          state_flux_y(idT,k,j,i,iens) = 0;
+          for (int tr=0; tr < num_tracers; tr++) { tracers_flux_y(tr,k,j,i,iens) = 0; }
         }
-        if (l == idV && sim2d) state_tend(l,k,j,i,iens) = 0;
       }
-      for (int l = 0; l < num_tracers; l++) {
-        real fx   = tracers_flux_x(l,k  ,j  ,i  ,iens);
-        real fxp1 = tracers_flux_x(l,k  ,j  ,i+1,iens);
-        real fy   = tracers_flux_y(l,k  ,j  ,i  ,iens);
-        real fyp1 = tracers_flux_y(l,k  ,j+1,i  ,iens);
-        real fz   = tracers_flux_z(l,k  ,j  ,i  ,iens);
-        real fzp1 = tracers_flux_z(l,k+1,j  ,i  ,iens);
-        if (i == 0   ) {
-          fx = std::min( fx , tracers_flux_x(l,k,j,nx,iens) );
+
+      ////////////////////////////////////////////////////////
+      // Z-direction
+      ////////////////////////////////////////////////////////
+      if (do_z && i < nx && j < ny) {
+        SArray<real,2,ord,ord>  s2c_loc[2];
+        SArray<real,3,hs,hs,hs> wrl_loc[2];
+        for (int i1=0; i1 < ord; i1++) {
+          for (int i2=0; i2 < ord; i2++) {
+            s2c_loc[0](i1,i2) = vert_sten_to_coefs(k  ,i1,i2,iens);
+            s2c_loc[1](i1,i2) = vert_sten_to_coefs(k+1,i1,i2,iens);
+          }
+        }
+        for (int i1=0; i1 < hs; i1++) {
+          for (int i2=0; i2 < hs; i2++) {
+            for (int i3=0; i3 < hs; i3++) {
+              wrl_loc[0](i1,i2,i3) = vert_weno_recon_lower(k  ,i1,i2,i3,iens);
+              wrl_loc[1](i1,i2,i3) = vert_weno_recon_lower(k+1,i1,i2,i3,iens);
+            }
+          }
+        }
+        SArray<real,1,ord+1> r_st, w_st, p_st;
+        for (int s=0; s < ord+1; s++) {
+          r_st(s) = state(idR,k+s,hs+j,hs+i,iens);
+          w_st(s) = state(idW,k+s,hs+j,hs+i,iens);
+          p_st(s) = pressure(k+s,hs+j,hs+i,iens);
+        }
+        SArray<real,1,ord> stencil;
+        // ACOUSTIC
+        real rw, pp;
+        {
+          // rho*w (left estimate)
+          for (int s=0; s < ord; s++) { stencil(s) = r_st(s  )*w_st(s  ); }
+          real rw_L = reconstruct(stencil,coefs_to_gll,s2c_loc[0],wrl_loc[0],idl,sigma,1);
+          if ((k == 0 || k == nz)) rw_L = 0;
+          // rho*w (right estimate)
+          for (int s=0; s < ord; s++) { stencil(s) = r_st(s+1)*w_st(s+1); }
+          real rw_R = reconstruct(stencil,coefs_to_gll,s2c_loc[1],wrl_loc[1],idl,sigma,0);
+          if ((k == 0 || k == nz)) rw_R = 0;
+          // pressure perturbation (left estimate)
+          for (int s=0; s < ord; s++) { stencil(s) = p_st(s  ); }
+          real pp_L = reconstruct(stencil,coefs_to_gll,s2c_loc[0],wrl_loc[0],idl,sigma,1);
+          // pressure perturbation (right estimate)
+          for (int s=0; s < ord; s++) { stencil(s) = p_st(s+1); }
+          real pp_R = reconstruct(stencil,coefs_to_gll,s2c_loc[1],wrl_loc[1],idl,sigma,0);
+          // Characteristics & upwind values
+          real w1 = 0.5_fp * (pp_R-cs*rw_R);
+          real w2 = 0.5_fp * (pp_L+cs*rw_L);
+          pp = w1+w2;
+          rw = (w2-w1)/cs;
+          if (k == 0 || k == nz) rw = 0;
+          state_flux_z(idR,k,j,i,iens) = rw;
+        }
+        // ADVECTIVE
+        int k_upw = rw > 0 ? 0 : 1;
+        // u-velocity
+        for (int s=0; s < ord; s++) { stencil(s) = state(idU,k+k_upw+s,hs+j,hs+i,iens); }
+        state_flux_z(idU,k,j,i,iens) = rw * reconstruct(stencil,coefs_to_gll,s2c_loc[k_upw],wrl_loc[k_upw],idl,sigma,1-k_upw);
+        // v-velocity
+        for (int s=0; s < ord; s++) { stencil(s) = state(idV,k+k_upw+s,hs+j,hs+i,iens); }
+        state_flux_z(idV,k,j,i,iens) = rw * reconstruct(stencil,coefs_to_gll,s2c_loc[k_upw],wrl_loc[k_upw],idl,sigma,1-k_upw);
+        // w-velocity
+        for (int s=0; s < ord; s++) { stencil(s) = w_st(k_upw+s); }
+        state_flux_z(idW,k,j,i,iens) = rw * reconstruct(stencil,coefs_to_gll,s2c_loc[k_upw],wrl_loc[k_upw],idl,sigma,1-k_upw) + pp;
+        // theta
+        for (int s=0; s < ord; s++) { stencil(s) = state(idT,k+k_upw+s,hs+j,hs+i,iens); }
+        state_flux_z(idT,k,j,i,iens) = rw * reconstruct(stencil,coefs_to_gll,s2c_loc[k_upw],wrl_loc[k_upw],idl,sigma,1-k_upw);
+        // tracers
+        for (int tr=0; tr < num_tracers; tr++) {
+          for (int s=0; s < ord; s++) { stencil(s) = tracers(tr,k+k_upw+s,hs+j,hs+i,iens); }
+          tracers_flux_z(tr,k,j,i,iens) = rw * reconstruct(stencil,coefs_to_gll,s2c_loc[k_upw],wrl_loc[k_upw],idl,sigma,1-k_upw);
         }
-        if (i == nx-1) { fxp1 = std::min( fxp1 , tracers_flux_x(l,k,j,0 ,iens) ); }
-        if (j == 0   ) { fy   = std::min( fy   , tracers_flux_y(l,k,ny,i,iens) ); }
-        if (j == ny-1) { fyp1 = std::min( fyp1 , tracers_flux_y(l,k,0 ,i,iens) ); }
-        tracers_tend(l,k,j,i,iens) = -( fxp1 - fx ) / dx
-                                     -( fyp1 - fy ) / dy
-                                     -( fzp1 - fz ) / dz(k,iens);
       }
     });
 
@@ -605,10 +1333,24 @@ class Dycore {
 
 
 
+  // Fill the halos of state, tracers, and pressure
   void halo_exchange( pam::PamCoupler const &coupler  ,
                       real5d          const &state    ,
                       real5d          const &tracers  ,
                       real4d          const &pressure ) const {
+    auto requests = halo_exchange_begin( coupler , state , tracers , pressure );
+    halo_exchange_end( coupler , state , tracers , pressure , requests );
+  }
+
+
+
+  // Start filling the halos of state, tracers, and pressure. This applies the vertical boundary conditions and the
+  // periodic wrap-around for directions that are not decomposed, and it packs and posts the messages to the x and y
+  // neighbors. Halos from other processes are not valid until halo_exchange_end returns
+  HaloRequests halo_exchange_begin( pam::PamCoupler const &coupler  ,
+                                    real5d          const &state    ,
+                                    real5d          const &tracers  ,
+                                    real4d          const &pressure ) const {
     using yakl::c::parallel_for;
     using yakl::c::SimpleBounds;
 
@@ -626,21 +1368,59 @@ class Dycore {
 
     int npack = num_state + num_tracers + 1;
 
-    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<5>(npack,nz,ny,hs,nens) ,
-                                      YAKL_LAMBDA (int v, int k, int j, int ii, int iens) {
-      if (v < num_state) {
-        state  (v          ,hs+k,hs+j,nx+hs+ii,iens) = state  (v          ,hs+k,hs+j,hs+ii,iens);
-        state  (v          ,hs+k,hs+j,      ii,iens) = state  (v          ,hs+k,hs+j,nx+ii,iens);
-      } else if (v < num_state + num_tracers) {
-        tracers(v-num_state,hs+k,hs+j,nx+hs+ii,iens) = tracers(v-num_state,hs+k,hs+j,hs+ii,iens);
-        tracers(v-num_state,hs+k,hs+j,      ii,iens) = tracers(v-num_state,hs+k,hs+j,nx+ii,iens);
-      } else {
-        pressure(hs+k,hs+j,nx+hs+ii,iens) = pressure(hs+k,hs+j,hs+ii,iens);
-        pressure(hs+k,hs+j,      ii,iens) = pressure(hs+k,hs+j,nx+ii,iens);
-      }
-    });
+    HaloRequests requests;
 
-    if (!sim2d) {
+    if (par.nprocx > 1) {
+      auto halo_send_x = workspace.halo_send_x;
+      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<5>(npack,nz,ny,hs,nens) ,
+                                        YAKL_LAMBDA (int v, int k, int j, int ii, int iens) {
+        if (v < num_state) {
+          halo_send_x(0,v,k,j,ii,iens) = state  (v          ,hs+k,hs+j,hs+ii,iens);
+          halo_send_x(1,v,k,j,ii,iens) = state  (v          ,hs+k,hs+j,nx+ii,iens);
+        } else if (v < num_state + num_tracers) {
+          halo_send_x(0,v,k,j,ii,iens) = tracers(v-num_state,hs+k,hs+j,hs+ii,iens);
+          halo_send_x(1,v,k,j,ii,iens) = tracers(v-num_state,hs+k,hs+j,nx+ii,iens);
+        } else {
+          halo_send_x(0,v,k,j,ii,iens) = pressure(hs+k,hs+j,hs+ii,iens);
+          halo_send_x(1,v,k,j,ii,iens) = pressure(hs+k,hs+j,nx+ii,iens);
+        }
+      });
+      post_halo_buffers( workspace.halo_send_x , workspace.halo_send_x_host , workspace.halo_recv_x_host ,
+                         par.x_neigh(0) , par.x_neigh(1) , requests );
+    } else {
+      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<5>(npack,nz,ny,hs,nens) ,
+                                        YAKL_LAMBDA (int v, int k, int j, int ii, int iens) {
+        if (v < num_state) {
+          state  (v          ,hs+k,hs+j,nx+hs+ii,iens) = state  (v          ,hs+k,hs+j,hs+ii,iens);
+          state  (v          ,hs+k,hs+j,      ii,iens) = state  (v          ,hs+k,hs+j,nx+ii,iens);
+        } else if (v < num_state + num_tracers) {
+          tracers(v-num_state,hs+k,hs+j,nx+hs+ii,iens) = tracers(v-num_state,hs+k,hs+j,hs+ii,iens);
+          tracers(v-num_state,hs+k,hs+j,      ii,iens) = tracers(v-num_state,hs+k,hs+j,nx+ii,iens);
+        } else {
+          pressure(hs+k,hs+j,nx+hs+ii,iens) = pressure(hs+k,hs+j,hs+ii,iens);
+          pressure(hs+k,hs+j,      ii,iens) = pressure(hs+k,hs+j,nx+ii,iens);
+        }
+      });
+    }
+
+    if (par.nprocy > 1) {
+      auto halo_send_y = workspace.halo_send_y;
+      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<5>(npack,nz,hs,nx,nens) ,
+                                        YAKL_LAMBDA (int v, int k, int jj, int i, int iens) {
+        if (v < num_state) {
+          halo_send_y(0,v,k,jj,i,iens) = state  (v          ,hs+k,hs+jj,hs+i,iens);
+          halo_send_y(1,v,k,jj,i,iens) = state  (v          ,hs+k,ny+jj,hs+i,iens);
+        } else if (v < num_state + num_tracers) {
+          halo_send_y(0,v,k,jj,i,iens) = tracers(v-num_state,hs+k,hs+jj,hs+i,iens);
+          halo_send_y(1,v,k,jj,i,iens) = tracers(v-num_state,hs+k,ny+jj,hs+i,iens);
+        } else {
+          halo_send_y(0,v,k,jj,i,iens) = pressure(hs+k,hs+jj,hs+i,iens);
+          halo_send_y(1,v,k,jj,i,iens) = pressure(hs+k,ny+jj,hs+i,iens);
+        }
+      });
+      post_halo_buffers( workspace.halo_send_y , workspace.halo_send_y_host , workspace.halo_recv_y_host ,
+                         par.y_neigh(0) , par.y_neigh(1) , requests );
+    } else if (!sim2d) {
       parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<5>(npack,nz,hs,nx,nens) ,
                                         YAKL_LAMBDA (int v, int k, int jj, int i, int iens) {
         if (v < num_state) {
@@ -708,6 +1488,139 @@ class Dycore {
         }
       }
     });
+    return requests;
+  }
+
+
+
+  // Wait for the messages posted by halo_exchange_begin, and unpack the x and y halos received from the neighbors
+  void halo_exchange_end( pam::PamCoupler const &coupler  ,
+                          real5d          const &state    ,
+                          real5d          const &tracers  ,
+                          real4d          const &pressure ,
+                          HaloRequests          &requests ) const {
+    using yakl::c::parallel_for;
+    using yakl::c::SimpleBounds;
+
+    if (requests.num == 0) return;
+    MPI_Waitall( requests.num , requests.req , MPI_STATUSES_IGNORE );
+    requests.num = 0;
+
+    auto nens        = coupler.get_nens();
+    auto nx          = coupler.get_nx();
+    auto ny          = coupler.get_ny();
+    auto nz          = coupler.get_nz();
+    auto num_tracers = coupler.get_num_tracers();
+
+    int npack = num_state + num_tracers + 1;
+
+    if (par.nprocx > 1) {
+      auto halo_recv_x = workspace.halo_recv_x;
+      workspace.halo_recv_x_host.deep_copy_to(halo_recv_x);
+      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<5>(npack,nz,ny,hs,nens) ,
+                                        YAKL_LAMBDA (int v, int k, int j, int ii, int iens) {
+        if (v < num_state) {
+          state  (v          ,hs+k,hs+j,      ii,iens) = halo_recv_x(0,v,k,j,ii,iens);
+          state  (v          ,hs+k,hs+j,nx+hs+ii,iens) = halo_recv_x(1,v,k,j,ii,iens);
+        } else if (v < num_state + num_tracers) {
+          tracers(v-num_state,hs+k,hs+j,      ii,iens) = halo_recv_x(0,v,k,j,ii,iens);
+          tracers(v-num_state,hs+k,hs+j,nx+hs+ii,iens) = halo_recv_x(1,v,k,j,ii,iens);
+        } else {
+          pressure(hs+k,hs+j,      ii,iens) = halo_recv_x(0,v,k,j,ii,iens);
+          pressure(hs+k,hs+j,nx+hs+ii,iens) = halo_recv_x(1,v,k,j,ii,iens);
+        }
+      });
+    }
+
+    if (par.nprocy > 1) {
+      auto halo_recv_y = workspace.halo_recv_y;
+      workspace.halo_recv_y_host.deep_copy_to(halo_recv_y);
+      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<5>(npack,nz,hs,nx,nens) ,
+                                        YAKL_LAMBDA (int v, int k, int jj, int i, int iens) {
+        if (v < num_state) {
+          state  (v          ,hs+k,      jj,hs+i,iens) = halo_recv_y(0,v,k,jj,i,iens);
+          state  (v          ,hs+k,ny+hs+jj,hs+i,iens) = halo_recv_y(1,v,k,jj,i,iens);
+        } else if (v < num_state + num_tracers) {
+          tracers(v-num_state,hs+k,      jj,hs+i,iens) = halo_recv_y(0,v,k,jj,i,iens);
+          tracers(v-num_state,hs+k,ny+hs+jj,hs+i,iens) = halo_recv_y(1,v,k,jj,i,iens);
+        } else {
+          pressure(hs+k,      jj,hs+i,iens) = halo_recv_y(0,v,k,jj,i,iens);
+          pressure(hs+k,ny+hs+jj,hs+i,iens) = halo_recv_y(1,v,k,jj,i,iens);
+        }
+      });
+    }
+  }
+
+
+
+  // Exchange the FCT-limited tracer fluxes on decomposed domain edges. Afterward, edge_recv_x(0,...) holds the left
+  // neighbor's flux on my left edge, and edge_recv_x(1,...) holds the right neighbor's flux on my right edge (same in y)
+  void exchange_edge_fluxes( pam::PamCoupler const &coupler        ,
+                             realConst5d           tracers_flux_x ,
+                             realConst5d           tracers_flux_y ) const {
+    using yakl::c::parallel_for;
+    using yakl::c::SimpleBounds;
+
+    auto nens        = coupler.get_nens();
+    auto nx          = coupler.get_nx();
+    auto ny          = coupler.get_ny();
+    auto nz          = coupler.get_nz();
+    auto num_tracers = coupler.get_num_tracers();
+
+    if (par.nprocx > 1) {
+      auto edge_send_x = workspace.edge_send_x;
+      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(num_tracers,nz,ny,nens) , YAKL_LAMBDA (int l, int k, int j, int iens) {
+        edge_send_x(0,l,k,j,iens) = tracers_flux_x(l,k,j,0 ,iens);
+        edge_send_x(1,l,k,j,iens) = tracers_flux_x(l,k,j,nx,iens);
+      });
+      exchange_halo_buffers( workspace.edge_send_x , workspace.edge_send_x_host ,
+                             workspace.edge_recv_x , workspace.edge_recv_x_host , par.x_neigh(0) , par.x_neigh(1) );
+    }
+    if (par.nprocy > 1) {
+      auto edge_send_y = workspace.edge_send_y;
+      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(num_tracers,nz,nx,nens) , YAKL_LAMBDA (int l, int k, int i, int iens) {
+        edge_send_y(0,l,k,i,iens) = tracers_flux_y(l,k,0 ,i,iens);
+        edge_send_y(1,l,k,i,iens) = tracers_flux_y(l,k,ny,i,iens);
+      });
+      exchange_halo_buffers( workspace.edge_send_y , workspace.edge_send_y_host ,
+                             workspace.edge_recv_y , workspace.edge_recv_y_host , par.y_neigh(0) , par.y_neigh(1) );
+    }
+  }
+
+
+
+  // Send each half of a packed halo buffer to one neighbor and receive the matching halves from them. Index 0 of the
+  // leading dimension goes to / comes from neigh_lo, and index 1 goes to / comes from neigh_hi. Data is staged
+  // through host buffers, so MPI does not need to be GPU-aware. recv_host is only valid after the requests complete
+  template <class DEV_ARR, class HOST_ARR>
+  void post_halo_buffers( DEV_ARR      const &send      ,
+                          HOST_ARR     const &send_host ,
+                          HOST_ARR     const &recv_host ,
+                          int neigh_lo , int neigh_hi   ,
+                          HaloRequests       &requests  ) const {
+    int count = send.size() / 2;
+    // Pre-post the receives
+    MPI_Irecv( recv_host.data()       , count , AWFL_MPI_REAL , neigh_lo , 0 , MPI_COMM_WORLD , &requests.req[requests.num++] );
+    MPI_Irecv( recv_host.data()+count , count , AWFL_MPI_REAL , neigh_hi , 1 , MPI_COMM_WORLD , &requests.req[requests.num++] );
+    send.deep_copy_to(send_host);
+    yakl::fence();
+    MPI_Isend( send_host.data()       , count , AWFL_MPI_REAL , neigh_lo , 1 , MPI_COMM_WORLD , &requests.req[requests.num++] );
+    MPI_Isend( send_host.data()+count , count , AWFL_MPI_REAL , neigh_hi , 0 , MPI_COMM_WORLD , &requests.req[requests.num++] );
+  }
+
+
+
+  // Blocking version of post_halo_buffers that leaves the received data in recv on the device
+  template <class DEV_ARR, class HOST_ARR>
+  void exchange_halo_buffers( DEV_ARR  const &send      ,
+                              HOST_ARR const &send_host ,
+                              DEV_ARR  const &recv      ,
+                              HOST_ARR const &recv_host ,
+                              int neigh_lo , int neigh_hi ) const {
+    HaloRequests requests;
+    post_halo_buffers( send , send_host , recv_host , neigh_lo , neigh_hi , requests );
+    MPI_Waitall( requests.num , requests.req , MPI_STATUSES_IGNORE );
+    recv_host.deep_copy_to(recv);
   }
 
 
@@ -842,11 +1755,16 @@ class Dycore {
     auto nz          = coupler.get_nz();
     auto dx          = coupler.get_dx();
     auto dy          = coupler.get_dy();
-    auto xlen        = coupler.get_xlen();
-    auto ylen        = coupler.get_ylen();
     auto sim2d       = ny == 1;
     auto num_tracers = coupler.get_num_tracers();
 
+    // Idealized test cases are defined on the global domain
+    setup_parallel( coupler );
+    auto xlen        = par.xlen_glob;
+    auto ylen        = par.ylen_glob;
+    auto i_beg       = par.i_beg;
+    auto j_beg       = par.j_beg;
+
 
     int nbands = 5;
     int n      = 5;
@@ -874,6 +1792,7 @@ class Dycore {
     if (! coupler.option_exists("cp_v"    )) coupler.set_option<real>("cp_v"    ,1859       );
     if (! coupler.option_exists("p0"      )) coupler.set_option<real>("p0"      ,1.e5       );
     if (! coupler.option_exists("grav"    )) coupler.set_option<real>("grav"    ,9.81       );
+    if (! coupler.option_exists("awfl_time_integrator")) coupler.set_option<std::string>("awfl_time_integrator","ssprk3");
     auto R_d  = coupler.get_option<real>("R_d" );
     auto cp_d = coupler.get_option<real>("cp_d");
     auto R_v  = coupler.get_option<real>("R_v" );
@@ -983,6 +1902,9 @@ class Dycore {
     dm.register_and_allocate<real>("hy_dens_cells"    ,"",{nz,nens});
     dm.register_and_allocate<real>("hy_pressure_cells","",{nz,nens});
 
+    // Size the persistent workspace once here so that timeStep does not need to allocate
+    allocate_workspace( coupler );
+
     int static constexpr DATA_SPEC_THERMAL   = 0;
     int static constexpr DATA_SPEC_SUPERCELL = 1;
     int static constexpr DATA_SPEC_EXTERNAL  = 2;
@@ -1009,8 +1931,8 @@ class Dycore {
     if (data_spec == DATA_SPEC_EXTERNAL) {
 
     } else {
-      real5d state  ("state"  ,num_state  ,nz+2*hs,ny+2*hs,nx+2*hs,nens);
-      real5d tracers("tracers",num_tracers,nz+2*hs,ny+2*hs,nx+2*hs,nens);
+      auto state   = workspace.state;
+      auto tracers = workspace.tracers;
 
       auto zmid = dm.get<real const,2>("vertical_midpoint_height");
 
@@ -1054,8 +1976,8 @@ class Dycore {
           for (int kk=0; kk<nqpoints; kk++) {
             for (int jj=0; jj<nqpoints; jj++) {
               for (int ii=0; ii<nqpoints; ii++) {
-                real x = (i+0.5)*dx   + qpoints(ii)*dx;
-                real y = (j+0.5)*dy   + qpoints(jj)*dy;   if (sim2d) y = ylen/2;
+                real x = (i_beg+i+0.5)*dx + qpoints(ii)*dx;
+                real y = (j_beg+j+0.5)*dy + qpoints(jj)*dy;   if (sim2d) y = ylen/2;
                 real z = zmid(k,iens) + qpoints(kk)*dz(k,iens);
 
                 real hr = hy_dens_cells    (k,iens);
@@ -1114,8 +2036,10 @@ class Dycore {
     auto nz          = coupler.get_nz();
     auto dx          = coupler.get_dx();
     auto dy          = coupler.get_dy();
-    auto xlen        = coupler.get_xlen();
-    auto ylen        = coupler.get_ylen();
+    auto xlen        = par.xlen_glob;
+    auto ylen        = par.ylen_glob;
+    auto i_beg       = par.i_beg;
+    auto j_beg       = par.j_beg;
     auto sim2d       = ny == 1;
     auto R_d         = coupler.get_option<real>("R_d"    );
     auto R_v         = coupler.get_option<real>("R_v"    );
@@ -1250,8 +2174,8 @@ class Dycore {
       for (int kk=0; kk < ngll; kk++) {
         for (int jj=0; jj < ngll; jj++) {
           for (int ii=0; ii < ngll; ii++) {
-            real xloc = (i+0.5_fp)*dx + gll_pts(ii)*dx;
-            real yloc = (j+0.5_fp)*dy + gll_pts(jj)*dy;
+            real xloc = (i_beg+i+0.5_fp)*dx + gll_pts(ii)*dx;
+            real yloc = (j_beg+j+0.5_fp)*dy + gll_pts(jj)*dy;
             real zloc = zmid(k,iens)  + gll_pts(kk)*dz(k,iens);
 
             if (sim2d) yloc = ylen/2;
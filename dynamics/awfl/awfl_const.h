@@ -6,6 +6,7 @@
 #include "YAKL.h"
 #include "YAKL_netcdf.h"
 #include "YAKL_tridiagonal.h"
+#include "mpi.h"
 
 using yakl::c::parallel_for;
 using yakl::c::SimpleBounds;
@@ -30,6 +31,9 @@ using yakl::ScalarLiveOut;
 #endif
 
 
+#define AWFL_MPI_REAL MPI_DOUBLE
+
+
 int constexpr ord  = PAM_ORD;
 int constexpr ngll = PAM_TORD;
 
@@ -2,5 +2,5 @@
 
 rm -rf CMakeCache.txt  CMakeFiles  cmake_install.cmake  CTestTestfile.cmake  Makefile  \
        Testing  yakl  recon_regular  recon_irregular  anelastic_direct  burger_prim    \
-       matvec  yakl_timer_output.txt
+       matvec  flux_bench  yakl_timer_output.txt
 
@@ -9,5 +9,5 @@ export CXX=g++
 export CXXFLAGS="-O3 -DYAKL_AUTO_PROFILE"
 export FFLAGS="-O3"
 
-cmake ..
+cmake -DPAM_LINK_FLAGS="${PAM_LINK_FLAGS}" ..
 
@@ -9,5 +9,5 @@ export CXX=g++
 export CXXFLAGS="-O0 -g -DYAKL_DEBUG"
 export FFLAGS="-O0 -g"
 
-cmake ..
+cmake -DPAM_LINK_FLAGS="${PAM_LINK_FLAGS}" ..
 
@@ -12,6 +12,7 @@ export FFLAGS="-O3"
 export CXXFLAGS="-O3"
 
 cmake -DARCH="CUDA"                             \
+      -DPAM_LINK_FLAGS="${PAM_LINK_FLAGS}"      \
       -DCUDA_FLAGS="-O3 -arch sm_50 -ccbin g++" \
       ..
 
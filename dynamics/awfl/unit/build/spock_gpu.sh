@@ -13,6 +13,7 @@ unset CXXFLAGS
 export FFLAGS="-O3"
 
 cmake -DYAKL_ARCH="HIP"                             \
+      -DPAM_LINK_FLAGS="${PAM_LINK_FLAGS}"          \
       -DYAKL_HIP_FLAGS="-O3 -I${NETCDF_ROOT}/include -I${YAML_ROOT}/include -DYAKL_AUTO_PROFILE" \
       ..
 
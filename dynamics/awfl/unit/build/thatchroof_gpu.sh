@@ -10,6 +10,7 @@ unset CXXFLAGS
 export FFLAGS="-O3"
 
 cmake -DYAKL_ARCH="CUDA"                             \
+      -DPAM_LINK_FLAGS="${PAM_LINK_FLAGS}"          \
       -DYAKL_CUDA_FLAGS="-O3 -arch sm_35 --use_fast_math -DYAKL_AUTO_PROFILE -ccbin g++ -DTHRUST_IGNORE_CUB_VERSION_CHECK" \
       ..
 
@@ -0,0 +1,190 @@
+
+#include "Dycore.h"
+#include <chrono>
+#include <iomanip>
+
+// Compares the reference and register-staged AWFL edge flux kernels. The fluxes must agree bitwise. For each kernel
+// the measured time is reported along with the achieved effective bandwidth (the bytes of every array the kernel must
+// read and write at least once, divided by the measured time) and the achieved flop rate. A device copy kernel over
+// the same number of bytes is timed as well, so the effective bandwidth can be read against the measured attainable
+// bandwidth of the device. Usage: ./flux_bench [nx ny nz nens num_tracers nreps]. Defaults are production MMF sizes.
+
+
+// Approximate floating point operation count for one call to Dycore::reconstruct
+int constexpr flops_per_reconstruct() {
+  int constexpr ord = Dycore::ord;
+  int constexpr hs  = (ord-1)/2;
+  return 2*(hs+1)*(hs+1)*(hs+1)     // Low-order candidate polynomials
+       + 2*ord*ord                  // High-order polynomial
+       + 2*(hs+1)*(hs+1) + ord      // Bridge polynomial
+       + 3*(hs+1)*(hs+1) + 3*ord    // Total variation of each candidate
+       + (hs+1) + 4                 // Bridge TV adjustment
+       + 4*(hs+2)                   // WENO weights
+       + 2*(2*(hs+2)+1)             // Two convexify passes
+       + 12*(hs+2)                  // Weight mapping
+       + 2*ord + 2*(hs+1)*(hs+1)    // Weighted polynomial
+       + 2*ord;                     // Sample at the GLL point
+}
+
+
+double flops_per_cell( int num_tracers ) {
+  int constexpr num_state = Dycore::num_state;
+  // Four acoustic reconstructions plus one per advected quantity in each direction
+  return 3. * ( 4 + (num_state-1) + num_tracers ) * flops_per_reconstruct();
+}
+
+
+int main(int argc, char **argv) {
+  MPI_Init( &argc , &argv );
+  yakl::init();
+  {
+    using yakl::c::parallel_for;
+    using yakl::c::SimpleBounds;
+    using yakl::intrinsics::maxval;
+    using yakl::intrinsics::abs;
+    using yakl::componentwise::operator-;
+
+    int nx          = argc > 1 ? std::stoi(argv[1]) : 64;
+    int ny          = argc > 2 ? std::stoi(argv[2]) : 64;
+    int nz          = argc > 3 ? std::stoi(argv[3]) : 58;
+    int nens        = argc > 4 ? std::stoi(argv[4]) : 16;
+    int num_tracers = argc > 5 ? std::stoi(argv[5]) : 5;
+    int nreps       = argc > 6 ? std::stoi(argv[6]) : 10;
+    real xlen = nx * 1000;
+    real ylen = ny * 1000;
+    real zlen = 20000;
+
+    pam::PamCoupler coupler;
+    coupler.allocate_coupler_state( nz , ny , nx , nens );
+    real1d zint("zint",nz+1);
+    parallel_for( YAKL_AUTO_LABEL() , nz+1 , YAKL_LAMBDA (int k) { zint(k) = k*zlen/nz; });
+    coupler.set_grid( xlen , ylen , zint );
+    coupler.add_tracer( "water_vapor" , "" , true , true );
+    for (int tr=1; tr < num_tracers; tr++) {
+      coupler.add_tracer( std::string("tracer_")+std::to_string(tr) , "" , true , false );
+    }
+
+    Dycore dycore;
+    dycore.init( coupler );
+
+    // Smooth fields with sharp features so that the WENO weights are exercised
+    {
+      auto &dm = coupler.get_data_manager_device_readwrite();
+      auto rho_d = dm.get<real,4>("density_dry");
+      auto uvel  = dm.get<real,4>("uvel"       );
+      auto vvel  = dm.get<real,4>("vvel"       );
+      auto wvel  = dm.get<real,4>("wvel"       );
+      auto temp  = dm.get<real,4>("temp"       );
+      pam::MultiField<real,4> dm_tracers;
+      auto tracer_names = coupler.get_tracer_names();
+      for (int tr=0; tr < num_tracers; tr++) { dm_tracers.add_field( dm.get<real,4>(tracer_names[tr]) ); }
+      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
+        real x = (i+0.5_fp)/nx;
+        real y = (j+0.5_fp)/ny;
+        real z = (k+0.5_fp)/nz;
+        rho_d(k,j,i,iens) = 1.2_fp*std::exp(-z) * (1 + 0.01_fp*std::sin(2*M_PI*x));
+        uvel (k,j,i,iens) = 10*std::sin(2*M_PI*(x+y)) + (x > 0.5_fp ? 5 : -5);
+        vvel (k,j,i,iens) = 5 *std::cos(2*M_PI*y);
+        wvel (k,j,i,iens) = 2 *std::sin(M_PI*z)*std::sin(2*M_PI*x);
+        temp (k,j,i,iens) = 300 - 60*z + (std::abs(x-0.5_fp) < 0.1_fp ? 2 : 0);
+        for (int tr=0; tr < num_tracers; tr++) {
+          dm_tracers(tr,k,j,i,iens) = 0.01_fp*std::exp(-4*z) * (x*y > 0.25_fp ? 1 : 0.1_fp);
+        }
+      });
+    }
+
+    auto state    = dycore.workspace.state;
+    auto tracers  = dycore.workspace.tracers;
+    auto pressure = dycore.workspace.pressure;
+    dycore.convert_coupler_to_dynamics( coupler , state , tracers );
+    dycore.convert_to_primitives      ( coupler , state , tracers , pressure );
+
+    real5d ref_flux_x    ("ref_flux_x"    ,Dycore::num_state,nz,ny,nx+1,nens);
+    real5d ref_flux_y    ("ref_flux_y"    ,Dycore::num_state,nz,ny+1,nx,nens);
+    real5d ref_flux_z    ("ref_flux_z"    ,Dycore::num_state,nz+1,ny,nx,nens);
+    real5d ref_tr_flux_x ("ref_tr_flux_x" ,num_tracers      ,nz,ny,nx+1,nens);
+    real5d ref_tr_flux_y ("ref_tr_flux_y" ,num_tracers      ,nz,ny+1,nx,nens);
+    real5d ref_tr_flux_z ("ref_tr_flux_z" ,num_tracers      ,nz+1,ny,nx,nens);
+    real5d stg_flux_x    ("stg_flux_x"    ,Dycore::num_state,nz,ny,nx+1,nens);
+    real5d stg_flux_y    ("stg_flux_y"    ,Dycore::num_state,nz,ny+1,nx,nens);
+    real5d stg_flux_z    ("stg_flux_z"    ,Dycore::num_state,nz+1,ny,nx,nens);
+    real5d stg_tr_flux_x ("stg_tr_flux_x" ,num_tracers      ,nz,ny,nx+1,nens);
+    real5d stg_tr_flux_y ("stg_tr_flux_y" ,num_tracers      ,nz,ny+1,nx,nens);
+    real5d stg_tr_flux_z ("stg_tr_flux_z" ,num_tracers      ,nz+1,ny,nx,nens);
+
+    // Warm up both kernels before timing
+    dycore.compute_fluxes_reference( coupler , state , tracers , pressure ,
+                                     ref_flux_x , ref_flux_y , ref_flux_z , ref_tr_flux_x , ref_tr_flux_y , ref_tr_flux_z );
+    dycore.compute_fluxes_staged   ( coupler , state , tracers , pressure ,
+                                     stg_flux_x , stg_flux_y , stg_flux_z , stg_tr_flux_x , stg_tr_flux_y , stg_tr_flux_z );
+    yakl::fence();
+
+    yakl::timer_start("flux_reference");
+    auto t1 = std::chrono::steady_clock::now();
+    for (int irep=0; irep < nreps; irep++) {
+      dycore.compute_fluxes_reference( coupler , state , tracers , pressure ,
+                                       ref_flux_x , ref_flux_y , ref_flux_z , ref_tr_flux_x , ref_tr_flux_y , ref_tr_flux_z );
+    }
+    yakl::fence();
+    auto t2 = std::chrono::steady_clock::now();
+    yakl::timer_stop("flux_reference");
+
+    yakl::timer_start("flux_staged");
+    for (int irep=0; irep < nreps; irep++) {
+      dycore.compute_fluxes_staged   ( coupler , state , tracers , pressure ,
+                                       stg_flux_x , stg_flux_y , stg_flux_z , stg_tr_flux_x , stg_tr_flux_y , stg_tr_flux_z );
+    }
+    yakl::fence();
+    auto t3 = std::chrono::steady_clock::now();
+    yakl::timer_stop("flux_staged");
+
+    // Compulsory traffic: read the state, tracers and pressure once, and write every flux once
+    double bytes = sizeof(real) * ( (double) state.totElems() + tracers.totElems() + pressure.totElems() +
+                                    ref_flux_x.totElems() + ref_flux_y.totElems() + ref_flux_z.totElems() +
+                                    ref_tr_flux_x.totElems() + ref_tr_flux_y.totElems() + ref_tr_flux_z.totElems() );
+
+    // Measured attainable bandwidth: a copy kernel that reads and writes the same total number of bytes
+    int ncopy = (int) (bytes / sizeof(real) / 2);
+    real1d copy_src("copy_src",ncopy);
+    real1d copy_dst("copy_dst",ncopy);
+    parallel_for( YAKL_AUTO_LABEL() , ncopy , YAKL_LAMBDA (int i) { copy_src(i) = i; });
+    yakl::fence();
+    auto t4 = std::chrono::steady_clock::now();
+    for (int irep=0; irep < nreps; irep++) {
+      parallel_for( YAKL_AUTO_LABEL() , ncopy , YAKL_LAMBDA (int i) { copy_dst(i) = copy_src(i); });
+    }
+    yakl::fence();
+    auto t5 = std::chrono::steady_clock::now();
+
+    real diff = 0;
+    diff = std::max( diff , maxval(abs(stg_flux_x    - ref_flux_x   )) );
+    diff = std::max( diff , maxval(abs(stg_flux_y    - ref_flux_y   )) );
+    diff = std::max( diff , maxval(abs(stg_flux_z    - ref_flux_z   )) );
+    diff = std::max( diff , maxval(abs(stg_tr_flux_x - ref_tr_flux_x)) );
+    diff = std::max( diff , maxval(abs(stg_tr_flux_y - ref_tr_flux_y)) );
+    diff = std::max( diff , maxval(abs(stg_tr_flux_z - ref_tr_flux_z)) );
+
+    double ncells   = (double) nx * ny * nz * nens;
+    double t_ref    = std::chrono::duration<double>(t2-t1).count() / nreps;
+    double t_stg    = std::chrono::duration<double>(t3-t2).count() / nreps;
+    double t_copy   = std::chrono::duration<double>(t5-t4).count() / nreps;
+    double flops    = flops_per_cell(num_tracers);
+    std::cout << "Grid (nx,ny,nz,nens,num_tracers): " << nx << " , " << ny << " , " << nz << " , " << nens << " , "
+              << num_tracers << "\n";
+    std::cout << std::scientific << std::setprecision(4);
+    std::cout << "device copy: time: " << t_copy << " , GB/s: " << bytes/t_copy*1.e-9 << "\n";
+    std::cout << "reference  : time: " << t_ref  << " , effective GB/s: " << bytes/t_ref*1.e-9
+              << " , GFLOP/s: " << flops*ncells/t_ref*1.e-9 << "\n";
+    std::cout << "staged     : time: " << t_stg  << " , effective GB/s: " << bytes/t_stg*1.e-9
+              << " , GFLOP/s: " << flops*ncells/t_stg*1.e-9 << "\n";
+    std::cout << "Max abs difference between kernels: " << diff << "\n";
+    if (diff != 0) {
+      std::cerr << "ERROR: staged and reference flux kernels differ" << std::endl;
+      yakl::finalize();
+      MPI_Finalize();
+      return 1;
+    }
+  }
+  yakl::finalize();
+  MPI_Finalize();
+}
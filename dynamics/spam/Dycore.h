@@ -162,7 +162,8 @@ public:
     // Create the outputter
     debug_print("start io init", par.masterproc);
     io.initialize(params.outputName, primal_topology, dual_topology, par,
-                  prognostic_vars, constant_vars, diagnostics, stats);
+                  prognostic_vars, constant_vars, diagnostics, stats,
+                  params.async_output);
     debug_print("finish io init", par.masterproc);
   };
 
@@ -298,7 +299,10 @@ public:
     yakl::timer_stop("timeStep");
   };
 
-  void finalize(PamCoupler &coupler) { io.outputStats(stats); }
+  void finalize(PamCoupler &coupler) {
+    io.outputStats(stats);
+    io.finalize();
+  }
 
   const char *dycore_name() const { return "SPAM++"; }
 };
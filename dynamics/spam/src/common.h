@@ -58,6 +58,15 @@ using optional_real5d = std::optional<real5d>;
 #define PAMC_MPI_REAL MPI_DOUBLE
 // #define REAL_NC NC_DOUBLE
 
+// MPI can read and write the device halo buffers directly if device memory is
+// host memory (CPU builds) or if MPI is GPU-aware. Exchanges then skip the host
+// mirrors and staging copies
+#if !(defined YAKL_ARCH_CUDA || defined YAKL_ARCH_HIP ||                       \
+      defined YAKL_ARCH_SYCL) ||                                               \
+    defined PAMC_GPU_AWARE_MPI
+#define PAMC_EXCHANGE_ZERO_COPY
+#endif
+
 // Spatial derivatives order of accuracy ie Hodge stars [2,4,6] (vert only
 // supports 2 for now)
 uint constexpr diff_ord = 2;
@@ -175,6 +184,9 @@ enum class ADD_MODE { REPLACE, ADD };
 
 // Boundary types
 enum class BND_TYPE { PERIODIC, NONE };
+
+// Norm types used to monitor convergence of iterative solvers
+enum class NORM_TYPE { MAX, L2, WEIGHTED_L2 };
 } // namespace pamc
 
 #if defined PAMC_LAYER && !defined PAMC_TESTMODEL
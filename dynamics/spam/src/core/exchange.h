@@ -12,6 +12,29 @@ namespace pamc {
 // Xm RecvBuf holds the halo cells closest to x- ie the left side
 // Xp SendBuf holds the halo cells closest to x+ ie the right side
 
+// Host mirrors of halo buffers used for MPI. With zero-copy exchanges the
+// mirror wraps the device buffer itself, so no memory is allocated and the
+// staging copies are no-ops
+realHost1d create_mpi_mirror(const real1d &buf) {
+#ifdef PAMC_EXCHANGE_ZERO_COPY
+  return realHost1d("halo_mpi_mirror", buf.data(), buf.extent(0));
+#else
+  return buf.createHostCopy();
+#endif
+}
+
+void stage_to_mpi(const real1d &buf, const realHost1d &mirror) {
+#ifndef PAMC_EXCHANGE_ZERO_COPY
+  buf.deep_copy_to(mirror);
+#endif
+}
+
+void stage_from_mpi(const realHost1d &mirror, const real1d &buf) {
+#ifndef PAMC_EXCHANGE_ZERO_COPY
+  mirror.deep_copy_to(buf);
+#endif
+}
+
 class Exchange {
 public:
   Topology topology;
@@ -62,12 +85,14 @@ public:
   real1d haloSendBuf_XYur;
   real1d haloRecvBuf_XYur;
 
-  // 4 corners in 2D
-  MPI_Request sReq[4];
-  MPI_Request rReq[4];
+  // x, y and 4 corners in 2D can all be in flight at once
+  MPI_Request sReq[8];
+  MPI_Request rReq[8];
 
-  MPI_Status sStat[4];
-  MPI_Status rStat[4];
+  MPI_Status sStat[8];
+  MPI_Status rStat[8];
+  int num_reqs = 0;
+  bool in_flight = false;
 
   bool is_initialized;
 
@@ -79,9 +104,18 @@ public:
   void unpack(real5d &data);
   void exchange();
   void exchange_data(real5d &data);
+  void exchange_begin(const real5d &data);
+  void exchange_end(real5d &data);
   void exchange_x();
   void exchange_y();
   void exchange_corners();
+  void post_x();
+  void post_y();
+  void post_corners();
+  void wait();
+  void finish_x();
+  void finish_y();
+  void finish_corners();
   void exchange_mirror(real5d &data);
   void exchange_direct_x(real5d &data);
   void exchange_direct_y(real5d &data);
@@ -142,45 +176,45 @@ void Exchange::initialize(const Topology &topo, int bdof, int edof, int nd) {
 
     this->haloSendBuf_Xm = real1d("haloSendBuf_Xm", this->bufsize_x);
     this->haloRecvBuf_Xm = real1d("haloRecvBuf_Xm", this->bufsize_x);
-    this->haloSendBuf_Xm_host = this->haloSendBuf_Xm.createHostCopy();
-    this->haloRecvBuf_Xm_host = this->haloRecvBuf_Xm.createHostCopy();
+    this->haloSendBuf_Xm_host = create_mpi_mirror(this->haloSendBuf_Xm);
+    this->haloRecvBuf_Xm_host = create_mpi_mirror(this->haloRecvBuf_Xm);
     this->haloSendBuf_Xp = real1d("haloSendBuf_Xp", this->bufsize_x);
     this->haloRecvBuf_Xp = real1d("haloRecvBuf_Xp", this->bufsize_x);
-    this->haloSendBuf_Xp_host = this->haloSendBuf_Xp.createHostCopy();
-    this->haloRecvBuf_Xp_host = this->haloRecvBuf_Xp.createHostCopy();
+    this->haloSendBuf_Xp_host = create_mpi_mirror(this->haloSendBuf_Xp);
+    this->haloRecvBuf_Xp_host = create_mpi_mirror(this->haloRecvBuf_Xp);
 
     if (ndims == 2) {
       this->haloSendBuf_Ym = real1d("haloSendBuf_Ym", this->bufsize_y);
       this->haloRecvBuf_Ym = real1d("haloRecvBuf_Ym", this->bufsize_y);
-      this->haloSendBuf_Ym_host = this->haloSendBuf_Ym.createHostCopy();
-      this->haloRecvBuf_Ym_host = this->haloRecvBuf_Ym.createHostCopy();
+      this->haloSendBuf_Ym_host = create_mpi_mirror(this->haloSendBuf_Ym);
+      this->haloRecvBuf_Ym_host = create_mpi_mirror(this->haloRecvBuf_Ym);
       this->haloSendBuf_Yp = real1d("haloSendBuf_Yp", this->bufsize_y);
       this->haloRecvBuf_Yp = real1d("haloRecvBuf_Yp", this->bufsize_y);
-      this->haloSendBuf_Yp_host = this->haloSendBuf_Yp.createHostCopy();
-      this->haloRecvBuf_Yp_host = this->haloRecvBuf_Yp.createHostCopy();
+      this->haloSendBuf_Yp_host = create_mpi_mirror(this->haloSendBuf_Yp);
+      this->haloRecvBuf_Yp_host = create_mpi_mirror(this->haloRecvBuf_Yp);
     }
 
     if (ndims == 2) {
 
       this->haloSendBuf_XYll = real1d("haloSendBuf_XYll", this->bufsize_xy);
       this->haloRecvBuf_XYll = real1d("haloRecvBuf_XYll", this->bufsize_xy);
-      this->haloSendBuf_XYll_host = this->haloSendBuf_XYll.createHostCopy();
-      this->haloRecvBuf_XYll_host = this->haloRecvBuf_XYll.createHostCopy();
+      this->haloSendBuf_XYll_host = create_mpi_mirror(this->haloSendBuf_XYll);
+      this->haloRecvBuf_XYll_host = create_mpi_mirror(this->haloRecvBuf_XYll);
 
       this->haloSendBuf_XYul = real1d("haloSendBuf_XYul", this->bufsize_xy);
       this->haloRecvBuf_XYul = real1d("haloRecvBuf_XYul", this->bufsize_xy);
-      this->haloSendBuf_XYul_host = this->haloSendBuf_XYul.createHostCopy();
-      this->haloRecvBuf_XYul_host = this->haloRecvBuf_XYul.createHostCopy();
+      this->haloSendBuf_XYul_host = create_mpi_mirror(this->haloSendBuf_XYul);
+      this->haloRecvBuf_XYul_host = create_mpi_mirror(this->haloRecvBuf_XYul);
 
       this->haloSendBuf_XYlr = real1d("haloSendBuf_XYlr", this->bufsize_xy);
       this->haloRecvBuf_XYlr = real1d("haloRecvBuf_XYlr", this->bufsize_xy);
-      this->haloSendBuf_XYlr_host = this->haloSendBuf_XYlr.createHostCopy();
-      this->haloRecvBuf_XYlr_host = this->haloRecvBuf_XYlr.createHostCopy();
+      this->haloSendBuf_XYlr_host = create_mpi_mirror(this->haloSendBuf_XYlr);
+      this->haloRecvBuf_XYlr_host = create_mpi_mirror(this->haloRecvBuf_XYlr);
 
       this->haloSendBuf_XYur = real1d("haloSendBuf_XYur", this->bufsize_xy);
       this->haloRecvBuf_XYur = real1d("haloRecvBuf_XYur", this->bufsize_xy);
-      this->haloSendBuf_XYur_host = this->haloSendBuf_XYur.createHostCopy();
-      this->haloRecvBuf_XYur_host = this->haloRecvBuf_XYur.createHostCopy();
+      this->haloSendBuf_XYur_host = create_mpi_mirror(this->haloSendBuf_XYur);
+      this->haloRecvBuf_XYur_host = create_mpi_mirror(this->haloRecvBuf_XYur);
     }
   }
 
@@ -339,39 +373,43 @@ void Exchange::unpack(real5d &data) {
 }
 
 void Exchange::exchange_x() {
+  this->num_reqs = 0;
+  post_x();
+  wait();
+  finish_x();
+}
+
+// Posts the x receives and sends, or swaps the x buffers locally if there is a
+// single process in x. Completed by wait() followed by finish_x()
+void Exchange::post_x() {
   int ierr;
 
   if (this->topology.nprocx > 1) {
     yakl::fence();
+    int r = this->num_reqs;
 
     // Pre-post the receives
     ierr =
         MPI_Irecv(haloRecvBuf_Xm_host.data(), this->bufsize_x, PAMC_MPI_REAL,
-                  this->topology.x_neigh(0), 0, MPI_COMM_WORLD, &this->rReq[0]);
-    ierr =
-        MPI_Irecv(haloRecvBuf_Xp_host.data(), this->bufsize_x, PAMC_MPI_REAL,
-                  this->topology.x_neigh(1), 1, MPI_COMM_WORLD, &this->rReq[1]);
+                  this->topology.x_neigh(0), 0, MPI_COMM_WORLD, &this->rReq[r]);
+    ierr = MPI_Irecv(haloRecvBuf_Xp_host.data(), this->bufsize_x,
+                     PAMC_MPI_REAL, this->topology.x_neigh(1), 1,
+                     MPI_COMM_WORLD, &this->rReq[r + 1]);
 
     // Copy send buffers to host
-    haloSendBuf_Xm.deep_copy_to(haloSendBuf_Xm_host);
-    haloSendBuf_Xp.deep_copy_to(haloSendBuf_Xp_host);
+    stage_to_mpi(haloSendBuf_Xm, haloSendBuf_Xm_host);
+    stage_to_mpi(haloSendBuf_Xp, haloSendBuf_Xp_host);
     yakl::fence();
 
     // Send the data
     ierr =
         MPI_Isend(haloSendBuf_Xm_host.data(), this->bufsize_x, PAMC_MPI_REAL,
-                  this->topology.x_neigh(0), 1, MPI_COMM_WORLD, &this->sReq[0]);
-    ierr =
-        MPI_Isend(haloSendBuf_Xp_host.data(), this->bufsize_x, PAMC_MPI_REAL,
-                  this->topology.x_neigh(1), 0, MPI_COMM_WORLD, &this->sReq[1]);
+                  this->topology.x_neigh(0), 1, MPI_COMM_WORLD, &this->sReq[r]);
+    ierr = MPI_Isend(haloSendBuf_Xp_host.data(), this->bufsize_x,
+                     PAMC_MPI_REAL, this->topology.x_neigh(1), 0,
+                     MPI_COMM_WORLD, &this->sReq[r + 1]);
 
-    // Wait for the sends and receives to finish
-    ierr = MPI_Waitall(2, this->sReq, this->sStat);
-    ierr = MPI_Waitall(2, this->rReq, this->rStat);
-
-    // Copy recv buffers to device
-    haloRecvBuf_Xm_host.deep_copy_to(haloRecvBuf_Xm);
-    haloRecvBuf_Xp_host.deep_copy_to(haloRecvBuf_Xp);
+    this->num_reqs += 2;
   }
 
   else {
@@ -390,6 +428,14 @@ void Exchange::exchange_x() {
   }
 }
 
+void Exchange::finish_x() {
+  if (this->topology.nprocx > 1) {
+    // Copy recv buffers to device
+    stage_from_mpi(haloRecvBuf_Xm_host, haloRecvBuf_Xm);
+    stage_from_mpi(haloRecvBuf_Xp_host, haloRecvBuf_Xp);
+  }
+}
+
 void Exchange::exchange_direct_x(real5d &data) {
   int is = this->topology.is;
   int js = this->topology.js;
@@ -439,40 +485,44 @@ void Exchange::exchange_direct(real5d &data) {
 }
 
 void Exchange::exchange_y() {
+  this->num_reqs = 0;
+  post_y();
+  wait();
+  finish_y();
+}
+
+// Posts the y receives and sends, or swaps the y buffers locally if there is a
+// single process in y. Completed by wait() followed by finish_y()
+void Exchange::post_y() {
   int ierr;
 
   if (this->topology.nprocy > 1) {
 
     yakl::fence();
+    int r = this->num_reqs;
 
     // Pre-post the receives
     ierr =
         MPI_Irecv(haloRecvBuf_Ym_host.data(), this->bufsize_y, PAMC_MPI_REAL,
-                  this->topology.y_neigh(0), 0, MPI_COMM_WORLD, &this->rReq[0]);
-    ierr =
-        MPI_Irecv(haloRecvBuf_Yp_host.data(), this->bufsize_y, PAMC_MPI_REAL,
-                  this->topology.y_neigh(1), 1, MPI_COMM_WORLD, &this->rReq[1]);
+                  this->topology.y_neigh(0), 2, MPI_COMM_WORLD, &this->rReq[r]);
+    ierr = MPI_Irecv(haloRecvBuf_Yp_host.data(), this->bufsize_y,
+                     PAMC_MPI_REAL, this->topology.y_neigh(1), 3,
+                     MPI_COMM_WORLD, &this->rReq[r + 1]);
 
     // Copy send buffers to host
-    haloSendBuf_Ym.deep_copy_to(haloSendBuf_Ym_host);
-    haloSendBuf_Yp.deep_copy_to(haloSendBuf_Yp_host);
+    stage_to_mpi(haloSendBuf_Ym, haloSendBuf_Ym_host);
+    stage_to_mpi(haloSendBuf_Yp, haloSendBuf_Yp_host);
     yakl::fence();
 
     // Send the data
     ierr =
         MPI_Isend(haloSendBuf_Ym_host.data(), this->bufsize_y, PAMC_MPI_REAL,
-                  this->topology.y_neigh(0), 1, MPI_COMM_WORLD, &this->sReq[0]);
-    ierr =
-        MPI_Isend(haloSendBuf_Yp_host.data(), this->bufsize_y, PAMC_MPI_REAL,
-                  this->topology.y_neigh(1), 0, MPI_COMM_WORLD, &this->sReq[1]);
+                  this->topology.y_neigh(0), 3, MPI_COMM_WORLD, &this->sReq[r]);
+    ierr = MPI_Isend(haloSendBuf_Yp_host.data(), this->bufsize_y,
+                     PAMC_MPI_REAL, this->topology.y_neigh(1), 2,
+                     MPI_COMM_WORLD, &this->sReq[r + 1]);
 
-    // Wait for the sends and receives to finish
-    ierr = MPI_Waitall(2, this->sReq, this->sStat);
-    ierr = MPI_Waitall(2, this->rReq, this->rStat);
-
-    // Copy recv buffers to device
-    haloRecvBuf_Ym_host.deep_copy_to(haloRecvBuf_Ym);
-    haloRecvBuf_Yp_host.deep_copy_to(haloRecvBuf_Yp);
+    this->num_reqs += 2;
   }
 
   else {
@@ -489,56 +539,66 @@ void Exchange::exchange_y() {
   }
 }
 
+void Exchange::finish_y() {
+  if (this->topology.nprocy > 1) {
+    // Copy recv buffers to device
+    stage_from_mpi(haloRecvBuf_Ym_host, haloRecvBuf_Ym);
+    stage_from_mpi(haloRecvBuf_Yp_host, haloRecvBuf_Yp);
+  }
+}
+
 void Exchange::exchange_corners() {
+  this->num_reqs = 0;
+  post_corners();
+  wait();
+  finish_corners();
+}
+
+// Posts the corner receives and sends, or swaps the corner buffers locally on a
+// single process. Completed by wait() followed by finish_corners()
+void Exchange::post_corners() {
   int ierr;
 
   if (this->topology.nprocx > 1 || this->topology.nprocy > 1) {
     yakl::fence();
+    int r = this->num_reqs;
 
     // Pre-post the receives
-    ierr =
-        MPI_Irecv(haloRecvBuf_XYll_host.data(), this->bufsize_xy, PAMC_MPI_REAL,
-                  this->topology.ur_neigh, 0, MPI_COMM_WORLD, &this->rReq[0]);
-    ierr =
-        MPI_Irecv(haloRecvBuf_XYur_host.data(), this->bufsize_xy, PAMC_MPI_REAL,
-                  this->topology.ll_neigh, 1, MPI_COMM_WORLD, &this->rReq[1]);
-    ierr =
-        MPI_Irecv(haloRecvBuf_XYul_host.data(), this->bufsize_xy, PAMC_MPI_REAL,
-                  this->topology.lr_neigh, 2, MPI_COMM_WORLD, &this->rReq[2]);
-    ierr =
-        MPI_Irecv(haloRecvBuf_XYlr_host.data(), this->bufsize_xy, PAMC_MPI_REAL,
-                  this->topology.ul_neigh, 3, MPI_COMM_WORLD, &this->rReq[3]);
+    ierr = MPI_Irecv(haloRecvBuf_XYll_host.data(), this->bufsize_xy,
+                     PAMC_MPI_REAL, this->topology.ur_neigh, 4,
+                     MPI_COMM_WORLD, &this->rReq[r]);
+    ierr = MPI_Irecv(haloRecvBuf_XYur_host.data(), this->bufsize_xy,
+                     PAMC_MPI_REAL, this->topology.ll_neigh, 5,
+                     MPI_COMM_WORLD, &this->rReq[r + 1]);
+    ierr = MPI_Irecv(haloRecvBuf_XYul_host.data(), this->bufsize_xy,
+                     PAMC_MPI_REAL, this->topology.lr_neigh, 6,
+                     MPI_COMM_WORLD, &this->rReq[r + 2]);
+    ierr = MPI_Irecv(haloRecvBuf_XYlr_host.data(), this->bufsize_xy,
+                     PAMC_MPI_REAL, this->topology.ul_neigh, 7,
+                     MPI_COMM_WORLD, &this->rReq[r + 3]);
 
     // Copy send buffers to host
-    haloSendBuf_XYll.deep_copy_to(haloSendBuf_XYll_host);
-    haloSendBuf_XYur.deep_copy_to(haloSendBuf_XYur_host);
-    haloSendBuf_XYul.deep_copy_to(haloSendBuf_XYul_host);
-    haloSendBuf_XYlr.deep_copy_to(haloSendBuf_XYlr_host);
+    stage_to_mpi(haloSendBuf_XYll, haloSendBuf_XYll_host);
+    stage_to_mpi(haloSendBuf_XYur, haloSendBuf_XYur_host);
+    stage_to_mpi(haloSendBuf_XYul, haloSendBuf_XYul_host);
+    stage_to_mpi(haloSendBuf_XYlr, haloSendBuf_XYlr_host);
     yakl::fence();
 
     // Send the data
-    ierr =
-        MPI_Isend(haloSendBuf_XYll_host.data(), this->bufsize_xy, PAMC_MPI_REAL,
-                  this->topology.ur_neigh, 1, MPI_COMM_WORLD, &this->sReq[0]);
-    ierr =
-        MPI_Isend(haloSendBuf_XYur_host.data(), this->bufsize_xy, PAMC_MPI_REAL,
-                  this->topology.ll_neigh, 0, MPI_COMM_WORLD, &this->sReq[1]);
-    ierr =
-        MPI_Isend(haloSendBuf_XYul_host.data(), this->bufsize_xy, PAMC_MPI_REAL,
-                  this->topology.lr_neigh, 3, MPI_COMM_WORLD, &this->sReq[2]);
-    ierr =
-        MPI_Isend(haloSendBuf_XYlr_host.data(), this->bufsize_xy, PAMC_MPI_REAL,
-                  this->topology.ul_neigh, 2, MPI_COMM_WORLD, &this->sReq[3]);
-
-    // Wait for the sends and receives to finish
-    ierr = MPI_Waitall(4, this->sReq, this->sStat);
-    ierr = MPI_Waitall(4, this->rReq, this->rStat);
-
-    // Copy recv buffers to device
-    haloRecvBuf_XYll_host.deep_copy_to(haloRecvBuf_XYll);
-    haloRecvBuf_XYur_host.deep_copy_to(haloRecvBuf_XYur);
-    haloRecvBuf_XYul_host.deep_copy_to(haloRecvBuf_XYul);
-    haloRecvBuf_XYlr_host.deep_copy_to(haloRecvBuf_XYlr);
+    ierr = MPI_Isend(haloSendBuf_XYll_host.data(), this->bufsize_xy,
+                     PAMC_MPI_REAL, this->topology.ur_neigh, 5,
+                     MPI_COMM_WORLD, &this->sReq[r]);
+    ierr = MPI_Isend(haloSendBuf_XYur_host.data(), this->bufsize_xy,
+                     PAMC_MPI_REAL, this->topology.ll_neigh, 4,
+                     MPI_COMM_WORLD, &this->sReq[r + 1]);
+    ierr = MPI_Isend(haloSendBuf_XYul_host.data(), this->bufsize_xy,
+                     PAMC_MPI_REAL, this->topology.lr_neigh, 7,
+                     MPI_COMM_WORLD, &this->sReq[r + 2]);
+    ierr = MPI_Isend(haloSendBuf_XYlr_host.data(), this->bufsize_xy,
+                     PAMC_MPI_REAL, this->topology.ul_neigh, 6,
+                     MPI_COMM_WORLD, &this->sReq[r + 3]);
+
+    this->num_reqs += 4;
   }
 
   else {
@@ -562,6 +622,16 @@ void Exchange::exchange_corners() {
   }
 }
 
+void Exchange::finish_corners() {
+  if (this->topology.nprocx > 1 || this->topology.nprocy > 1) {
+    // Copy recv buffers to device
+    stage_from_mpi(haloRecvBuf_XYll_host, haloRecvBuf_XYll);
+    stage_from_mpi(haloRecvBuf_XYur_host, haloRecvBuf_XYur);
+    stage_from_mpi(haloRecvBuf_XYul_host, haloRecvBuf_XYul);
+    stage_from_mpi(haloRecvBuf_XYlr_host, haloRecvBuf_XYlr);
+  }
+}
+
 void Exchange::exchange_mirror(real5d &data) {
   int is = this->topology.is;
   int js = this->topology.js;
@@ -603,29 +673,368 @@ void Exchange::exchange_mirror(real5d &data) {
   }
 }
 
-// EVENTUALLY WE SHOULD BE MORE CLEVER HERE IE GROUP ALL THE SEND/RECVS IN X/Y
-// TOGETHER, ETC.
+// Waits for all posted sends and receives to finish
+void Exchange::wait() {
+  int ierr;
+  ierr = MPI_Waitall(this->num_reqs, this->sReq, this->sStat);
+  ierr = MPI_Waitall(this->num_reqs, this->rReq, this->rStat);
+  this->num_reqs = 0;
+}
+
+// x, y and corners use distinct tags, so all of them are posted before waiting
 void Exchange::exchange() {
-  exchange_x();
+  this->num_reqs = 0;
+  post_x();
   if (ndims == 2) {
-    exchange_y();
+    post_y();
+    post_corners();
   }
+  wait();
+  finish_x();
   if (ndims == 2) {
-    exchange_corners();
+    finish_y();
+    finish_corners();
   }
 }
 
-void Exchange::exchange_data(real5d &data) {
+// Packs data and posts all of its halo messages without waiting for them.
+// Until exchange_end is called the interior of data may be read but not
+// written, and its halos may be neither read nor written
+void Exchange::exchange_begin(const real5d &data) {
+  if (this->in_flight) {
+    throw std::runtime_error("exchange_begin called on an exchange that is "
+                             "already in flight");
+  }
+  this->in_flight = true;
+  if (!this->single_process) {
+    this->pack(data);
+    this->num_reqs = 0;
+    post_x();
+    if (ndims == 2) {
+      post_y();
+      post_corners();
+    }
+  }
+}
+
+// Waits for the messages posted by exchange_begin and fills the halos of data
+void Exchange::exchange_end(real5d &data) {
+  if (!this->in_flight) {
+    throw std::runtime_error("exchange_end called without exchange_begin");
+  }
   if (this->single_process) {
     this->exchange_direct(data);
   } else {
-    this->pack(data);
-    this->exchange();
+    wait();
+    finish_x();
+    if (ndims == 2) {
+      finish_y();
+      finish_corners();
+    }
     this->unpack(data);
   }
 
 #ifdef PAMC_EXTRUDED
   exchange_mirror(data);
 #endif
+  this->in_flight = false;
+}
+
+void Exchange::exchange_data(real5d &data) {
+  yakl::timer_start("exchange");
+  exchange_begin(data);
+  exchange_end(data);
+  yakl::timer_stop("exchange");
+}
+
+// Exchanges the halos of several fields at once. The x halos of all fields
+// are packed into one buffer per x neighbour and exchanged in a single round,
+// then the same is done for the y halos. The y buffers span the x halos filled
+// by the x round, which also fills the corners, so no corner messages are
+// needed. Each field is described by its Exchange, which must share the
+// topology of the others. Buffers grow to fit the largest set of fields seen
+class AggregatedExchange {
+public:
+  int bufsize_x = 0;
+  int bufsize_y = 0;
+
+  realHost1d haloSendBuf_Xm_host;
+  realHost1d haloRecvBuf_Xm_host;
+  real1d haloSendBuf_Xm;
+  real1d haloRecvBuf_Xm;
+  realHost1d haloSendBuf_Xp_host;
+  realHost1d haloRecvBuf_Xp_host;
+  real1d haloSendBuf_Xp;
+  real1d haloRecvBuf_Xp;
+
+  realHost1d haloSendBuf_Ym_host;
+  realHost1d haloRecvBuf_Ym_host;
+  real1d haloSendBuf_Ym;
+  real1d haloRecvBuf_Ym;
+  realHost1d haloSendBuf_Yp_host;
+  realHost1d haloRecvBuf_Yp_host;
+  real1d haloSendBuf_Yp;
+  real1d haloRecvBuf_Yp;
+
+  MPI_Request sReq[2];
+  MPI_Request rReq[2];
+
+  MPI_Status sStat[2];
+  MPI_Status rStat[2];
+
+  void exchange_data(const std::vector<Exchange *> &exchs,
+                     const std::vector<real5d> &datas);
+  void exchange_x(const std::vector<Exchange *> &exchs,
+                  const std::vector<real5d> &datas);
+  void exchange_y(const std::vector<Exchange *> &exchs,
+                  const std::vector<real5d> &datas);
+  void exchange_buffers(real1d &sendbuf_m, realHost1d &sendbuf_m_host,
+                        real1d &sendbuf_p, realHost1d &sendbuf_p_host,
+                        real1d &recvbuf_m, realHost1d &recvbuf_m_host,
+                        real1d &recvbuf_p, realHost1d &recvbuf_p_host,
+                        int size, int neigh_m, int neigh_p);
+};
+
+void AggregatedExchange::exchange_data(const std::vector<Exchange *> &exchs,
+                                       const std::vector<real5d> &datas) {
+  yakl::timer_start("exchange_aggregated");
+  exchange_x(exchs, datas);
+  if (ndims == 2) {
+    exchange_y(exchs, datas);
+  }
+
+#ifdef PAMC_EXTRUDED
+  for (int f = 0; f < exchs.size(); f++) {
+    real5d data = datas[f];
+    exchs[f]->exchange_mirror(data);
+  }
+#endif
+  yakl::timer_stop("exchange_aggregated");
+}
+
+void AggregatedExchange::exchange_x(const std::vector<Exchange *> &exchs,
+                                    const std::vector<real5d> &datas) {
+  const Topology &topo = exchs[0]->topology;
+
+  if (topo.nprocx == 1) {
+    for (int f = 0; f < exchs.size(); f++) {
+      real5d data = datas[f];
+      exchs[f]->exchange_direct_x(data);
+    }
+    return;
+  }
+
+  int size = 0;
+  for (auto exch : exchs) {
+    size += topo.halosize_x * exch->total_dofs * topo.n_cells_y * exch->_nz *
+            exch->nens;
+  }
+  if (size > this->bufsize_x) {
+    this->bufsize_x = size;
+    this->haloSendBuf_Xm = real1d("aggHaloSendBuf_Xm", size);
+    this->haloRecvBuf_Xm = real1d("aggHaloRecvBuf_Xm", size);
+    this->haloSendBuf_Xp = real1d("aggHaloSendBuf_Xp", size);
+    this->haloRecvBuf_Xp = real1d("aggHaloRecvBuf_Xp", size);
+    this->haloSendBuf_Xm_host = create_mpi_mirror(this->haloSendBuf_Xm);
+    this->haloRecvBuf_Xm_host = create_mpi_mirror(this->haloRecvBuf_Xm);
+    this->haloSendBuf_Xp_host = create_mpi_mirror(this->haloSendBuf_Xp);
+    this->haloRecvBuf_Xp_host = create_mpi_mirror(this->haloRecvBuf_Xp);
+  }
+
+  int is = topo.is;
+  int js = topo.js;
+  int ks = topo.ks;
+
+  YAKL_SCOPE(n_cells_x, topo.n_cells_x);
+  YAKL_SCOPE(n_cells_y, topo.n_cells_y);
+  YAKL_SCOPE(halosize_x, topo.halosize_x);
+  YAKL_SCOPE(haloSendBuf_Xp, this->haloSendBuf_Xp);
+  YAKL_SCOPE(haloSendBuf_Xm, this->haloSendBuf_Xm);
+  YAKL_SCOPE(haloRecvBuf_Xp, this->haloRecvBuf_Xp);
+  YAKL_SCOPE(haloRecvBuf_Xm, this->haloRecvBuf_Xm);
+
+  // pack left (x-) and right (x+) of every field, one after another
+  int offset = 0;
+  for (int f = 0; f < exchs.size(); f++) {
+    const auto &data = datas[f];
+    int _nz = exchs[f]->_nz;
+    int nens = exchs[f]->nens;
+    parallel_for(
+        "aggregated pack x",
+        SimpleBounds<5>(exchs[f]->total_dofs, halosize_x, _nz, n_cells_y,
+                        nens),
+        YAKL_LAMBDA(int ndof, int ii, int k, int j, int n) {
+          int iGlob = offset + n +
+                      nens * (j + n_cells_y *
+                                      (k + _nz * (ii + halosize_x * ndof)));
+          haloSendBuf_Xp(iGlob) =
+              data(ndof, k + ks, j + js, ii + is + n_cells_x - halosize_x, n);
+          haloSendBuf_Xm(iGlob) = data(ndof, k + ks, j + js, ii + is, n);
+        });
+    offset += exchs[f]->total_dofs * halosize_x * _nz * n_cells_y * nens;
+  }
+
+  exchange_buffers(this->haloSendBuf_Xm, this->haloSendBuf_Xm_host,
+                   this->haloSendBuf_Xp, this->haloSendBuf_Xp_host,
+                   this->haloRecvBuf_Xm, this->haloRecvBuf_Xm_host,
+                   this->haloRecvBuf_Xp, this->haloRecvBuf_Xp_host, size,
+                   topo.x_neigh(0), topo.x_neigh(1));
+
+  // unpack left (x-) and right (x+) of every field
+  offset = 0;
+  for (int f = 0; f < exchs.size(); f++) {
+    const auto &data = datas[f];
+    int _nz = exchs[f]->_nz;
+    int nens = exchs[f]->nens;
+    parallel_for(
+        "aggregated unpack x",
+        SimpleBounds<5>(exchs[f]->total_dofs, halosize_x, _nz, n_cells_y,
+                        nens),
+        YAKL_LAMBDA(int ndof, int ii, int k, int j, int n) {
+          int iGlob = offset + n +
+                      nens * (j + n_cells_y *
+                                      (k + _nz * (ii + halosize_x * ndof)));
+          data(ndof, k + ks, j + js, ii + is - halosize_x, n) =
+              haloRecvBuf_Xm(iGlob);
+          data(ndof, k + ks, j + js, ii + is + n_cells_x, n) =
+              haloRecvBuf_Xp(iGlob);
+        });
+    offset += exchs[f]->total_dofs * halosize_x * _nz * n_cells_y * nens;
+  }
+}
+
+void AggregatedExchange::exchange_y(const std::vector<Exchange *> &exchs,
+                                    const std::vector<real5d> &datas) {
+  const Topology &topo = exchs[0]->topology;
+
+  if (topo.nprocy == 1) {
+    for (int f = 0; f < exchs.size(); f++) {
+      real5d data = datas[f];
+      exchs[f]->exchange_direct_y(data);
+    }
+    return;
+  }
+
+  // the y buffers include the x halos, which carries the corners along
+  int n_cells_x_halo = topo.n_cells_x + 2 * topo.halosize_x;
+
+  int size = 0;
+  for (auto exch : exchs) {
+    size += topo.halosize_y * exch->total_dofs * n_cells_x_halo * exch->_nz *
+            exch->nens;
+  }
+  if (size > this->bufsize_y) {
+    this->bufsize_y = size;
+    this->haloSendBuf_Ym = real1d("aggHaloSendBuf_Ym", size);
+    this->haloRecvBuf_Ym = real1d("aggHaloRecvBuf_Ym", size);
+    this->haloSendBuf_Yp = real1d("aggHaloSendBuf_Yp", size);
+    this->haloRecvBuf_Yp = real1d("aggHaloRecvBuf_Yp", size);
+    this->haloSendBuf_Ym_host = create_mpi_mirror(this->haloSendBuf_Ym);
+    this->haloRecvBuf_Ym_host = create_mpi_mirror(this->haloRecvBuf_Ym);
+    this->haloSendBuf_Yp_host = create_mpi_mirror(this->haloSendBuf_Yp);
+    this->haloRecvBuf_Yp_host = create_mpi_mirror(this->haloRecvBuf_Yp);
+  }
+
+  int is = topo.is;
+  int js = topo.js;
+  int ks = topo.ks;
+
+  YAKL_SCOPE(n_cells_y, topo.n_cells_y);
+  YAKL_SCOPE(halosize_x, topo.halosize_x);
+  YAKL_SCOPE(halosize_y, topo.halosize_y);
+  YAKL_SCOPE(haloSendBuf_Yp, this->haloSendBuf_Yp);
+  YAKL_SCOPE(haloSendBuf_Ym, this->haloSendBuf_Ym);
+  YAKL_SCOPE(haloRecvBuf_Yp, this->haloRecvBuf_Yp);
+  YAKL_SCOPE(haloRecvBuf_Ym, this->haloRecvBuf_Ym);
+
+  // pack down (y-) and up (y+) of every field, one after another
+  int offset = 0;
+  for (int f = 0; f < exchs.size(); f++) {
+    const auto &data = datas[f];
+    int _nz = exchs[f]->_nz;
+    int nens = exchs[f]->nens;
+    parallel_for(
+        "aggregated pack y",
+        SimpleBounds<5>(exchs[f]->total_dofs, halosize_y, _nz, n_cells_x_halo,
+                        nens),
+        YAKL_LAMBDA(int ndof, int jj, int k, int i, int n) {
+          int iGlob = offset + n +
+                      nens * (i + n_cells_x_halo *
+                                      (k + _nz * (jj + halosize_y * ndof)));
+          haloSendBuf_Yp(iGlob) = data(ndof, k + ks,
+                                       jj + js + n_cells_y - halosize_y,
+                                       i + is - halosize_x, n);
+          haloSendBuf_Ym(iGlob) =
+              data(ndof, k + ks, jj + js, i + is - halosize_x, n);
+        });
+    offset += exchs[f]->total_dofs * halosize_y * _nz * n_cells_x_halo * nens;
+  }
+
+  exchange_buffers(this->haloSendBuf_Ym, this->haloSendBuf_Ym_host,
+                   this->haloSendBuf_Yp, this->haloSendBuf_Yp_host,
+                   this->haloRecvBuf_Ym, this->haloRecvBuf_Ym_host,
+                   this->haloRecvBuf_Yp, this->haloRecvBuf_Yp_host, size,
+                   topo.y_neigh(0), topo.y_neigh(1));
+
+  // unpack down (y-) and up (y+) of every field
+  offset = 0;
+  for (int f = 0; f < exchs.size(); f++) {
+    const auto &data = datas[f];
+    int _nz = exchs[f]->_nz;
+    int nens = exchs[f]->nens;
+    parallel_for(
+        "aggregated unpack y",
+        SimpleBounds<5>(exchs[f]->total_dofs, halosize_y, _nz, n_cells_x_halo,
+                        nens),
+        YAKL_LAMBDA(int ndof, int jj, int k, int i, int n) {
+          int iGlob = offset + n +
+                      nens * (i + n_cells_x_halo *
+                                      (k + _nz * (jj + halosize_y * ndof)));
+          data(ndof, k + ks, jj + js - halosize_y, i + is - halosize_x, n) =
+              haloRecvBuf_Ym(iGlob);
+          data(ndof, k + ks, jj + js + n_cells_y, i + is - halosize_x, n) =
+              haloRecvBuf_Yp(iGlob);
+        });
+    offset += exchs[f]->total_dofs * halosize_y * _nz * n_cells_x_halo * nens;
+  }
+}
+
+// Exchanges the first size entries of a pair of send buffers with the
+// neighbours in one direction. The m send buffer goes to neigh_m, whose p send
+// buffer arrives in the m receive buffer, and vice versa. The tags differ from
+// those of Exchange so that split-phase exchanges may be in flight meanwhile
+void AggregatedExchange::exchange_buffers(
+    real1d &sendbuf_m, realHost1d &sendbuf_m_host, real1d &sendbuf_p,
+    realHost1d &sendbuf_p_host, real1d &recvbuf_m, realHost1d &recvbuf_m_host,
+    real1d &recvbuf_p, realHost1d &recvbuf_p_host, int size, int neigh_m,
+    int neigh_p) {
+  int ierr;
+
+  yakl::fence();
+
+  // Pre-post the receives
+  ierr = MPI_Irecv(recvbuf_m_host.data(), size, PAMC_MPI_REAL, neigh_m, 8,
+                   MPI_COMM_WORLD, &this->rReq[0]);
+  ierr = MPI_Irecv(recvbuf_p_host.data(), size, PAMC_MPI_REAL, neigh_p, 9,
+                   MPI_COMM_WORLD, &this->rReq[1]);
+
+  // Copy send buffers to host
+  stage_to_mpi(sendbuf_m, sendbuf_m_host);
+  stage_to_mpi(sendbuf_p, sendbuf_p_host);
+  yakl::fence();
+
+  // Send the data
+  ierr = MPI_Isend(sendbuf_m_host.data(), size, PAMC_MPI_REAL, neigh_m, 9,
+                   MPI_COMM_WORLD, &this->sReq[0]);
+  ierr = MPI_Isend(sendbuf_p_host.data(), size, PAMC_MPI_REAL, neigh_p, 8,
+                   MPI_COMM_WORLD, &this->sReq[1]);
+
+  // Wait for the sends and receives to finish
+  ierr = MPI_Waitall(2, this->sReq, this->sStat);
+  ierr = MPI_Waitall(2, this->rReq, this->rStat);
+
+  // Copy recv buffers to device
+  stage_from_mpi(recvbuf_m_host, recvbuf_m);
+  stage_from_mpi(recvbuf_p_host, recvbuf_p);
 }
 } // namespace pamc
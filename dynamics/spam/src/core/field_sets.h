@@ -4,6 +4,7 @@
 #include "exchange.h"
 #include "fields.h"
 #include "topology.h"
+#include <algorithm>
 #include <initializer_list>
 
 namespace pamc {
@@ -22,12 +23,67 @@ public:
   void printinfo();
 };
 
+// Flattened index table over the interior of all fields of a FieldSet, used to
+// operate on every field in a single kernel launch. The (ndof, k) pairs of all
+// fields are numbered consecutively as rows, and each row spans the same
+// horizontal interior and ensemble range
+template <uint num_fields> struct FieldSetLayout {
+  SArray<int, 1, num_fields + 1> row_offsets;
+  SArray<int, 1, num_fields> nz;      // interior levels of each field
+  SArray<int, 1, num_fields> nz_halo; // levels of each field including halos
+  int nrows;
+  int is, js, ks;
+  int n_cells_x, n_cells_y, nens;
+  int nx_halo, ny_halo;
+
+  void initialize(const std::array<Field, num_fields> &fields) {
+    const auto &topo = fields[0].topology;
+    is = topo.is;
+    js = topo.js;
+    ks = topo.ks;
+    n_cells_x = topo.n_cells_x;
+    n_cells_y = topo.n_cells_y;
+    nens = topo.nens;
+    nx_halo = topo.n_cells_x + 2 * topo.halosize_x;
+    ny_halo = topo.n_cells_y + 2 * topo.halosize_y;
+    row_offsets(0) = 0;
+    for (int f = 0; f < num_fields; f++) {
+      nz(f) = fields[f]._nz;
+      nz_halo(f) = fields[f]._nz + 2 * fields[f].topology.mirror_halo;
+      row_offsets(f + 1) = row_offsets(f) + fields[f].total_dofs * nz(f);
+    }
+    nrows = row_offsets(num_fields);
+  }
+
+  // finds the field f of an interior point and its linear index in f's data
+  YAKL_INLINE void locate(int row, int j, int i, int n, int &f,
+                          int &idx) const {
+    f = 0;
+    while (row >= row_offsets(f + 1)) {
+      f++;
+    }
+    int r = row - row_offsets(f);
+    int ndof = r / nz(f);
+    int k = r - ndof * nz(f);
+    idx = n + nens * (i + is +
+                      nx_halo * (j + js +
+                                 ny_halo * (k + ks + nz_halo(f) * ndof)));
+  }
+};
+
 template <uint num_fields> class FieldSet {
 
 public:
   std::array<Field, num_fields> fields_arr;
   std::string baseName;
   bool is_initialized;
+  // exchange all requested fields with one message per neighbour instead of
+  // one per field and direction
+  bool aggregate_exchanges = true;
+  AggregatedExchange aggregated_exchange;
+  FieldSetLayout<num_fields> layout;
+  // per-thread partial norms, kept between calls (see reduce_norm)
+  mutable real1d norm_partials;
 
   FieldSet();
   // FieldSet( const FieldSet<num_fields> &vs) = delete;
@@ -46,8 +102,24 @@ public:
   void waxpbypcz(real alpha, real beta, real gamma,
                  const FieldSet<num_fields> &x, const FieldSet<num_fields> &y,
                  const FieldSet<num_fields> &z);
+  real local_norm(NORM_TYPE type,
+                  const SArray<real, 1, num_fields> &weights) const;
+  real waxpbypcz_local_norm(real alpha, real beta, real gamma,
+                            const FieldSet<num_fields> &x,
+                            const FieldSet<num_fields> &y,
+                            const FieldSet<num_fields> &z, NORM_TYPE type,
+                            const SArray<real, 1, num_fields> &weights);
+  SArray<real *, 1, num_fields> data_ptrs() const;
+  template <class F> real reduce_norm(bool is_max, const F &contrib) const;
   void exchange();
   void exchange(const std::initializer_list<int> &indices);
+  void exchange_begin(const std::initializer_list<int> &indices);
+  void exchange_end(const std::initializer_list<int> &indices);
+  void add_to_exchange(const std::initializer_list<int> &indices,
+                       std::vector<Exchange *> &exchs,
+                       std::vector<real5d> &datas);
+  void add_to_exchange(std::vector<Exchange *> &exchs,
+                       std::vector<real5d> &datas);
 };
 
 template <uint num_fields> ExchangeSet<num_fields>::ExchangeSet() {
@@ -110,6 +182,7 @@ void FieldSet<num_fields>::initialize(
         desc_arr[i].topology, &exchange_set.exchanges_arr[i], desc_arr[i].name,
         desc_arr[i].basedof, desc_arr[i].extdof, desc_arr[i].ndofs);
   }
+  this->layout.initialize(this->fields_arr);
   this->is_initialized = true;
 }
 
@@ -123,32 +196,74 @@ void FieldSet<num_fields>::initialize(
   for (int i = 0; i < num_fields; i++) {
     this->fields_arr[i].initialize(vs.fields_arr[i], vs.fields_arr[i].name);
   }
+  this->layout.initialize(this->fields_arr);
   this->is_initialized = true;
 }
 
+// pointers to the data of all fields, for use in the fused kernels below
+template <uint num_fields>
+SArray<real *, 1, num_fields> FieldSet<num_fields>::data_ptrs() const {
+  SArray<real *, 1, num_fields> ptrs;
+  for (int f = 0; f < num_fields; f++) {
+    ptrs(f) = this->fields_arr[f].data.data();
+  }
+  return ptrs;
+}
+
+// The vector operations below work on the interior of all fields in a single
+// kernel launch. All field sets involved must have the same layout
+
 // copies data from vs into self
 template <uint num_fields>
 void FieldSet<num_fields>::copy(const FieldSet<num_fields> &vs) {
-  for (int i = 0; i < num_fields; i++) {
-    this->fields_arr[i].copy(vs.fields_arr[i]);
-  }
+  YAKL_SCOPE(layout, this->layout);
+  auto w = this->data_ptrs();
+  auto v = vs.data_ptrs();
+  parallel_for(
+      "FieldSet copy",
+      SimpleBounds<4>(layout.nrows, layout.n_cells_y, layout.n_cells_x,
+                      layout.nens),
+      YAKL_LAMBDA(int row, int j, int i, int n) {
+        int f, idx;
+        layout.locate(row, j, i, n, f, idx);
+        w(f)[idx] = v(f)[idx];
+      });
 }
 
 // Computes w (self) = alpha x
 template <uint num_fields>
 void FieldSet<num_fields>::wscal(real alpha, const FieldSet<num_fields> &x) {
-  for (int i = 0; i < num_fields; i++) {
-    this->fields_arr[i].wscal(alpha, x.fields_arr[i]);
-  }
+  YAKL_SCOPE(layout, this->layout);
+  auto w = this->data_ptrs();
+  auto xp = x.data_ptrs();
+  parallel_for(
+      "FieldSet wscal",
+      SimpleBounds<4>(layout.nrows, layout.n_cells_y, layout.n_cells_x,
+                      layout.nens),
+      YAKL_LAMBDA(int row, int j, int i, int n) {
+        int f, idx;
+        layout.locate(row, j, i, n, f, idx);
+        w(f)[idx] = alpha * xp(f)[idx];
+      });
 }
 
 // Computes w (self) = alpha x + y
 template <uint num_fields>
 void FieldSet<num_fields>::waxpy(real alpha, const FieldSet<num_fields> &x,
                                  const FieldSet<num_fields> &y) {
-  for (int i = 0; i < num_fields; i++) {
-    this->fields_arr[i].waxpy(alpha, x.fields_arr[i], y.fields_arr[i]);
-  }
+  YAKL_SCOPE(layout, this->layout);
+  auto w = this->data_ptrs();
+  auto xp = x.data_ptrs();
+  auto yp = y.data_ptrs();
+  parallel_for(
+      "FieldSet waxpy",
+      SimpleBounds<4>(layout.nrows, layout.n_cells_y, layout.n_cells_x,
+                      layout.nens),
+      YAKL_LAMBDA(int row, int j, int i, int n) {
+        int f, idx;
+        layout.locate(row, j, i, n, f, idx);
+        w(f)[idx] = alpha * xp(f)[idx] + yp(f)[idx];
+      });
 }
 
 // Computes w (self) = alpha x + beta y
@@ -156,9 +271,19 @@ template <uint num_fields>
 void FieldSet<num_fields>::waxpby(real alpha, real beta,
                                   const FieldSet<num_fields> &x,
                                   const FieldSet<num_fields> &y) {
-  for (int i = 0; i < num_fields; i++) {
-    this->fields_arr[i].waxpby(alpha, beta, x.fields_arr[i], y.fields_arr[i]);
-  }
+  YAKL_SCOPE(layout, this->layout);
+  auto w = this->data_ptrs();
+  auto xp = x.data_ptrs();
+  auto yp = y.data_ptrs();
+  parallel_for(
+      "FieldSet waxpby",
+      SimpleBounds<4>(layout.nrows, layout.n_cells_y, layout.n_cells_x,
+                      layout.nens),
+      YAKL_LAMBDA(int row, int j, int i, int n) {
+        int f, idx;
+        layout.locate(row, j, i, n, f, idx);
+        w(f)[idx] = alpha * xp(f)[idx] + beta * yp(f)[idx];
+      });
 }
 
 // Computes w (self) = alpha x + beta * y + gamma * z
@@ -167,23 +292,186 @@ void FieldSet<num_fields>::waxpbypcz(real alpha, real beta, real gamma,
                                      const FieldSet<num_fields> &x,
                                      const FieldSet<num_fields> &y,
                                      const FieldSet<num_fields> &z) {
-  for (int i = 0; i < num_fields; i++) {
-    this->fields_arr[i].waxpbypcz(alpha, beta, gamma, x.fields_arr[i],
-                                  y.fields_arr[i], z.fields_arr[i]);
+  YAKL_SCOPE(layout, this->layout);
+  auto w = this->data_ptrs();
+  auto xp = x.data_ptrs();
+  auto yp = y.data_ptrs();
+  auto zp = z.data_ptrs();
+  parallel_for(
+      "FieldSet waxpbypcz",
+      SimpleBounds<4>(layout.nrows, layout.n_cells_y, layout.n_cells_x,
+                      layout.nens),
+      YAKL_LAMBDA(int row, int j, int i, int n) {
+        int f, idx;
+        layout.locate(row, j, i, n, f, idx);
+        w(f)[idx] = alpha * xp(f)[idx] + beta * yp(f)[idx] + gamma * zp(f)[idx];
+      });
+}
+
+// Reduces contrib(row, j, i, n) over the interior of all fields, taking the
+// maximum if is_max and the sum otherwise. Each of a fixed number of threads
+// accumulates a strided subset of the points in a fixed order into
+// norm_partials, and the partials are then reduced with a YAKL intrinsic. This
+// avoids contended atomics on a single value and gives the same result on
+// every run
+template <uint num_fields>
+template <class F>
+real FieldSet<num_fields>::reduce_norm(bool is_max, const F &contrib) const {
+  YAKL_SCOPE(layout, this->layout);
+  const int nrows = layout.nrows;
+  const int ny = layout.n_cells_y;
+  const int nx = layout.n_cells_x;
+  const int nens = layout.nens;
+  const size_t npts = static_cast<size_t>(nrows) * ny * nx * nens;
+  const int nparts = static_cast<int>(std::min(npts, size_t{65536}));
+  if (!norm_partials.initialized() || norm_partials.extent(0) != nparts) {
+    norm_partials = real1d("norm partials", nparts);
   }
+  YAKL_SCOPE(norm_partials, this->norm_partials);
+  parallel_for(
+      "FieldSet norm partials", SimpleBounds<1>(nparts), YAKL_LAMBDA(int t) {
+        real acc = 0;
+        // adjacent threads visit adjacent points, so reads stay coalesced
+        for (size_t p = t; p < npts; p += nparts) {
+          const int n = p % nens;
+          const int i = (p / nens) % nx;
+          const int j = (p / nens / nx) % ny;
+          const int row = p / nens / nx / ny;
+          const real c = contrib(row, j, i, n);
+          acc = is_max ? (c > acc ? c : acc) : acc + c;
+        }
+        norm_partials(t) = acc;
+      });
+  return is_max ? yakl::intrinsics::maxval(norm_partials)
+                : yakl::intrinsics::sum(norm_partials);
+}
+
+// Returns the local part of a norm over the interior of all fields on this
+// process: the maximum absolute value for NORM_TYPE::MAX and the sum of squares
+// scaled by the weight of each field otherwise. Halos are not included, so the
+// partial norms of all processes can be combined into a global one
+template <uint num_fields>
+real FieldSet<num_fields>::local_norm(
+    NORM_TYPE type, const SArray<real, 1, num_fields> &weights) const {
+  YAKL_SCOPE(layout, this->layout);
+  auto xp = this->data_ptrs();
+  bool is_max = type == NORM_TYPE::MAX;
+  return reduce_norm(is_max, YAKL_LAMBDA(int row, int j, int i, int n) {
+    int f, idx;
+    layout.locate(row, j, i, n, f, idx);
+    real val = xp(f)[idx];
+    return is_max ? fabs(val) : weights(f) * val * val;
+  });
+}
+
+// Computes w (self) = alpha x + beta * y + gamma * z and returns the local part
+// of the norm of w (see local_norm) computed in the same kernel. This is the
+// residual update and norm of the Newton iteration
+template <uint num_fields>
+real FieldSet<num_fields>::waxpbypcz_local_norm(
+    real alpha, real beta, real gamma, const FieldSet<num_fields> &x,
+    const FieldSet<num_fields> &y, const FieldSet<num_fields> &z,
+    NORM_TYPE type, const SArray<real, 1, num_fields> &weights) {
+  YAKL_SCOPE(layout, this->layout);
+  auto w = this->data_ptrs();
+  auto xp = x.data_ptrs();
+  auto yp = y.data_ptrs();
+  auto zp = z.data_ptrs();
+  bool is_max = type == NORM_TYPE::MAX;
+  return reduce_norm(is_max, YAKL_LAMBDA(int row, int j, int i, int n) {
+    int f, idx;
+    layout.locate(row, j, i, n, f, idx);
+    real val = alpha * xp(f)[idx] + beta * yp(f)[idx] + gamma * zp(f)[idx];
+    w(f)[idx] = val;
+    return is_max ? fabs(val) : weights(f) * val * val;
+  });
 }
 
 template <uint num_fields> void FieldSet<num_fields>::exchange() {
-  for (auto &f : fields_arr) {
-    f.exchange();
+  if (aggregate_exchanges && !fields_arr[0].m_exchange->single_process) {
+    std::vector<Exchange *> exchs;
+    std::vector<real5d> datas;
+    add_to_exchange(exchs, datas);
+    aggregated_exchange.exchange_data(exchs, datas);
+  } else {
+    for (auto &f : fields_arr) {
+      f.exchange();
+    }
   }
 }
 
-// EVENTUALLY THIS SHOULD BE MORE CLEVER IE PACK ALL THE FIELDS AT ONCE, ETC.
 template <uint num_fields>
 void FieldSet<num_fields>::exchange(const std::initializer_list<int> &indices) {
+  if (aggregate_exchanges && !fields_arr[0].m_exchange->single_process) {
+    std::vector<Exchange *> exchs;
+    std::vector<real5d> datas;
+    add_to_exchange(indices, exchs, datas);
+    aggregated_exchange.exchange_data(exchs, datas);
+  } else {
+    for (int i : indices) {
+      fields_arr[i].exchange();
+    }
+  }
+}
+
+// Split-phase exchange: posts the halo messages of the listed fields and
+// returns without waiting, so that work not touching their halos can overlap
+// the communication. Each field sends its own messages, since the corner
+// folding of the aggregated exchange needs the x round done before the y round
+template <uint num_fields>
+void FieldSet<num_fields>::exchange_begin(
+    const std::initializer_list<int> &indices) {
+  for (int i : indices) {
+    fields_arr[i].exchange_begin();
+  }
+}
+
+// completes an exchange_begin with the same indices
+template <uint num_fields>
+void FieldSet<num_fields>::exchange_end(
+    const std::initializer_list<int> &indices) {
+  yakl::timer_start("exchange_end");
   for (int i : indices) {
-    fields_arr[i].exchange();
+    fields_arr[i].exchange_end();
+  }
+  yakl::timer_stop("exchange_end");
+}
+
+// appends the listed fields to an aggregated exchange being assembled
+template <uint num_fields>
+void FieldSet<num_fields>::add_to_exchange(
+    const std::initializer_list<int> &indices, std::vector<Exchange *> &exchs,
+    std::vector<real5d> &datas) {
+  for (int i : indices) {
+    exchs.push_back(fields_arr[i].m_exchange);
+    datas.push_back(fields_arr[i].data);
+  }
+}
+
+// appends all fields to an aggregated exchange being assembled
+template <uint num_fields>
+void FieldSet<num_fields>::add_to_exchange(std::vector<Exchange *> &exchs,
+                                           std::vector<real5d> &datas) {
+  for (auto &f : fields_arr) {
+    exchs.push_back(f.m_exchange);
+    datas.push_back(f.data);
+  }
+}
+
+// exchanges all fields of several field sets together, with one message per
+// neighbour, using the buffers of the first set
+template <uint num_fields, class... Sets>
+void exchange_aggregated(FieldSet<num_fields> &set, Sets &...sets) {
+  if (!set.aggregate_exchanges ||
+      set.fields_arr[0].m_exchange->single_process) {
+    set.exchange();
+    (sets.exchange(), ...);
+    return;
   }
+  std::vector<Exchange *> exchs;
+  std::vector<real5d> datas;
+  set.add_to_exchange(exchs, datas);
+  (sets.add_to_exchange(exchs, datas), ...);
+  set.aggregated_exchange.exchange_data(exchs, datas);
 }
 } // namespace pamc
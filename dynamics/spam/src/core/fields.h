@@ -50,6 +50,8 @@ public:
   void set_bnd(real val);
   void set_bnd(int ndof, real val);
   void exchange();
+  void exchange_begin();
+  void exchange_end();
   // real sum();
   // real min();
   // real max();
@@ -322,4 +324,6 @@ void Field::waxpbypcz(real alpha, real beta, real gamma, const Field &x,
 }
 
 void Field::exchange() { m_exchange->exchange_data(data); }
+void Field::exchange_begin() { m_exchange->exchange_begin(data); }
+void Field::exchange_end() { m_exchange->exchange_end(data); }
 } // namespace pamc
@@ -27,7 +27,11 @@ public:
   int si_verbosity_level;
   int si_max_iters;
   int si_nquad;
+  // norm used to monitor convergence: max, l2 or weighted_l2
+  std::string si_norm_type = "max";
   bool si_two_point_discrete_gradient;
+  // vertical tridiagonal solver of the extruded model: thomas, pcr or auto
+  std::string tridiag_method = "auto";
 
   real tanh_upwind_coeff = -1;
 
@@ -36,6 +40,8 @@ public:
 
   int masterproc;
   bool inner_mpi;
+  // write output from a background thread while the model keeps stepping
+  bool async_output = false;
 
   bool couple_wind = true;
   // solve a system to exactly invert the velocity averaging done
@@ -68,10 +74,13 @@ void readParamsFile(std::string inFile, Parameters &params, Parallel &par,
   params.si_max_iters = config["si_max_iters"].as<int>(
       params.si_monitor_convergence > 1 ? 50 : 5);
   params.si_nquad = config["si_nquad"].as<int>(4);
+  params.si_norm_type = config["si_norm_type"].as<std::string>("max");
   params.si_two_point_discrete_gradient =
       config["si_two_point_discrete_gradient"].as<bool>(false);
+  params.tridiag_method = config["tridiag_method"].as<std::string>("auto");
   params.tanh_upwind_coeff = config["tanh_upwind_coeff"].as<real>(250);
   params.outputName = config["dycore_out_prefix"].as<std::string>("output");
+  params.async_output = config["async_output"].as<bool>(false);
   params.nz_dual = nz;
 
   params.couple_wind = config["couple_wind"].as<bool>(true);
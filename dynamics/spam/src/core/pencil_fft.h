@@ -0,0 +1,367 @@
+#pragma once
+
+#include "common.h"
+#include "exchange.h"
+#include "topology.h"
+#include <memory>
+
+namespace pamc {
+
+// Range of the block of n indices owned by process p out of nproc, split the
+// same way as the horizontal domain in finalize_parallel
+void block_range(int n, int nproc, int p, int &beg, int &len) {
+  double nper = ((double)n) / nproc;
+  beg = (int)round(nper * p);
+  len = (int)round(nper * (p + 1)) - beg;
+}
+
+// All-to-all redistribution of a 4d array among the members of a
+// communicator. The source array is split along send_dim into one block per
+// member, and the blocks received from all members are gathered along recv_dim
+// of the destination array. All other dimensions are the same on both sides
+class PencilTranspose {
+public:
+  MPI_Comm comm;
+  int nmembers;
+  int send_dim, recv_dim;
+  std::array<int, 4> src_dims, dst_dims;
+  std::vector<int> send_beg, recv_beg;
+  std::vector<int> send_counts, send_displs, recv_counts, recv_displs;
+
+  int1d send_beg_d, send_displs_d, recv_beg_d, recv_displs_d;
+  real1d send_buf, recv_buf;
+  realHost1d send_buf_host, recv_buf_host;
+
+  // send_beg and recv_beg hold nmembers + 1 entries, the block of member p
+  // spans [beg[p], beg[p + 1])
+  void initialize(MPI_Comm comm, const std::array<int, 4> &src_dims,
+                  int send_dim, const std::vector<int> &send_beg,
+                  int recv_dim, const std::vector<int> &recv_beg) {
+    this->comm = comm;
+    this->nmembers = send_beg.size() - 1;
+    this->send_dim = send_dim;
+    this->recv_dim = recv_dim;
+    this->send_beg = send_beg;
+    this->recv_beg = recv_beg;
+
+    int myrank;
+    MPI_Comm_rank(comm, &myrank);
+
+    this->src_dims = src_dims;
+    this->dst_dims = src_dims;
+    this->dst_dims[send_dim] = send_beg[myrank + 1] - send_beg[myrank];
+    this->dst_dims[recv_dim] = recv_beg[nmembers];
+
+    send_counts.resize(nmembers);
+    send_displs.resize(nmembers + 1);
+    recv_counts.resize(nmembers);
+    recv_displs.resize(nmembers + 1);
+    send_displs[0] = 0;
+    recv_displs[0] = 0;
+    for (int p = 0; p < nmembers; p++) {
+      send_counts[p] = block_size(src_dims, send_dim, send_beg, p);
+      recv_counts[p] = block_size(dst_dims, recv_dim, recv_beg, p);
+      send_displs[p + 1] = send_displs[p] + send_counts[p];
+      recv_displs[p + 1] = recv_displs[p] + recv_counts[p];
+    }
+
+    send_beg_d = to_device(send_beg, "pencil send beg");
+    send_displs_d = to_device(send_displs, "pencil send displs");
+    recv_beg_d = to_device(recv_beg, "pencil recv beg");
+    recv_displs_d = to_device(recv_displs, "pencil recv displs");
+
+    send_buf = real1d("pencil send buf", std::max(send_displs[nmembers], 1));
+    recv_buf = real1d("pencil recv buf", std::max(recv_displs[nmembers], 1));
+    send_buf_host = create_mpi_mirror(send_buf);
+    recv_buf_host = create_mpi_mirror(recv_buf);
+  }
+
+  // the transpose that undoes fwd
+  void initialize_inverse(const PencilTranspose &fwd) {
+    std::array<int, 4> dims = fwd.src_dims;
+    int myrank;
+    MPI_Comm_rank(fwd.comm, &myrank);
+    dims[fwd.send_dim] = fwd.send_beg[myrank + 1] - fwd.send_beg[myrank];
+    dims[fwd.recv_dim] = fwd.recv_beg[fwd.nmembers];
+    initialize(fwd.comm, dims, fwd.recv_dim, fwd.recv_beg, fwd.send_dim,
+               fwd.send_beg);
+  }
+
+  // src and dst may be larger than src_dims and dst_dims, only the leading
+  // part of each dimension is used
+  void apply(const real4d &src, const real4d &dst) {
+    yakl::timer_start("pencil_transpose");
+
+    const int sdim = this->send_dim;
+    const int rdim = this->recv_dim;
+    SArray<int, 1, 4> sd;
+    SArray<int, 1, 4> dd;
+    for (int d = 0; d < 4; d++) {
+      sd(d) = this->src_dims[d];
+      dd(d) = this->dst_dims[d];
+    }
+    YAKL_SCOPE(send_beg, this->send_beg_d);
+    YAKL_SCOPE(send_displs, this->send_displs_d);
+    YAKL_SCOPE(recv_beg, this->recv_beg_d);
+    YAKL_SCOPE(recv_displs, this->recv_displs_d);
+    YAKL_SCOPE(send_buf, this->send_buf);
+    YAKL_SCOPE(recv_buf, this->recv_buf);
+
+    parallel_for(
+        "Pencil transpose pack", SimpleBounds<4>(sd(0), sd(1), sd(2), sd(3)),
+        YAKL_LAMBDA(int i0, int i1, int i2, int i3) {
+          int idx[4] = {i0, i1, i2, i3};
+          int bd[4] = {sd(0), sd(1), sd(2), sd(3)};
+          int p = 0;
+          while (idx[sdim] >= send_beg(p + 1)) {
+            p++;
+          }
+          bd[sdim] = send_beg(p + 1) - send_beg(p);
+          idx[sdim] -= send_beg(p);
+          int lin = ((idx[0] * bd[1] + idx[1]) * bd[2] + idx[2]) * bd[3] +
+                    idx[3];
+          send_buf(send_displs(p) + lin) = src(i0, i1, i2, i3);
+        });
+
+    stage_to_mpi(send_buf, send_buf_host);
+    // the pack kernel and the copy to the host must be done before MPI reads
+    // the send buffer
+    yakl::fence();
+    MPI_Alltoallv(send_buf_host.data(), send_counts.data(),
+                  send_displs.data(), PAMC_MPI_REAL, recv_buf_host.data(),
+                  recv_counts.data(), recv_displs.data(), PAMC_MPI_REAL, comm);
+    stage_from_mpi(recv_buf_host, recv_buf);
+
+    parallel_for(
+        "Pencil transpose unpack",
+        SimpleBounds<4>(dd(0), dd(1), dd(2), dd(3)),
+        YAKL_LAMBDA(int i0, int i1, int i2, int i3) {
+          int idx[4] = {i0, i1, i2, i3};
+          int bd[4] = {dd(0), dd(1), dd(2), dd(3)};
+          int p = 0;
+          while (idx[rdim] >= recv_beg(p + 1)) {
+            p++;
+          }
+          bd[rdim] = recv_beg(p + 1) - recv_beg(p);
+          idx[rdim] -= recv_beg(p);
+          int lin = ((idx[0] * bd[1] + idx[1]) * bd[2] + idx[2]) * bd[3] +
+                    idx[3];
+          dst(i0, i1, i2, i3) = recv_buf(recv_displs(p) + lin);
+        });
+
+    yakl::timer_stop("pencil_transpose");
+  }
+
+private:
+  static int block_size(std::array<int, 4> dims, int dim,
+                        const std::vector<int> &beg, int p) {
+    dims[dim] = beg[p + 1] - beg[p];
+    return dims[0] * dims[1] * dims[2] * dims[3];
+  }
+
+  static int1d to_device(const std::vector<int> &v, const std::string &label) {
+    intHost1d host(label.c_str(), v.size());
+    for (int i = 0; i < v.size(); i++) {
+      host(i) = v[i];
+    }
+    return host.createDeviceCopy();
+  }
+};
+
+// Real FFT in both horizontal directions of an array of shape
+// (nlev, ny, nx, nens) distributed over the horizontal process grid.
+//
+// On a single process this is an in-place yakl::RealFFT1D in x followed by one
+// in y. Otherwise the data goes from the horizontal decomposition (z-pencils,
+// complete columns) to x-pencils, where the x transform is done, then to
+// y-pencils for the y transform, and back to z-pencils. These transposes are
+// all-to-alls within a row or a column of the process grid. The spectrum ends
+// up split horizontally with complete columns, as needed by vertical solves.
+//
+// The spectrum is packed like the output of RealFFT1D, the real and imaginary
+// parts of each mode next to each other. Each process owns the packed indices
+// [spec_i_beg, spec_i_beg + spec_nx) in x and [spec_j_beg, spec_j_beg +
+// spec_ny) in y, which are always split at mode boundaries
+class PencilFFT {
+public:
+  bool distributed;
+  int nlev, nens;
+  int nx, ny;
+  int nx_glob, ny_glob;
+  int nxf, nyf;
+  int spec_i_beg, spec_j_beg;
+  int spec_nx, spec_ny;
+
+  // in-place transform array, large enough for both the local physical data
+  // and the local part of the spectrum
+  real4d transform;
+
+  yakl::RealFFT1D<real> fft_x;
+  yakl::RealFFT1D<real> fft_y;
+
+  real4d xpencil;
+  real4d ypencil;
+  PencilTranspose to_xpencil, from_xpencil;
+  PencilTranspose to_ypencil, from_ypencil;
+  PencilTranspose to_zpencil, from_zpencil;
+
+  // communicators of this process's row and column of the process grid, freed
+  // when the last copy of this PencilFFT goes away
+  std::shared_ptr<MPI_Comm> row_comm;
+  std::shared_ptr<MPI_Comm> col_comm;
+
+  void initialize(const std::string &label, const Topology &topo, int nlev) {
+    this->nlev = nlev;
+    this->nens = topo.nens;
+    this->nx = topo.n_cells_x;
+    this->ny = topo.n_cells_y;
+    this->nx_glob = topo.nx_glob;
+    this->ny_glob = ndims > 1 ? topo.ny_glob : 1;
+    this->nxf = nx_glob + 2 - nx_glob % 2;
+    this->nyf = ndims > 1 ? ny_glob + 2 - ny_glob % 2 : 1;
+    this->distributed = topo.nprocx * topo.nprocy > 1;
+
+    if (!distributed) {
+      spec_i_beg = 0;
+      spec_j_beg = 0;
+      spec_nx = nxf;
+      spec_ny = nyf;
+      transform = real4d(label.c_str(), nlev, nyf, nxf, nens);
+      yakl::memset(transform, 0);
+      fft_x.init(transform, 2, nx_glob);
+      if (ndims > 1) {
+        fft_y.init(transform, 1, ny_glob);
+      }
+      return;
+    }
+
+    const int nprocx = topo.nprocx;
+    const int nprocy = topo.nprocy;
+    int myrank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+    const int py = myrank / nprocx;
+    const int px = myrank - nprocx * py;
+
+    row_comm = split_comm(py, px);
+    col_comm = split_comm(px, py);
+
+    auto blocks = [](int n, int nproc, int scale) {
+      std::vector<int> beg(nproc + 1);
+      for (int p = 0; p < nproc; p++) {
+        int len;
+        block_range(n, nproc, p, beg[p], len);
+        beg[p] *= scale;
+      }
+      beg[nproc] = n * scale;
+      return beg;
+    };
+
+    // levels of the x- and y-pencils, split within a row
+    const auto lev_beg = blocks(nlev, nprocx, 1);
+    const int nlev_x = lev_beg[px + 1] - lev_beg[px];
+    const auto x_beg = blocks(nx_glob, nprocx, 1);
+
+    to_xpencil.initialize(*row_comm, {nlev, ny, nx, nens}, 0, lev_beg, 2,
+                          x_beg);
+    from_xpencil.initialize_inverse(to_xpencil);
+    xpencil = real4d("x pencil", nlev_x, ny, nxf, nens);
+    yakl::memset(xpencil, 0);
+    fft_x.init(xpencil, 2, nx_glob);
+
+    if (ndims > 1) {
+      // x modes of the y-pencils, split within a column
+      const auto xf_beg = blocks(nxf / 2, nprocy, 2);
+      const auto y_beg = blocks(ny_glob, nprocy, 1);
+      const int nxf_y = xf_beg[py + 1] - xf_beg[py];
+
+      to_ypencil.initialize(*col_comm, {nlev_x, ny, nxf, nens}, 2, xf_beg, 1,
+                            y_beg);
+      from_ypencil.initialize_inverse(to_ypencil);
+      ypencil = real4d("y pencil", nlev_x, nyf, nxf_y, nens);
+      yakl::memset(ypencil, 0);
+      fft_y.init(ypencil, 1, ny_glob);
+
+      // y modes of the z-pencils, split within a row
+      const auto yf_beg = blocks(nyf / 2, nprocx, 2);
+      to_zpencil.initialize(*row_comm, {nlev_x, nyf, nxf_y, nens}, 1, yf_beg,
+                            0, lev_beg);
+      from_zpencil.initialize_inverse(to_zpencil);
+
+      spec_i_beg = xf_beg[py];
+      spec_nx = nxf_y;
+      spec_j_beg = yf_beg[px];
+      spec_ny = yf_beg[px + 1] - yf_beg[px];
+    } else {
+      // x modes of the z-pencils, split within a row
+      const auto xf_beg = blocks(nxf / 2, nprocx, 2);
+      to_zpencil.initialize(*row_comm, {nlev_x, 1, nxf, nens}, 2, xf_beg, 0,
+                            lev_beg);
+      from_zpencil.initialize_inverse(to_zpencil);
+
+      spec_i_beg = xf_beg[px];
+      spec_nx = xf_beg[px + 1] - xf_beg[px];
+      spec_j_beg = 0;
+      spec_ny = 1;
+    }
+
+    transform = real4d(label.c_str(), nlev, std::max(ny, spec_ny),
+                       std::max(nx, spec_nx), nens);
+    yakl::memset(transform, 0);
+  }
+
+  // transforms the physical data in transform(:, 0:ny-1, 0:nx-1, :) into the
+  // local part of the spectrum in transform(:, 0:spec_ny-1, 0:spec_nx-1, :)
+  void forward_real() {
+    if (!distributed) {
+      fft_x.forward_real(transform);
+      if (ndims > 1) {
+        fft_y.forward_real(transform);
+      }
+      return;
+    }
+    to_xpencil.apply(transform, xpencil);
+    fft_x.forward_real(xpencil);
+    if (ndims > 1) {
+      to_ypencil.apply(xpencil, ypencil);
+      fft_y.forward_real(ypencil);
+      to_zpencil.apply(ypencil, transform);
+    } else {
+      to_zpencil.apply(xpencil, transform);
+    }
+  }
+
+  // inverse of forward_real
+  void inverse_real() {
+    if (!distributed) {
+      fft_x.inverse_real(transform);
+      if (ndims > 1) {
+        fft_y.inverse_real(transform);
+      }
+      return;
+    }
+    if (ndims > 1) {
+      from_zpencil.apply(transform, ypencil);
+      fft_y.inverse_real(ypencil);
+      from_ypencil.apply(ypencil, xpencil);
+    } else {
+      from_zpencil.apply(transform, xpencil);
+    }
+    fft_x.inverse_real(xpencil);
+    from_xpencil.apply(xpencil, transform);
+  }
+
+private:
+  static std::shared_ptr<MPI_Comm> split_comm(int color, int key) {
+    std::shared_ptr<MPI_Comm> comm(new MPI_Comm, [](MPI_Comm *c) {
+      int finalized;
+      MPI_Finalized(&finalized);
+      if (!finalized) {
+        MPI_Comm_free(c);
+      }
+      delete c;
+    });
+    MPI_Comm_split(MPI_COMM_WORLD, color, key, comm.get());
+    return comm;
+  }
+};
+} // namespace pamc
@@ -0,0 +1,229 @@
+#pragma once
+
+#include "common.h"
+
+namespace pamc {
+
+// Algorithms for BatchedTridiagonalSolver. AUTO uses parallel cyclic reduction
+// on GPUs when there are too few columns to fill the device with one thread per
+// column, and the Thomas algorithm otherwise
+enum class TRIDIAG_METHOD { THOMAS, PCR, AUTO };
+
+TRIDIAG_METHOD parse_tridiag_method(const std::string &name) {
+  if (name == "thomas") {
+    return TRIDIAG_METHOD::THOMAS;
+  } else if (name == "pcr") {
+    return TRIDIAG_METHOD::PCR;
+  } else if (name == "auto") {
+    return TRIDIAG_METHOD::AUTO;
+  } else {
+    throw std::runtime_error("Unknown tridiagonal solver method: " + name);
+  }
+}
+
+// Solves many independent tridiagonal systems
+//   l(k) x(k-1) + d(k) x(k) + u(k) x(k+1) = r(k),  k = 0, ..., nz - 1
+// one for each column (j, i, n) of arrays indexed (k, j, i, n). The matrices
+// are factored once by factorize and then reused by every call to solve, so
+// only the right hand side work is repeated. Adjacent threads handle adjacent
+// n and i, and so read adjacent memory at every level
+template <class T> class BatchedTridiagonalSolver {
+public:
+  using T4d = yakl::Array<T, 4, yakl::memDevice, yakl::styleC>;
+  using T5d = yakl::Array<T, 5, yakl::memDevice, yakl::styleC>;
+
+  int nz, n1, n2, n3;
+  bool use_pcr;
+  int pcr_steps;
+
+  // Thomas: sub-diagonal, modified super-diagonal and inverse pivots
+  T4d lower;
+  T4d cprime;
+  T4d inv_pivot;
+
+  // PCR: elimination factors of each reduction step, final inverse diagonal
+  // and ping-pong right hand side buffers
+  T5d alpha;
+  T5d gamma;
+  T4d inv_diag;
+  T4d work0;
+  T4d work1;
+
+  void initialize(int nz, int n1, int n2, int n3, TRIDIAG_METHOD method) {
+    this->nz = nz;
+    this->n1 = n1;
+    this->n2 = n2;
+    this->n3 = n3;
+
+    if (method == TRIDIAG_METHOD::AUTO) {
+#if defined(YAKL_ARCH_CUDA) || defined(YAKL_ARCH_HIP) || defined(YAKL_ARCH_SYCL)
+      const int min_columns = 16384;
+      method = (n1 * n2 * n3 < min_columns && nz >= 32)
+                   ? TRIDIAG_METHOD::PCR
+                   : TRIDIAG_METHOD::THOMAS;
+#else
+      method = TRIDIAG_METHOD::THOMAS;
+#endif
+    }
+    this->use_pcr = method == TRIDIAG_METHOD::PCR;
+
+    if (use_pcr) {
+      pcr_steps = 0;
+      while ((1 << pcr_steps) < nz) {
+        pcr_steps++;
+      }
+      alpha = T5d("tri pcr alpha", std::max(pcr_steps, 1), nz, n1, n2, n3);
+      gamma = T5d("tri pcr gamma", std::max(pcr_steps, 1), nz, n1, n2, n3);
+      inv_diag = T4d("tri pcr inv diag", nz, n1, n2, n3);
+      work0 = T4d("tri pcr work0", nz, n1, n2, n3);
+      work1 = T4d("tri pcr work1", nz, n1, n2, n3);
+    } else {
+      lower = T4d("tri lower", nz, n1, n2, n3);
+      cprime = T4d("tri cprime", nz, n1, n2, n3);
+      inv_pivot = T4d("tri inv pivot", nz, n1, n2, n3);
+    }
+  }
+
+  // l, d and u may be larger than (nz, n1, n2, n3), l(0) and u(nz - 1) are
+  // ignored
+  template <class A> void factorize(const A &l, const A &d, const A &u) {
+    const int nz = this->nz;
+
+    if (!use_pcr) {
+      YAKL_SCOPE(lower, this->lower);
+      YAKL_SCOPE(cprime, this->cprime);
+      YAKL_SCOPE(inv_pivot, this->inv_pivot);
+      parallel_for(
+          "Tridiagonal factorize", SimpleBounds<3>(n1, n2, n3),
+          YAKL_LAMBDA(int j, int i, int n) {
+            lower(0, j, i, n) = 0;
+            inv_pivot(0, j, i, n) = T(1) / d(0, j, i, n);
+            cprime(0, j, i, n) = u(0, j, i, n) * inv_pivot(0, j, i, n);
+            for (int k = 1; k < nz; ++k) {
+              lower(k, j, i, n) = l(k, j, i, n);
+              T pivot = d(k, j, i, n) - l(k, j, i, n) * cprime(k - 1, j, i, n);
+              inv_pivot(k, j, i, n) = T(1) / pivot;
+              cprime(k, j, i, n) =
+                  k < nz - 1 ? u(k, j, i, n) * inv_pivot(k, j, i, n) : T(0);
+            }
+          });
+      return;
+    }
+
+    // reduce copies of the coefficients, storing the elimination factors
+    T4d a("tri pcr a", nz, n1, n2, n3);
+    T4d b("tri pcr b", nz, n1, n2, n3);
+    T4d c("tri pcr c", nz, n1, n2, n3);
+    T4d a_new("tri pcr a new", nz, n1, n2, n3);
+    T4d b_new("tri pcr b new", nz, n1, n2, n3);
+    T4d c_new("tri pcr c new", nz, n1, n2, n3);
+    parallel_for(
+        "Tridiagonal PCR copy", SimpleBounds<4>(nz, n1, n2, n3),
+        YAKL_LAMBDA(int k, int j, int i, int n) {
+          a(k, j, i, n) = k > 0 ? l(k, j, i, n) : T(0);
+          b(k, j, i, n) = d(k, j, i, n);
+          c(k, j, i, n) = k < nz - 1 ? u(k, j, i, n) : T(0);
+        });
+
+    YAKL_SCOPE(alpha, this->alpha);
+    YAKL_SCOPE(gamma, this->gamma);
+    for (int s = 0; s < pcr_steps; ++s) {
+      const int h = 1 << s;
+      parallel_for(
+          "Tridiagonal PCR factorize", SimpleBounds<4>(nz, n1, n2, n3),
+          YAKL_LAMBDA(int k, int j, int i, int n) {
+            T al = 0;
+            T ga = 0;
+            T bk = b(k, j, i, n);
+            T ak = 0;
+            T ck = 0;
+            if (k - h >= 0) {
+              al = -a(k, j, i, n) / b(k - h, j, i, n);
+              ak = al * a(k - h, j, i, n);
+              bk += al * c(k - h, j, i, n);
+            }
+            if (k + h < nz) {
+              ga = -c(k, j, i, n) / b(k + h, j, i, n);
+              ck = ga * c(k + h, j, i, n);
+              bk += ga * a(k + h, j, i, n);
+            }
+            alpha(s, k, j, i, n) = al;
+            gamma(s, k, j, i, n) = ga;
+            a_new(k, j, i, n) = ak;
+            b_new(k, j, i, n) = bk;
+            c_new(k, j, i, n) = ck;
+          });
+      a_new.deep_copy_to(a);
+      b_new.deep_copy_to(b);
+      c_new.deep_copy_to(c);
+    }
+
+    YAKL_SCOPE(inv_diag, this->inv_diag);
+    parallel_for(
+        "Tridiagonal PCR inverse diagonal", SimpleBounds<4>(nz, n1, n2, n3),
+        YAKL_LAMBDA(int k, int j, int i, int n) {
+          inv_diag(k, j, i, n) = T(1) / b(k, j, i, n);
+        });
+  }
+
+  // solves in place, rhs may be larger than (nz, n1, n2, n3)
+  template <class A> void solve(const A &rhs) {
+    yakl::timer_start("tridiagonal_solve");
+    const int nz = this->nz;
+
+    if (!use_pcr) {
+      YAKL_SCOPE(lower, this->lower);
+      YAKL_SCOPE(cprime, this->cprime);
+      YAKL_SCOPE(inv_pivot, this->inv_pivot);
+      parallel_for(
+          "Tridiagonal solve", SimpleBounds<3>(n1, n2, n3),
+          YAKL_LAMBDA(int j, int i, int n) {
+            rhs(0, j, i, n) *= inv_pivot(0, j, i, n);
+            for (int k = 1; k < nz; ++k) {
+              rhs(k, j, i, n) =
+                  (rhs(k, j, i, n) - lower(k, j, i, n) * rhs(k - 1, j, i, n)) *
+                  inv_pivot(k, j, i, n);
+            }
+            for (int k = nz - 2; k >= 0; --k) {
+              rhs(k, j, i, n) -= cprime(k, j, i, n) * rhs(k + 1, j, i, n);
+            }
+          });
+      yakl::timer_stop("tridiagonal_solve");
+      return;
+    }
+
+    YAKL_SCOPE(alpha, this->alpha);
+    YAKL_SCOPE(gamma, this->gamma);
+    YAKL_SCOPE(inv_diag, this->inv_diag);
+    T4d src = this->work0;
+    T4d dst = this->work1;
+    parallel_for(
+        "Tridiagonal PCR load", SimpleBounds<4>(nz, n1, n2, n3),
+        YAKL_LAMBDA(int k, int j, int i, int n) {
+          src(k, j, i, n) = rhs(k, j, i, n);
+        });
+    for (int s = 0; s < pcr_steps; ++s) {
+      const int h = 1 << s;
+      parallel_for(
+          "Tridiagonal PCR step", SimpleBounds<4>(nz, n1, n2, n3),
+          YAKL_LAMBDA(int k, int j, int i, int n) {
+            T val = src(k, j, i, n);
+            if (k - h >= 0) {
+              val += alpha(s, k, j, i, n) * src(k - h, j, i, n);
+            }
+            if (k + h < nz) {
+              val += gamma(s, k, j, i, n) * src(k + h, j, i, n);
+            }
+            dst(k, j, i, n) = val;
+          });
+      std::swap(src, dst);
+    }
+    parallel_for(
+        "Tridiagonal PCR store", SimpleBounds<4>(nz, n1, n2, n3),
+        YAKL_LAMBDA(int k, int j, int i, int n) {
+          rhs(k, j, i, n) = src(k, j, i, n) * inv_diag(k, j, i, n);
+        });
+    yakl::timer_stop("tridiagonal_solve");
+  }
+};
+} // namespace pamc
@@ -17,11 +17,13 @@ public:
                   Parallel &par, const FieldSet<nprognostic> &progvars,
                   const FieldSet<nconstant> &const_vars,
                   const std::vector<std::unique_ptr<Diagnostic>> &diag,
-                  Stats &stats) {}
+                  Stats &stats, bool async_output = false) {}
   void output(real time) {}
   void outputInit(real time, const Geometry<Straight> &primal_geometry,
                   const Geometry<Twisted> &dual_geometry,
                   const ModelParameters &params) {}
   void outputStats(const Stats &stats) {}
+  void flush() {}
+  void finalize() {}
 };
 } // namespace pamc
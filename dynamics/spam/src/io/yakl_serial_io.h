@@ -1,6 +1,7 @@
 #pragma once
 
 #include "YAKL_netcdf.h"
+#include "async_writer.h"
 #include "common.h"
 #include "field_sets.h"
 #include "model.h"
@@ -10,15 +11,21 @@ namespace pamc {
 
 class FileIO {
 
+  // layout of one output field in the staging buffers
+  struct OutputField {
+    std::string name;
+    std::vector<std::string> dims;
+    int ndofs, nz, ny, nx, nens;
+    int offset;
+  };
+
 public:
   bool is_initialized;
   int masterproc;
   yakl::SimpleNetCDF nc;
   int ulIndex = 0; // Unlimited dimension index to place this data at
 
-  std::array<real5d, nprognostic> prog_temp_arr;
   std::array<real5d, nconstant> const_temp_arr;
-  std::vector<real5d> diag_temp_arr;
   std::string outputName;
 
   const FieldSet<nprognostic> *prog_vars;
@@ -26,28 +33,75 @@ public:
   const std::vector<std::unique_ptr<Diagnostic>> *diagnostics;
   Stats *statistics;
 
+  // prognostic and diagnostic fields are packed into one device buffer and
+  // copied to host with a single transfer. With async output the host side is
+  // double buffered and a pam::AsyncWriter thread does the NetCDF work, so the
+  // time loop only waits when both buffers are still being written. All NetCDF
+  // calls hold pam::netcdf_mutex()
+  bool async_output = false;
+  std::vector<OutputField> output_fields;
+  real1d stage_dev;
+  std::array<realHost1d, 2> stage_host;
+  std::array<bool, 2> stage_busy = {false, false};
+  int stage_next = 0;
+
+  pam::AsyncWriter writer;
+
   FileIO();
+  ~FileIO();
   FileIO(const FileIO &fio) = delete;
   FileIO &operator=(const FileIO &fio) = delete;
   void initialize(std::string outputName, Topology &ptopo, Topology &dtopo,
                   Parallel &par, const FieldSet<nprognostic> &progvars,
                   const FieldSet<nconstant> &const_vars,
                   const std::vector<std::unique_ptr<Diagnostic>> &diag,
-                  Stats &stats);
+                  Stats &stats, bool async_output = false);
   void output(real time);
   void outputInit(real time, const Geometry<Straight> &primal_geometry,
                   const Geometry<Twisted> &dual_geometry,
                   const ModelParameters &params);
   void outputStats(const Stats &stats);
+  // waits for all pending writes
+  void flush();
+  void finalize();
+
+private:
+  void add_output_field(const Field &field, int &offset);
+  void snapshot(int b);
+  void write_snapshot(const realHost1d &host, real time);
+  void write_stats(const std::vector<realHost3d> &data);
 };
 
 FileIO::FileIO() { this->is_initialized = false; }
 
+FileIO::~FileIO() { finalize(); }
+
+std::vector<std::string> output_dims(const Field &field) {
+  std::string prefix = field.topology.primal ? "primal_" : "dual_";
+  std::string levels = field.extdof == 1 ? "nlayers" : "ninterfaces";
+  return {field.name + "_ndofs", prefix + levels, prefix + "ncells_y",
+          prefix + "ncells_x", "nens"};
+}
+
+void FileIO::add_output_field(const Field &field, int &offset) {
+  OutputField out;
+  out.name = field.name;
+  out.dims = output_dims(field);
+  out.ndofs = field.total_dofs;
+  out.nz = field._nz;
+  out.ny = field.topology.n_cells_y;
+  out.nx = field.topology.n_cells_x;
+  out.nens = field.topology.nens;
+  out.offset = offset;
+  offset += out.ndofs * out.nz * out.ny * out.nx * out.nens;
+  output_fields.push_back(out);
+}
+
 void FileIO::initialize(std::string outName, Topology &ptopo, Topology &dtopo,
                         Parallel &par, const FieldSet<nprognostic> &progvars,
                         const FieldSet<nconstant> &constvars,
                         const std::vector<std::unique_ptr<Diagnostic>> &diag,
-                        Stats &stats) {
+                        Stats &stats, bool async_output) {
 
   this->outputName = outName + std::to_string(par.actualrank) + ".nc";
   this->prog_vars = &progvars;
@@ -55,6 +109,7 @@ void FileIO::initialize(std::string outName, Topology &ptopo, Topology &dtopo,
   this->diagnostics = &diag;
   this->statistics = &stats;
   this->masterproc = par.masterproc;
+  this->async_output = async_output;
 
   // int nranks;
   // int ierr = MPI_Comm_size(MPI_COMM_WORLD,&nranks);
@@ -73,6 +128,7 @@ void FileIO::initialize(std::string outName, Topology &ptopo, Topology &dtopo,
   // plus some parallel decomp stuff new arrays- coordinate values for all the
   // various dofs
 
+  std::unique_lock<std::mutex> nc_lock(pam::netcdf_mutex());
   nc.create(this->outputName);
   nc.createDim("t");
   // nc.createDim( "primal_ncells_x" ,  ptopo.nx_glob );
@@ -109,144 +165,136 @@ void FileIO::initialize(std::string outName, Topology &ptopo, Topology &dtopo,
                this->const_vars->fields_arr[i].topology.nens);
   }
 
+  int stage_size = 0;
   for (int i = 0; i < this->prog_vars->fields_arr.size(); i++) {
     nc.createDim(this->prog_vars->fields_arr[i].name + "_ndofs",
                  this->prog_vars->fields_arr[i].total_dofs);
-    this->prog_temp_arr[i] =
-        real5d(this->prog_vars->fields_arr[i].name.c_str(),
-               this->prog_vars->fields_arr[i].total_dofs,
-               this->prog_vars->fields_arr[i]._nz,
-               this->prog_vars->fields_arr[i].topology.n_cells_y,
-               this->prog_vars->fields_arr[i].topology.n_cells_x,
-               this->prog_vars->fields_arr[i].topology.nens);
+    add_output_field(this->prog_vars->fields_arr[i], stage_size);
   }
 
   for (auto &diag : *diagnostics) {
     auto &field = diag->field;
     nc.createDim(field.name + "_ndofs", field.total_dofs);
-    diag_temp_arr.emplace_back(real5d(field.name.c_str(), field.total_dofs,
-                                      field._nz, field.topology.n_cells_y,
-                                      field.topology.n_cells_x,
-                                      field.topology.nens));
+    add_output_field(field, stage_size);
   }
 
   nc.close();
+  nc_lock.unlock();
+
+  stage_dev = real1d("output stage", stage_size);
+  for (int b = 0; b < (async_output ? 2 : 1); ++b) {
+    stage_host[b] = realHost1d("output stage host", stage_size);
+    // page-locked host memory lets the device copy run at full bandwidth
+#if defined(YAKL_ARCH_CUDA)
+    cudaHostRegister(stage_host[b].data(), stage_size * sizeof(real),
+                     cudaHostRegisterDefault);
+#elif defined(YAKL_ARCH_HIP)
+    hipHostRegister(stage_host[b].data(), stage_size * sizeof(real),
+                    hipHostRegisterDefault);
+#endif
+  }
+
+  if (async_output) {
+    writer.start();
+  }
 
   this->is_initialized = true;
 }
 
-void FileIO::output(real time) {
+void FileIO::snapshot(int b) {
+  YAKL_SCOPE(stage_dev, this->stage_dev);
+
+  int l = 0;
+  auto pack = [&](const Field &field) {
+    const int offset = output_fields[l++].offset;
+    const int is = field.topology.is;
+    const int js = field.topology.js;
+    const int ks = field.topology.ks;
+    const int ndofs = field.total_dofs;
+    const int nz = field._nz;
+    const int ny = field.topology.n_cells_y;
+    const int nx = field.topology.n_cells_x;
+    const int nens = field.topology.nens;
+    const auto &data = field.data;
+    parallel_for(
+        "spam output pack", SimpleBounds<5>(ndofs, nz, ny, nx, nens),
+        YAKL_LAMBDA(int ndof, int k, int j, int i, int n) {
+          const int idx = n + nens * (i + nx * (j + ny * (k + nz * ndof)));
+          stage_dev(offset + idx) = data(ndof, k + ks, j + js, i + is, n);
+        });
+  };
+
+  for (int f = 0; f < this->prog_vars->fields_arr.size(); f++) {
+    pack(this->prog_vars->fields_arr[f]);
+  }
+  for (auto &diag : *diagnostics) {
+    pack(diag->field);
+  }
+
+  stage_dev.deep_copy_to(stage_host[b]);
+  yakl::fence();
+}
+
+void FileIO::write_snapshot(const realHost1d &host, real time) {
+  std::lock_guard<std::mutex> nc_lock(pam::netcdf_mutex());
   nc.open(this->outputName, yakl::NETCDF_MODE_WRITE);
   ulIndex = nc.getDimSize("t");
   // Write the elapsed time
   nc.write1(time, "t", ulIndex, "t");
 
-  for (int l = 0; l < this->prog_vars->fields_arr.size(); l++) {
+  for (const auto &out : output_fields) {
+    realHost5d arr(out.name.c_str(), host.data() + out.offset, out.ndofs,
+                   out.nz, out.ny, out.nx, out.nens);
+    nc.write1(arr, out.name, out.dims, ulIndex, "t");
+  }
 
-    int is = this->prog_vars->fields_arr[l].topology.is;
-    int js = this->prog_vars->fields_arr[l].topology.js;
-    int ks = this->prog_vars->fields_arr[l].topology.ks;
-    YAKL_SCOPE(prog_vars_fields, this->prog_vars->fields_arr);
-    YAKL_SCOPE(prog_temp_arr, this->prog_temp_arr);
-    parallel_for(
-        "spam output prognostic",
-        SimpleBounds<5>(this->prog_vars->fields_arr[l].total_dofs,
-                        this->prog_vars->fields_arr[l]._nz,
-                        this->prog_vars->fields_arr[l].topology.n_cells_y,
-                        this->prog_vars->fields_arr[l].topology.n_cells_x,
-                        this->prog_vars->fields_arr[l].topology.nens),
-        YAKL_LAMBDA(int ndof, int k, int j, int i, int n) {
-          prog_temp_arr[l](ndof, k, j, i, n) =
-              prog_vars_fields[l].data(ndof, k + ks, j + js, i + is, n);
-        });
+  nc.close();
+}
 
-    if (this->prog_vars->fields_arr[l].topology.primal) {
-      if (this->prog_vars->fields_arr[l].extdof == 1) {
-        nc.write1(this->prog_temp_arr[l].createHostCopy(),
-                  this->prog_vars->fields_arr[l].name,
-                  {this->prog_vars->fields_arr[l].name + "_ndofs",
-                   "primal_nlayers", "primal_ncells_y", "primal_ncells_x",
-                   "nens"},
-                  ulIndex, "t");
-      }
-      if (this->prog_vars->fields_arr[l].extdof == 0) {
-        nc.write1(this->prog_temp_arr[l].createHostCopy(),
-                  this->prog_vars->fields_arr[l].name,
-                  {this->prog_vars->fields_arr[l].name + "_ndofs",
-                   "primal_ninterfaces", "primal_ncells_y", "primal_ncells_x",
-                   "nens"},
-                  ulIndex, "t");
-      }
-    } else {
-      if (this->prog_vars->fields_arr[l].extdof == 1) {
-        nc.write1(this->prog_temp_arr[l].createHostCopy(),
-                  this->prog_vars->fields_arr[l].name,
-                  {this->prog_vars->fields_arr[l].name + "_ndofs",
-                   "dual_nlayers", "dual_ncells_y", "dual_ncells_x", "nens"},
-                  ulIndex, "t");
-      }
-      if (this->prog_vars->fields_arr[l].extdof == 0) {
-        nc.write1(this->prog_temp_arr[l].createHostCopy(),
-                  this->prog_vars->fields_arr[l].name,
-                  {this->prog_vars->fields_arr[l].name + "_ndofs",
-                   "dual_ninterfaces", "dual_ncells_y", "dual_ncells_x",
-                   "nens"},
-                  ulIndex, "t");
-      }
-    }
+void FileIO::output(real time) {
+  if (!async_output) {
+    snapshot(0);
+    write_snapshot(stage_host[0], time);
+    return;
   }
 
-  for (int l = 0; l < diagnostics->size(); l++) {
-    auto &field = (*diagnostics)[l]->field;
-
-    int is = field.topology.is;
-    int js = field.topology.js;
-    int ks = field.topology.ks;
-    YAKL_SCOPE(diag_temp_arr_l, this->diag_temp_arr[l]);
-    parallel_for(
-        "spam output diagnostics",
-        SimpleBounds<5>(field.total_dofs, field._nz, field.topology.n_cells_y,
-                        field.topology.n_cells_x, field.topology.nens),
-        YAKL_LAMBDA(int ndof, int k, int j, int i, int n) {
-          diag_temp_arr_l(ndof, k, j, i, n) =
-              field.data(ndof, k + ks, j + js, i + is, n);
-        });
+  yakl::timer_start("output_snapshot");
+  const int b = stage_next;
+  stage_next = 1 - b;
+  writer.wait([&] { return !stage_busy[b]; });
+  writer.locked([&] { stage_busy[b] = true; });
+  snapshot(b);
+  yakl::timer_stop("output_snapshot");
+
+  writer.submit([this, b, time] {
+    write_snapshot(stage_host[b], time);
+    writer.locked([&] { stage_busy[b] = false; });
+  });
+}
 
-    if (field.topology.primal) {
-      if (field.extdof == 1) {
-        nc.write1(this->diag_temp_arr[l].createHostCopy(), field.name,
-                  {field.name + "_ndofs", "primal_nlayers", "primal_ncells_y",
-                   "primal_ncells_x", "nens"},
-                  ulIndex, "t");
-      }
-      if (field.extdof == 0) {
-        nc.write1(this->diag_temp_arr[l].createHostCopy(), field.name,
-                  {field.name + "_ndofs", "primal_ninterfaces",
-                   "primal_ncells_y", "primal_ncells_x", "nens"},
-                  ulIndex, "t");
-      }
-    } else {
-      if (field.extdof == 1) {
-        nc.write1(this->diag_temp_arr[l].createHostCopy(), field.name,
-                  {field.name + "_ndofs", "dual_nlayers", "dual_ncells_y",
-                   "dual_ncells_x", "nens"},
-                  ulIndex, "t");
-      }
-      if (field.extdof == 0) {
-        nc.write1(this->diag_temp_arr[l].createHostCopy(), field.name,
-                  {field.name + "_ndofs", "dual_ninterfaces", "dual_ncells_y",
-                   "dual_ncells_x", "nens"},
-                  ulIndex, "t");
-      }
+void FileIO::flush() { writer.flush(); }
+
+void FileIO::finalize() {
+  writer.finalize();
+#if defined(YAKL_ARCH_CUDA) || defined(YAKL_ARCH_HIP)
+  for (auto &host : stage_host) {
+    if (host.initialized()) {
+#if defined(YAKL_ARCH_CUDA)
+      cudaHostUnregister(host.data());
+#else
+      hipHostUnregister(host.data());
+#endif
     }
   }
-
-  nc.close();
+#endif
+  stage_host = {};
 }
 
 void FileIO::outputInit(real time, const Geometry<Straight> &primal_geometry,
                         const Geometry<Twisted> &dual_geometry,
                         const ModelParameters &params) {
+  flush();
+  std::unique_lock<std::mutex> nc_lock(pam::netcdf_mutex());
   nc.open(this->outputName, yakl::NETCDF_MODE_WRITE);
 
   nc.write(params.dt_crm_phys, "dt_crm_phys");
@@ -376,22 +424,33 @@ void FileIO::outputInit(real time, const Geometry<Straight> &primal_geometry,
   }
 
   nc.close();
+  nc_lock.unlock();
 
   output(time);
 }
 
+void FileIO::write_stats(const std::vector<realHost3d> &data) {
+  std::lock_guard<std::mutex> nc_lock(pam::netcdf_mutex());
+  nc.open(this->outputName, yakl::NETCDF_MODE_WRITE);
+
+  for (int l = 0; l < this->statistics->stats_arr.size(); l++) {
+    nc.write(data[l], this->statistics->stats_arr[l].name,
+             {this->statistics->stats_arr[l].name + "_ndofs", "statsize",
+              "nens"});
+  }
+
+  nc.close();
+}
+
 void FileIO::outputStats(const Stats &stats) {
   if (this->masterproc) {
-    nc.open(this->outputName, yakl::NETCDF_MODE_WRITE);
-
+    std::vector<realHost3d> data;
     for (int l = 0; l < this->statistics->stats_arr.size(); l++) {
-      nc.write(
-          this->statistics->stats_arr[l].data,
-          this->statistics->stats_arr[l].name,
-          {this->statistics->stats_arr[l].name + "_ndofs", "statsize", "nens"});
+      const auto &arr = this->statistics->stats_arr[l].data;
+      // the writer gets its own copy since stats keep accumulating
+      data.push_back(async_output ? arr.createHostCopy() : arr);
     }
-
-    nc.close();
+    writer.submit([this, data] { write_stats(data); });
   }
 }
 } // namespace pamc
@@ -2,6 +2,8 @@
 
 #include "common.h"
 #include "model.h"
+#include "pencil_fft.h"
+#include "tridiagonal.h"
 #include "profiles.h"
 #include "refstate.h"
 #include "stats.h"
@@ -197,16 +199,14 @@ struct AnelasticPressureSolver {
 
   bool is_initialized = false;
 
-  yakl::RealFFT1D<real> fftp_x;
-  yakl::RealFFT1D<real> fftp_y;
+  PencilFFT fftp;
 
-  int nxf, nyf;
   int kfix;
 
   real4d tri_l;
   real4d tri_d;
   real4d tri_u;
-  real4d tri_c;
+  BatchedTridiagonalSolver<real> tri_solver;
   real4d p_transform;
 
   void initialize(ModelParameters &params,
@@ -220,27 +220,20 @@ struct AnelasticPressureSolver {
     const auto &primal_topology = primal_geom.topology;
 
     auto pni = primal_topology.ni;
-    auto pnl = primal_topology.nl;
-    auto nx = primal_topology.n_cells_x;
-    auto ny = primal_topology.n_cells_y;
     auto nens = primal_topology.nens;
 
-    this->nxf = nx + 2 - nx % 2;
-    this->nyf = ndims > 1 ? ny + 2 - ny % 2 : ny;
     this->kfix = pni / 2;
 
-    p_transform = real4d("p transform", pni, nyf, nxf, nens);
-    yakl::memset(p_transform, 0);
-
-    fftp_x.init(p_transform, 2, nx);
-    if (ndims > 1) {
-      fftp_y.init(p_transform, 1, ny);
-    }
+    fftp.initialize("p transform", primal_topology, pni);
+    p_transform = fftp.transform;
 
+    const int nyf = fftp.spec_ny;
+    const int nxf = fftp.spec_nx;
     tri_d = real4d("tri d", pni, nyf, nxf, nens);
     tri_l = real4d("tri l", pni, nyf, nxf, nens);
     tri_u = real4d("tri u", pni, nyf, nxf, nens);
-    tri_c = real4d("tri c", pni, nyf, nxf, nens);
+    tri_solver.initialize(pni, nyf, nxf, nens,
+                          parse_tridiag_method(params.tridiag_method));
 
     this->is_initialized = true;
   }
@@ -280,21 +273,28 @@ struct AnelasticPressureSolver {
     YAKL_SCOPE(tri_u, this->tri_u);
     YAKL_SCOPE(kfix, this->kfix);
 
+    // the spectrum can be distributed, wavenumbers are global
+    const int nx_glob = fftp.nx_glob;
+    const int ny_glob = fftp.ny_glob;
+    const int spec_i_beg = fftp.spec_i_beg;
+    const int spec_j_beg = fftp.spec_j_beg;
+
     parallel_for(
         "Anelastic set coeffs",
-        SimpleBounds<4>(primal_topology.ni, nyf, nxf, primal_topology.nens),
+        SimpleBounds<4>(primal_topology.ni, fftp.spec_ny, fftp.spec_nx,
+                        primal_topology.nens),
         YAKL_LAMBDA(int k, int j, int i, int n) {
-          int ik = i / 2;
-          int jk = j / 2;
+          int ik = (i + spec_i_beg) / 2;
+          int jk = (j + spec_j_beg) / 2;
 
           SArray<real, 1, ndims> fH1;
           fourier_H10<diff_ord>(fH1, primal_geometry, dual_geometry, pis, pjs,
-                                pks, ik, jk, k, 0, dual_topology.n_cells_x,
-                                dual_topology.n_cells_y, dual_topology.ni);
+                                pks, ik, jk, k, 0, nx_glob, ny_glob,
+                                dual_topology.ni);
 
           SArray<real, 1, ndims> fD0Dbar;
-          fourier_cwD0Dnm1bar(fD0Dbar, 1, ik, jk, k, dual_topology.n_cells_x,
-                              dual_topology.n_cells_y, dual_topology.ni);
+          fourier_cwD0Dnm1bar(fD0Dbar, 1, ik, jk, k, nx_glob, ny_glob,
+                              dual_topology.ni);
 
           tri_l(k, j, i, n) = 0;
           tri_d(k, j, i, n) = 0;
@@ -331,6 +331,8 @@ struct AnelasticPressureSolver {
             tri_l(k, j, i, n) = 0;
           }
         });
+
+    tri_solver.factorize(tri_l, tri_d, tri_u);
   }
 };
 
@@ -412,9 +414,7 @@ public:
       convert_coupler_to_dynamics_wind(equations->varset, coupler, prog_vars,
                                        const_vars, couple_wind_exact_inverse);
     }
-    prog_vars.exchange();
-    const_vars.exchange();
-    auxiliary_vars.exchange();
+    exchange_aggregated(prog_vars, const_vars, auxiliary_vars);
 
 #if defined PAMC_AN || defined PAMC_MAN
     if (couple_wind) {
@@ -2262,7 +2262,9 @@ public:
     compute_dens0(auxiliary_vars.fields_arr[DENS0VAR].data,
                   x.fields_arr[DENSVAR].data);
 
-    auxiliary_vars.exchange({DENS0VAR});
+    // dens0 is first needed by the edge reconstructions, so its exchange
+    // overlaps the computation of the fluxes and of q and f
+    auxiliary_vars.exchange_begin({DENS0VAR});
 
     if (needs_to_recompute_F) {
       compute_F_and_FW(auxiliary_vars.fields_arr[F2VAR].data,
@@ -2284,9 +2286,11 @@ public:
         ndims > 1 ? optional_real5d{auxiliary_vars.fields_arr[FTXYVAR].data}
                   : std::nullopt);
 
-    auxiliary_vars.exchange({FTVAR, FTWVAR});
+    // FT is first needed by compute_recons, so its exchange overlaps the
+    // computation of q and f and the edge reconstructions
+    auxiliary_vars.exchange_begin({FTVAR, FTWVAR});
     if (ndims > 1) {
-      auxiliary_vars.exchange({FTXYVAR});
+      auxiliary_vars.exchange_begin({FTXYVAR});
     }
 
     compute_q_and_f(
@@ -2308,6 +2312,8 @@ public:
       auxiliary_vars.exchange({QXYVAR, FXYVAR});
     }
 
+    auxiliary_vars.exchange_end({DENS0VAR});
+
     // Compute densrecon, densvertrecon, qrecon and frecon
     if (dual_geometry.uniform_vertical) {
       compute_edge_reconstructions_uniform(
@@ -2363,6 +2369,11 @@ public:
       auxiliary_vars.exchange({QXYEDGERECONVAR, CORIOLISXYEDGERECONVAR});
     }
 
+    auxiliary_vars.exchange_end({FTVAR, FTWVAR});
+    if (ndims > 1) {
+      auxiliary_vars.exchange_end({FTXYVAR});
+    }
+
     compute_recons(
         auxiliary_vars.fields_arr[DENSRECONVAR].data,
         auxiliary_vars.fields_arr[DENSVERTRECONVAR].data,
@@ -2584,20 +2595,15 @@ public:
     const int dis = dual_topology.is;
     const int djs = dual_topology.js;
     const int dks = dual_topology.ks;
-    const int nxf = pressure_solver.nxf;
-    const int nyf = pressure_solver.nyf;
     const int kfix = pressure_solver.kfix;
 
     const auto &refstate = this->equations->reference_state;
     const auto &rho_pi = refstate.rho_pi.data;
     const auto &rho_di = refstate.rho_di.data;
 
-    auto &fftp_x = pressure_solver.fftp_x;
-    auto &fftp_y = pressure_solver.fftp_y;
-    const auto &tri_l = pressure_solver.tri_l;
-    const auto &tri_u = pressure_solver.tri_u;
-    const auto &tri_d = pressure_solver.tri_d;
-    const auto &tri_c = pressure_solver.tri_c;
+    auto &fftp = pressure_solver.fftp;
+    const int spec_i_beg = fftp.spec_i_beg;
+    const int spec_j_beg = fftp.spec_j_beg;
     YAKL_SCOPE(p_transform, this->pressure_solver.p_transform);
     YAKL_SCOPE(primal_geometry, this->primal_geometry);
     YAKL_SCOPE(dual_geometry, this->dual_geometry);
@@ -2651,47 +2657,24 @@ public:
         });
 
     yakl::timer_start("ffts");
-    fftp_x.forward_real(p_transform);
-    if (ndims > 1) {
-      fftp_y.forward_real(p_transform);
-    }
+    fftp.forward_real();
     yakl::timer_stop("ffts");
 
     parallel_for(
-        "Anelastic tridiagonal solve",
-        Bounds<3>(nyf, nxf, primal_topology.nens),
+        "Anelastic fix mean",
+        SimpleBounds<3>(fftp.spec_ny, fftp.spec_nx, primal_topology.nens),
         YAKL_LAMBDA(int j, int i, int n) {
           // set the horizontal mean of pressure to zero at k = kfix
-          int ik = i / 2;
-          int jk = j / 2;
+          int ik = (i + spec_i_beg) / 2;
+          int jk = (j + spec_j_beg) / 2;
           if (ik == 0 && jk == 0) {
             p_transform(kfix, j, i, n) = 0;
           }
-          int nz = primal_topology.ni;
-          tri_c(0, j, i, n) = tri_u(0, j, i, n) / tri_d(0, j, i, n);
-          for (int k = 1; k < nz - 1; ++k) {
-            tri_c(k, j, i, n) =
-                tri_u(k, j, i, n) /
-                (tri_d(k, j, i, n) - tri_l(k, j, i, n) * tri_c(k - 1, j, i, n));
-          }
-          p_transform(0, j, i, n) /= tri_d(0, j, i, n);
-          for (int k = 1; k < nz; ++k) {
-            p_transform(k, j, i, n) =
-                (p_transform(k, j, i, n) -
-                 tri_l(k, j, i, n) * p_transform(k - 1, j, i, n)) /
-                (tri_d(k, j, i, n) - tri_l(k, j, i, n) * tri_c(k - 1, j, i, n));
-          }
-          for (int k = nz - 2; k >= 0; --k) {
-            p_transform(k, j, i, n) -=
-                tri_c(k, j, i, n) * p_transform(k + 1, j, i, n);
-          }
         });
+    pressure_solver.tri_solver.solve(p_transform);
 
     yakl::timer_start("ffts");
-    fftp_x.inverse_real(p_transform);
-    if (ndims > 1) {
-      fftp_y.inverse_real(p_transform);
-    }
+    fftp.inverse_real();
     yakl::timer_stop("ffts");
 
     parallel_for(
@@ -2750,27 +2733,87 @@ public:
 };
 
 // *******   Linear system   ***********//
+
+// The linear solver works with the horizontal Fourier coefficients of v and w,
+// computed by PencilFFT. In 3d the packed real spectrum comes from a real FFT
+// in y of the (packed) real and imaginary parts of the x transform. The y-pair
+// jp of these holds the modes jm and ny - jm, jm = jp + spec_j_beg / 2, which
+// are stored in complex rows 2 * jp and 2 * jp + 1 of the local spectrum
+
+// Global y wavenumber of the complex row jc of the local spectrum, or -1 if the
+// row duplicates row jc - 1 (for modes that are their own mirror)
+YAKL_INLINE int spectral_mode_y(int jc, int spec_j_beg, int ny) {
+  if (ndims == 1) {
+    return jc;
+  }
+  const int jm = jc / 2 + spec_j_beg / 2;
+  if (jc % 2 == 0) {
+    return jm;
+  }
+  return (jm == 0 || 2 * jm == ny) ? -1 : ny - jm;
+}
+
+// Complex coefficients of the modes stored at y-pair jp and x mode ic of the
+// local packed real spectrum
+YAKL_INLINE void get_fourier_coeffs(const real5d &transform, int d, int k,
+                                    int jp, int ic, int n, complex &coeff,
+                                    complex &coeff_mirror) {
+  const int i = 2 * ic;
+  if (ndims == 1) {
+    coeff = complex(transform(d, k, jp, i, n), transform(d, k, jp, i + 1, n));
+    coeff_mirror = coeff;
+    return;
+  }
+  const complex a(transform(d, k, 2 * jp, i, n),
+                  transform(d, k, 2 * jp + 1, i, n));
+  const complex b(transform(d, k, 2 * jp, i + 1, n),
+                  transform(d, k, 2 * jp + 1, i + 1, n));
+  coeff = a + complex(0, 1) * b;
+  coeff_mirror = conj(a) + complex(0, 1) * conj(b);
+}
+
+// Inverse of get_fourier_coeffs
+YAKL_INLINE void set_fourier_coeffs(const real5d &transform, int d, int k,
+                                    int jp, int ic, int n, complex coeff,
+                                    complex coeff_mirror) {
+  const int i = 2 * ic;
+  if (ndims == 1) {
+    transform(d, k, jp, i, n) = coeff.real();
+    transform(d, k, jp, i + 1, n) = coeff.imag();
+    return;
+  }
+  const complex a = (coeff + conj(coeff_mirror)) / 2._fp;
+  const complex b = complex(0, -1) * (coeff - conj(coeff_mirror)) / 2._fp;
+  transform(d, k, 2 * jp, i, n) = a.real();
+  transform(d, k, 2 * jp + 1, i, n) = a.imag();
+  transform(d, k, 2 * jp, i + 1, n) = b.real();
+  transform(d, k, 2 * jp + 1, i + 1, n) = b.imag();
+}
+
 class ModelLinearSystem : public LinearSystem {
 
-  yakl::RealFFT1D<real> fftv_x;
-  yakl::RealFFT1D<real> fftw_x;
-  // yakl::RealFFT1D<real> fftv_y;
-  // yakl::RealFFT1D<real> fftw_y;
+  PencilFFT fftv;
+  PencilFFT fftw;
 
-  int nxf, nyf;
+  // size of the local spectrum in complex coefficients
+  int nyc, nxc;
 
   real4d Blin_coeff;
-  real4d v_transform;
-  real4d w_transform;
-  complex4d complex_vrhs;
+  real5d v_transform;
+  real5d w_transform;
+  complex5d complex_vrhs;
   complex4d complex_wrhs;
+  // 0: 1 / c1, 1 + d1 + d * ndensity_dycore: coupling of v(d) to w through
+  // density d1
   complex5d complex_vcoeff;
+  // coupling of the horizontal velocity components through the divergence,
+  // only needed in 3d
+  real4d vdiv_coeff;
 
   complex4d tri_l;
   complex4d tri_d;
   complex4d tri_u;
-
-  complex4d tri_c;
+  BatchedTridiagonalSolver<complex> tri_solver;
 
   using VS = VariableSet;
 
@@ -2780,46 +2823,43 @@ public:
                   const Geometry<Twisted> &dual_geom,
                   Equations &equations) override {
 
-    if (ndims > 1) {
-      throw std::runtime_error("semi-implicit not implemented in 3d yet");
-    }
-
     LinearSystem::initialize(params, primal_geom, dual_geom, equations);
 
     const auto &primal_topology = primal_geom.topology;
 
     auto pni = primal_topology.ni;
     auto pnl = primal_topology.nl;
-    auto nx = primal_topology.n_cells_x;
-    auto ny = primal_topology.n_cells_y;
     auto nens = primal_topology.nens;
 
-    this->nxf = nx + 2 - nx % 2;
-    this->nyf = ndims > 1 ? ny + 2 - ny % 2 : ny;
-
     this->Blin_coeff = real4d("Blin coeff", VS::ndensity_dycore,
                               VS::ndensity_dycore, pni, nens);
 
-    v_transform = real4d("v transform", pni, nyf, nxf, nens);
-    w_transform = real4d("w transform", pnl, nyf, nxf, nens);
-    yakl::memset(v_transform, 0);
-    yakl::memset(w_transform, 0);
-
-    complex_vrhs = complex4d("complex vrhs", pni, ny, nx, nens);
-    complex_wrhs = complex4d("complex wrhs", pnl, ny, nx, nens);
-
-    fftv_x.init(v_transform, 2, nx);
-    fftw_x.init(w_transform, 2, nx);
-    // fftv_y.init(v_transform, 1, ny);
-    // fftw_y.init(w_transform, 1, ny);
-
-    complex_vcoeff =
-        complex5d("complex vcoeff", 1 + VS::ndensity_dycore, pni, ny, nx, nens);
-
-    tri_d = complex4d("tri d", pnl, ny, nx, nens);
-    tri_l = complex4d("tri l", pnl, ny, nx, nens);
-    tri_u = complex4d("tri u", pnl, ny, nx, nens);
-    tri_c = complex4d("tri c", pnl, ny, nx, nens);
+    // the velocity components are transformed together
+    fftv.initialize("v transform", primal_topology, ndims * pni);
+    fftw.initialize("w transform", primal_topology, pnl);
+    const auto &vt = fftv.transform;
+    const auto &wt = fftw.transform;
+    v_transform = real5d("v transform", vt.data(), ndims, pni, vt.extent(1),
+                         vt.extent(2), nens);
+    w_transform = real5d("w transform", wt.data(), 1, pnl, wt.extent(1),
+                         wt.extent(2), nens);
+
+    this->nyc = fftv.spec_ny;
+    this->nxc = fftv.spec_nx / 2;
+
+    complex_vrhs = complex5d("complex vrhs", ndims, pni, nyc, nxc, nens);
+    complex_wrhs = complex4d("complex wrhs", pnl, nyc, nxc, nens);
+
+    complex_vcoeff = complex5d("complex vcoeff",
+                               1 + ndims * VS::ndensity_dycore, pni, nyc, nxc,
+                               nens);
+    vdiv_coeff = real4d("vdiv coeff", pni, nyc, nxc, nens);
+
+    tri_d = complex4d("tri d", pnl, nyc, nxc, nens);
+    tri_l = complex4d("tri l", pnl, nyc, nxc, nens);
+    tri_u = complex4d("tri u", pnl, nyc, nxc, nens);
+    tri_solver.initialize(pnl, nyc, nxc, nens,
+                          parse_tridiag_method(params.tridiag_method));
   }
 
   virtual void compute_coefficients(real dt) override {
@@ -2844,6 +2884,14 @@ public:
     real dtf = dt / 2;
     real dtf2 = dt * dt / 4;
 
+    // the spectrum can be distributed, wavenumbers are global
+    const int nx_glob = fftv.nx_glob;
+    const int ny_glob = fftv.ny_glob;
+    const int spec_i_beg = fftv.spec_i_beg;
+    const int spec_j_beg = fftv.spec_j_beg;
+    const int nyc = this->nyc;
+    const int nxc = this->nxc;
+
     const auto &rho_pi = refstate.rho_pi.data;
     const auto &q_pi = refstate.q_pi.data;
     const auto &rho_di = refstate.rho_di.data;
@@ -2859,6 +2907,7 @@ public:
     YAKL_SCOPE(tri_d, this->tri_d);
     YAKL_SCOPE(tri_u, this->tri_u);
     YAKL_SCOPE(complex_vcoeff, this->complex_vcoeff);
+    YAKL_SCOPE(vdiv_coeff, this->vdiv_coeff);
 
     parallel_for(
         "Compute Blin_coeff",
@@ -2909,71 +2958,90 @@ public:
 
     parallel_for(
         "compute vcoeff",
-        SimpleBounds<4>(primal_topology.ni, primal_topology.n_cells_y,
-                        primal_topology.n_cells_x, primal_topology.nens),
+        SimpleBounds<4>(primal_topology.ni, nyc, nxc, primal_topology.nens),
         YAKL_LAMBDA(int k, int j, int i, int n) {
+          const int jy = spectral_mode_y(j, spec_j_beg, ny_glob);
+          if (jy < 0) {
+            return;
+          }
+          const int ix = i + spec_i_beg / 2;
           SArray<real, 1, ndims> fD0Dbar;
-          fourier_cwD0Dnm1bar(fD0Dbar, 1, i, j, k, dual_topology.n_cells_x,
-                              dual_topology.n_cells_y, dual_topology.ni);
+          fourier_cwD0Dnm1bar(fD0Dbar, 1, ix, jy, k, nx_glob, ny_glob,
+                              dual_topology.ni);
 
           real fH2bar = fourier_Hn1bar<diff_ord>(
-              primal_geometry, dual_geometry, pis, pjs, pks, i, j, k, 0,
-              n_cells_x, n_cells_y, dual_topology.ni);
+              primal_geometry, dual_geometry, pis, pjs, pks, ix, jy, k, 0,
+              nx_glob, ny_glob, dual_topology.ni);
           SArray<real, 1, ndims> fH1;
           fourier_H10<diff_ord>(fH1, primal_geometry, dual_geometry, pis, pjs,
-                                pks, i, j, k, 0, n_cells_x, n_cells_y,
+                                pks, ix, jy, k, 0, nx_glob, ny_glob,
                                 dual_topology.ni);
           SArray<complex, 1, ndims> fD0;
-          fourier_cwD0(fD0, 1, i, j, k, dual_topology.n_cells_x,
-                       dual_topology.n_cells_y, dual_topology.ni);
+          fourier_cwD0(fD0, 1, ix, jy, k, nx_glob, ny_glob, dual_topology.ni);
 
           real he = rho_pi(0, k + pks, n);
 
+          // the horizontal operator is I - sigma * D0 (Dnm1bar H1)^T, whose
+          // inverse is I + sigma / c1 * D0 (Dnm1bar H1)^T
           real c1 = 1;
+          real sigma = 0;
           for (int d1 = 0; d1 < VS::ndensity_dycore; ++d1) {
             for (int d2 = 0; d2 < VS::ndensity_dycore; ++d2) {
-              c1 -= dtf2 * fH2bar * fH1(0) * fD0Dbar(0) * he *
-                    q_pi(d1, k + pks, n) * q_pi(d2, k + pks, n) *
-                    Blin_coeff(d1, d2, k, n);
+              for (int d = 0; d < ndims; ++d) {
+                c1 -= dtf2 * fH2bar * fH1(d) * fD0Dbar(d) * he *
+                      q_pi(d1, k + pks, n) * q_pi(d2, k + pks, n) *
+                      Blin_coeff(d1, d2, k, n);
+              }
+              sigma += dtf2 * fH2bar * he * q_pi(d1, k + pks, n) *
+                       q_pi(d2, k + pks, n) * Blin_coeff(d1, d2, k, n);
             }
           }
 
           complex_vcoeff(0, k, j, i, n) = 1 / c1;
-          for (int d1 = 0; d1 < VS::ndensity_dycore; ++d1) {
-            complex cd1 = 0;
-            for (int d2 = 0; d2 < VS::ndensity_dycore; ++d2) {
-              cd1 += fD0(0) * dtf2 * fH2bar * q_pi(d2, k + pks, n) *
-                     Blin_coeff(d2, d1, k, n);
+          vdiv_coeff(k, j, i, n) = sigma / c1;
+          for (int d = 0; d < ndims; ++d) {
+            for (int d1 = 0; d1 < VS::ndensity_dycore; ++d1) {
+              complex cd1 = 0;
+              for (int d2 = 0; d2 < VS::ndensity_dycore; ++d2) {
+                cd1 += fD0(d) * dtf2 * fH2bar * q_pi(d2, k + pks, n) *
+                       Blin_coeff(d2, d1, k, n);
+              }
+              complex_vcoeff(1 + d1 + d * VS::ndensity_dycore, k, j, i, n) =
+                  cd1 / c1;
             }
-            complex_vcoeff(1 + d1, k, j, i, n) = cd1 / c1;
           }
         });
 
     parallel_for(
         "Compute vertical tridiag",
-        SimpleBounds<4>(primal_topology.nl, primal_topology.n_cells_y,
-                        primal_topology.n_cells_x, primal_topology.nens),
+        SimpleBounds<4>(primal_topology.nl, nyc, nxc, primal_topology.nens),
         YAKL_LAMBDA(int k, int j, int i, int n) {
+          tri_u(k, j, i, n) = 0;
+          tri_d(k, j, i, n) = 1;
+          tri_l(k, j, i, n) = 0;
+
+          // rows without a mode of their own keep an identity system
+          const int jy = spectral_mode_y(j, spec_j_beg, ny_glob);
+          if (jy < 0) {
+            return;
+          }
+          const int ix = i + spec_i_beg / 2;
           real fH2bar_k = fourier_Hn1bar<diff_ord>(
-              primal_geometry, dual_geometry, pis, pjs, pks, i, j, k, 0,
-              n_cells_x, n_cells_y, dual_topology.ni);
+              primal_geometry, dual_geometry, pis, pjs, pks, ix, jy, k, 0,
+              nx_glob, ny_glob, dual_topology.ni);
           real fH2bar_kp1 = fourier_Hn1bar<diff_ord>(
-              primal_geometry, dual_geometry, pis, pjs, pks, i, j, k + 1, 0,
-              n_cells_x, n_cells_y, dual_topology.ni);
+              primal_geometry, dual_geometry, pis, pjs, pks, ix, jy, k + 1, 0,
+              nx_glob, ny_glob, dual_topology.ni);
 
           real gamma_fac_kp2 = rho_di(0, k + dks + 2, n) *
                                H01_coeff(primal_geometry, dual_geometry, pis,
-                                         pjs, pks, i, j, k + 2, n);
+                                         pjs, pks, ix, jy, k + 2, n);
           real gamma_fac_kp1 = rho_di(0, k + dks + 1, n) *
                                H01_coeff(primal_geometry, dual_geometry, pis,
-                                         pjs, pks, i, j, k + 1, n);
+                                         pjs, pks, ix, jy, k + 1, n);
           real gamma_fac_k =
               rho_di(0, k + dks, n) * H01_coeff(primal_geometry, dual_geometry,
-                                                pis, pjs, pks, i, j, k, n);
-
-          tri_u(k, j, i, n) = 0;
-          tri_d(k, j, i, n) = 1;
-          tri_l(k, j, i, n) = 0;
+                                                pis, pjs, pks, ix, jy, k, n);
 
           for (int d1 = 0; d1 < VS::ndensity_dycore; ++d1) {
             for (int d2 = 0; d2 < VS::ndensity_dycore; ++d2) {
@@ -2996,41 +3064,44 @@ public:
 
     parallel_for(
         "Compute horizontal tridiag",
-        SimpleBounds<4>(primal_topology.nl, primal_topology.n_cells_y,
-                        primal_topology.n_cells_x, primal_topology.nens),
+        SimpleBounds<4>(primal_topology.nl, nyc, nxc, primal_topology.nens),
         YAKL_LAMBDA(int k, int j, int i, int n) {
+          const int jy = spectral_mode_y(j, spec_j_beg, ny_glob);
+          if (jy < 0) {
+            return;
+          }
+          const int ix = i + spec_i_beg / 2;
           real fH2bar_k = fourier_Hn1bar<diff_ord>(
-              primal_geometry, dual_geometry, pis, pjs, pks, i, j, k, 0,
-              n_cells_x, n_cells_y, dual_topology.ni);
+              primal_geometry, dual_geometry, pis, pjs, pks, ix, jy, k, 0,
+              nx_glob, ny_glob, dual_topology.ni);
           real fH2bar_kp1 = fourier_Hn1bar<diff_ord>(
-              primal_geometry, dual_geometry, pis, pjs, pks, i, j, k + 1, 0,
-              n_cells_x, n_cells_y, dual_topology.ni);
+              primal_geometry, dual_geometry, pis, pjs, pks, ix, jy, k + 1, 0,
+              nx_glob, ny_glob, dual_topology.ni);
 
           real gamma_fac_kp2 = rho_di(0, k + dks + 2, n) *
                                H01_coeff(primal_geometry, dual_geometry, pis,
-                                         pjs, pks, i, j, k + 2, n);
+                                         pjs, pks, ix, jy, k + 2, n);
           real gamma_fac_kp1 = rho_di(0, k + dks + 1, n) *
                                H01_coeff(primal_geometry, dual_geometry, pis,
-                                         pjs, pks, i, j, k + 1, n);
+                                         pjs, pks, ix, jy, k + 1, n);
           real gamma_fac_k =
               rho_di(0, k + dks, n) * H01_coeff(primal_geometry, dual_geometry,
-                                                pis, pjs, pks, i, j, k, n);
+                                                pis, pjs, pks, ix, jy, k, n);
 
           SArray<real, 1, ndims> fH1_kp1_a;
           SArray<real, 1, ndims> fH1_k_a;
           fourier_H10<diff_ord>(fH1_kp1_a, primal_geometry, dual_geometry, pis,
-                                pjs, pks, i, j, k + 1, 0, n_cells_x, n_cells_y,
+                                pjs, pks, ix, jy, k + 1, 0, nx_glob, ny_glob,
                                 dual_topology.ni);
           fourier_H10<diff_ord>(fH1_k_a, primal_geometry, dual_geometry, pis,
-                                pjs, pks, i, j, k, 0, n_cells_x, n_cells_y,
+                                pjs, pks, ix, jy, k, 0, nx_glob, ny_glob,
                                 dual_topology.ni);
-          real fH1h_kp1 = fH1_kp1_a(0);
-          real fH1h_k = fH1_k_a(0);
-
-          complex fDnm1bar_kp1 = fourier_Dnm1bar(1, i, j, k + 1, n_cells_x,
-                                                 n_cells_y, dual_topology.ni);
-          complex fDnm1bar_k = fourier_Dnm1bar(1, i, j, k, n_cells_x, n_cells_y,
-                                               dual_topology.ni);
+          SArray<complex, 1, ndims> fDnm1bar_kp1;
+          SArray<complex, 1, ndims> fDnm1bar_k;
+          fourier_cwDnm1bar(fDnm1bar_kp1, 1, ix, jy, k + 1, nx_glob, ny_glob,
+                            dual_topology.ni);
+          fourier_cwDnm1bar(fDnm1bar_k, 1, ix, jy, k, nx_glob, ny_glob,
+                            dual_topology.ni);
 
           real he_kp1 = rho_pi(0, k + pks + 1, n);
           real he_k = rho_pi(0, k + pks, n);
@@ -3038,30 +3109,38 @@ public:
           for (int d1 = 0; d1 < VS::ndensity_dycore; ++d1) {
             for (int d2 = 0; d2 < VS::ndensity_dycore; ++d2) {
               for (int d3 = 0; d3 < VS::ndensity_dycore; ++d3) {
-
-                real alpha_kp1 = dtf2 * q_di(d1, k + dks + 1, n);
-                complex beta_kp1 = fH2bar_kp1 * Blin_coeff(d1, d2, k + 1, n) *
-                                   q_pi(d2, k + dks + 1, n) * fDnm1bar_kp1 *
-                                   he_kp1 * fH1h_kp1;
-                complex beta_k = fH2bar_k * Blin_coeff(d1, d2, k, n) *
-                                 q_pi(d2, k + pks, n) * fDnm1bar_k * he_k *
-                                 fH1h_k;
-
-                real gamma_kp2 = gamma_fac_kp2 * q_di(d3, k + dks + 2, n);
-                real gamma_kp1 = gamma_fac_kp1 * q_di(d3, k + dks + 1, n);
-                real gamma_k = gamma_fac_k * q_di(d3, k + dks, n);
-
-                complex vc_kp1 = complex_vcoeff(1 + d3, k + 1, j, i, n);
-                complex vc_k = complex_vcoeff(1 + d3, k, j, i, n);
-
-                tri_u(k, j, i, n) += -alpha_kp1 * beta_kp1 * vc_kp1 * gamma_kp2;
-                tri_d(k, j, i, n) +=
-                    alpha_kp1 * (beta_kp1 * vc_kp1 + beta_k * vc_k) * gamma_kp1;
-                tri_l(k, j, i, n) += -alpha_kp1 * beta_k * vc_k * gamma_k;
+                for (int d = 0; d < ndims; ++d) {
+
+                  real alpha_kp1 = dtf2 * q_di(d1, k + dks + 1, n);
+                  complex beta_kp1 = fH2bar_kp1 *
+                                     Blin_coeff(d1, d2, k + 1, n) *
+                                     q_pi(d2, k + dks + 1, n) *
+                                     fDnm1bar_kp1(d) * he_kp1 * fH1_kp1_a(d);
+                  complex beta_k = fH2bar_k * Blin_coeff(d1, d2, k, n) *
+                                   q_pi(d2, k + pks, n) * fDnm1bar_k(d) *
+                                   he_k * fH1_k_a(d);
+
+                  real gamma_kp2 = gamma_fac_kp2 * q_di(d3, k + dks + 2, n);
+                  real gamma_kp1 = gamma_fac_kp1 * q_di(d3, k + dks + 1, n);
+                  real gamma_k = gamma_fac_k * q_di(d3, k + dks, n);
+
+                  const int vc_idx = 1 + d3 + d * VS::ndensity_dycore;
+                  complex vc_kp1 = complex_vcoeff(vc_idx, k + 1, j, i, n);
+                  complex vc_k = complex_vcoeff(vc_idx, k, j, i, n);
+
+                  tri_u(k, j, i, n) +=
+                      -alpha_kp1 * beta_kp1 * vc_kp1 * gamma_kp2;
+                  tri_d(k, j, i, n) += alpha_kp1 *
+                                       (beta_kp1 * vc_kp1 + beta_k * vc_k) *
+                                       gamma_kp1;
+                  tri_l(k, j, i, n) += -alpha_kp1 * beta_k * vc_k * gamma_k;
+                }
               }
             }
           }
         });
+
+    tri_solver.factorize(tri_l, tri_d, tri_u);
   }
 
   virtual void solve(real dt, FieldSet<nprognostic> &rhs,
@@ -3109,6 +3188,14 @@ public:
     real dtf = dt / 2;
     real dtf2 = dt * dt / 4;
 
+    // the spectrum can be distributed, wavenumbers are global
+    const int nx_glob = fftv.nx_glob;
+    const int ny_glob = fftv.ny_glob;
+    const int spec_i_beg = fftv.spec_i_beg;
+    const int spec_j_beg = fftv.spec_j_beg;
+    const int nyc = this->nyc;
+    const int nxc = this->nxc;
+
     const auto &rho_pi = refstate.rho_pi.data;
     const auto &q_pi = refstate.q_pi.data;
     const auto &rho_di = refstate.rho_di.data;
@@ -3116,11 +3203,8 @@ public:
 
     YAKL_SCOPE(primal_geometry, this->primal_geometry);
     YAKL_SCOPE(dual_geometry, this->dual_geometry);
-    YAKL_SCOPE(tri_l, this->tri_l);
-    YAKL_SCOPE(tri_d, this->tri_d);
-    YAKL_SCOPE(tri_u, this->tri_u);
-    YAKL_SCOPE(tri_c, this->tri_c);
     YAKL_SCOPE(complex_vcoeff, this->complex_vcoeff);
+    YAKL_SCOPE(vdiv_coeff, this->vdiv_coeff);
     YAKL_SCOPE(v_transform, this->v_transform);
     YAKL_SCOPE(w_transform, this->w_transform);
     YAKL_SCOPE(complex_vrhs, this->complex_vrhs);
@@ -3156,73 +3240,90 @@ public:
           SArray<real, 1, ndims> mod_v;
           compute_wD0<VS::ndensity_dycore>(mod_v, q_pi, bvar, pis, pjs, pks, i,
                                            j, k, n);
-          v_transform(k, j, i, n) =
-              rhs_v(0, k + pks, j + pjs, i + pis, n) + mod_v(0);
+          for (int d = 0; d < ndims; ++d) {
+            v_transform(d, k, j, i, n) =
+                rhs_v(d, k + pks, j + pjs, i + pis, n) + mod_v(d);
+          }
           if (k < primal_topology.nl) {
             real mod_w = compute_wD0_vert<VS::ndensity_dycore>(
                 q_di, bvar, pis, pjs, pks, i, j, k, n);
-            w_transform(k, j, i, n) =
+            w_transform(0, k, j, i, n) =
                 rhs_w(0, k + pks, j + pjs, i + pis, n) + mod_w;
           }
         });
 
     yakl::timer_start("ffts");
-    fftv_x.forward_real(v_transform);
-    fftw_x.forward_real(w_transform);
-    // fftv_y.forward_real(v_transform);
-    // fftw_y.forward_real(w_transform);
+    fftv.forward_real();
+    fftw.forward_real();
     yakl::timer_stop("ffts");
 
+    const int ny_pairs = ndims > 1 ? nyc / 2 : nyc;
     parallel_for(
         "Transform result to complex",
-        yakl::c::Bounds<4>(primal_topology.ni, primal_topology.n_cells_y,
-                           {0, nxf - 1, 2}, primal_topology.nens),
-        YAKL_LAMBDA(int k, int j, int i, int n) {
-          real v_real = v_transform(k, j, i, n);
-          real v_imag = v_transform(k, j, i + 1, n);
-          complex_vrhs(k, j, i / 2, n) = complex(v_real, v_imag);
+        SimpleBounds<4>(primal_topology.ni, ny_pairs, nxc,
+                        primal_topology.nens),
+        YAKL_LAMBDA(int k, int jp, int i, int n) {
+          const int j = ndims > 1 ? 2 * jp : jp;
+          complex coeff, coeff_mirror;
+          for (int d = 0; d < ndims; ++d) {
+            get_fourier_coeffs(v_transform, d, k, jp, i, n, coeff,
+                               coeff_mirror);
+            complex_vrhs(d, k, j, i, n) = coeff;
+            if (ndims > 1) {
+              complex_vrhs(d, k, j + 1, i, n) = coeff_mirror;
+            }
+          }
           if (k < primal_topology.nl) {
-            real w_real = w_transform(k, j, i, n);
-            real w_imag = w_transform(k, j, i + 1, n);
-            complex_wrhs(k, j, i / 2, n) = complex(w_real, w_imag);
+            get_fourier_coeffs(w_transform, 0, k, jp, i, n, coeff,
+                               coeff_mirror);
+            complex_wrhs(k, j, i, n) = coeff;
+            if (ndims > 1) {
+              complex_wrhs(k, j + 1, i, n) = coeff_mirror;
+            }
           }
         });
 
     parallel_for(
         "Modify wrhs",
-        Bounds<4>(primal_topology.nl, primal_topology.n_cells_y,
-                  {0, (nxf - 1) / 2}, primal_topology.nens),
+        SimpleBounds<4>(primal_topology.nl, nyc, nxc, primal_topology.nens),
         YAKL_LAMBDA(int k, int j, int i, int n) {
-          int ik = i / 2;
-          int jk = j / 2;
-
-          complex vc0_kp1 =
-              complex_vcoeff(0, k + 1, j, i, n) * complex_vrhs(k + 1, j, i, n);
-          complex vc0_k =
-              complex_vcoeff(0, k, j, i, n) * complex_vrhs(k, j, i, n);
-
+          const int jy = spectral_mode_y(j, spec_j_beg, ny_glob);
+          if (jy < 0) {
+            return;
+          }
+          const int ix = i + spec_i_beg / 2;
           real fH2bar_k = fourier_Hn1bar<diff_ord>(
-              primal_geometry, dual_geometry, pis, pjs, pks, i, j, k, 0,
-              n_cells_x, n_cells_y, dual_topology.ni);
+              primal_geometry, dual_geometry, pis, pjs, pks, ix, jy, k, 0,
+              nx_glob, ny_glob, dual_topology.ni);
           real fH2bar_kp1 = fourier_Hn1bar<diff_ord>(
-              primal_geometry, dual_geometry, pis, pjs, pks, i, j, k + 1, 0,
-              n_cells_x, n_cells_y, dual_topology.ni);
+              primal_geometry, dual_geometry, pis, pjs, pks, ix, jy, k + 1, 0,
+              nx_glob, ny_glob, dual_topology.ni);
 
           SArray<real, 1, ndims> fH1_kp1_a;
           SArray<real, 1, ndims> fH1_k_a;
           fourier_H10<diff_ord>(fH1_kp1_a, primal_geometry, dual_geometry, pis,
-                                pjs, pks, i, j, k + 1, 0, n_cells_x, n_cells_y,
+                                pjs, pks, ix, jy, k + 1, 0, nx_glob, ny_glob,
                                 dual_topology.ni);
           fourier_H10<diff_ord>(fH1_k_a, primal_geometry, dual_geometry, pis,
-                                pjs, pks, i, j, k, 0, n_cells_x, n_cells_y,
+                                pjs, pks, ix, jy, k, 0, nx_glob, ny_glob,
                                 dual_topology.ni);
-          real fH1h_kp1 = fH1_kp1_a(0);
-          real fH1h_k = fH1_k_a(0);
-
-          complex fDnm1bar_kp1 = fourier_Dnm1bar(1, i, j, k + 1, n_cells_x,
-                                                 n_cells_y, dual_topology.ni);
-          complex fDnm1bar_k = fourier_Dnm1bar(1, i, j, k, n_cells_x, n_cells_y,
-                                               dual_topology.ni);
+          SArray<complex, 1, ndims> fDnm1bar_kp1;
+          SArray<complex, 1, ndims> fDnm1bar_k;
+          fourier_cwDnm1bar(fDnm1bar_kp1, 1, ix, jy, k + 1, nx_glob, ny_glob,
+                            dual_topology.ni);
+          fourier_cwDnm1bar(fDnm1bar_k, 1, ix, jy, k, nx_glob, ny_glob,
+                            dual_topology.ni);
+
+          // divergence of the inverse horizontal operator applied to vrhs
+          complex vc0_kp1 = 0;
+          complex vc0_k = 0;
+          for (int d = 0; d < ndims; ++d) {
+            vc0_kp1 += fDnm1bar_kp1(d) * fH1_kp1_a(d) *
+                       complex_vrhs(d, k + 1, j, i, n);
+            vc0_k += fDnm1bar_k(d) * fH1_k_a(d) * complex_vrhs(d, k, j, i, n);
+          }
+          vc0_kp1 *= complex_vcoeff(0, k + 1, j, i, n);
+          vc0_k *= complex_vcoeff(0, k, j, i, n);
 
           real he_kp1 = rho_pi(0, k + pks + 1, n);
           real he_k = rho_pi(0, k + pks, n);
@@ -3230,49 +3331,27 @@ public:
           for (int d1 = 0; d1 < VS::ndensity_dycore; ++d1) {
             for (int d2 = 0; d2 < VS::ndensity_dycore; ++d2) {
               real alpha_kp1 = dtf2 * q_di(d1, k + dks + 1, n);
-              complex beta_kp1 = fH2bar_kp1 * Blin_coeff(d1, d2, k + 1, n) *
-                                 q_pi(d2, k + pks + 1, n) * fDnm1bar_kp1 *
-                                 he_kp1 * fH1h_kp1;
-              complex beta_k = fH2bar_k * Blin_coeff(d1, d2, k, n) *
-                               q_pi(d2, k + pks, n) * fDnm1bar_k * he_k *
-                               fH1h_k;
+              real beta_kp1 = fH2bar_kp1 * Blin_coeff(d1, d2, k + 1, n) *
+                              q_pi(d2, k + pks + 1, n) * he_kp1;
+              real beta_k = fH2bar_k * Blin_coeff(d1, d2, k, n) *
+                            q_pi(d2, k + pks, n) * he_k;
               complex_wrhs(k, j, i, n) +=
                   alpha_kp1 * (beta_kp1 * vc0_kp1 - beta_k * vc0_k);
             }
           }
         });
 
-    parallel_for(
-        "Tridiagonal solve",
-        Bounds<3>(primal_topology.n_cells_y, {0, (nxf - 1) / 2},
-                  primal_topology.nens),
-        YAKL_LAMBDA(int j, int i, int n) {
-          int nz = primal_topology.nl;
-
-          tri_c(0, j, i, n) = tri_u(0, j, i, n) / tri_d(0, j, i, n);
-          for (int k = 1; k < nz - 1; ++k) {
-            tri_c(k, j, i, n) =
-                tri_u(k, j, i, n) /
-                (tri_d(k, j, i, n) - tri_l(k, j, i, n) * tri_c(k - 1, j, i, n));
-          }
-          complex_wrhs(0, j, i, n) /= tri_d(0, j, i, n);
-          for (int k = 1; k < nz; ++k) {
-            complex_wrhs(k, j, i, n) =
-                (complex_wrhs(k, j, i, n) -
-                 tri_l(k, j, i, n) * complex_wrhs(k - 1, j, i, n)) /
-                (tri_d(k, j, i, n) - tri_l(k, j, i, n) * tri_c(k - 1, j, i, n));
-          }
-          for (int k = nz - 2; k >= 0; --k) {
-            complex_wrhs(k, j, i, n) -=
-                tri_c(k, j, i, n) * complex_wrhs(k + 1, j, i, n);
-          }
-        });
+    tri_solver.solve(complex_wrhs);
 
     parallel_for(
         "Compute vhat",
-        Bounds<4>(primal_topology.ni, primal_topology.n_cells_y,
-                  {0, (nxf - 1) / 2}, primal_topology.nens),
+        SimpleBounds<4>(primal_topology.ni, nyc, nxc, primal_topology.nens),
         YAKL_LAMBDA(int k, int j, int i, int n) {
+          const int jy = spectral_mode_y(j, spec_j_beg, ny_glob);
+          if (jy < 0) {
+            return;
+          }
+          const int ix = i + spec_i_beg / 2;
           complex w_kp1;
           if (k < primal_topology.ni - 1) {
             w_kp1 = complex_wrhs(k, j, i, n);
@@ -3288,38 +3367,73 @@ public:
 
           real gamma_fac_kp1 = rho_di(0, k + dks + 1, n) *
                                H01_coeff(primal_geometry, dual_geometry, pis,
-                                         pjs, pks, i, j, k + 1, n);
+                                         pjs, pks, ix, jy, k + 1, n);
           real gamma_fac_k =
               rho_di(0, k + dks, n) * H01_coeff(primal_geometry, dual_geometry,
-                                                pis, pjs, pks, i, j, k, n);
+                                                pis, pjs, pks, ix, jy, k, n);
 
-          complex_vrhs(k, j, i, n) *= complex_vcoeff(0, k, j, i, n);
-          for (int d1 = 0; d1 < VS::ndensity_dycore; ++d1) {
-            complex_vrhs(k, j, i, n) +=
-                complex_vcoeff(1 + d1, k, j, i, n) *
-                (gamma_fac_kp1 * q_di(d1, k + dks + 1, n) * w_kp1 -
-                 gamma_fac_k * q_di(d1, k + dks, n) * w_k);
+          SArray<complex, 1, ndims> fD0;
+          fourier_cwD0(fD0, 1, ix, jy, k, nx_glob, ny_glob, dual_topology.ni);
+          SArray<complex, 1, ndims> fDnm1bar;
+          fourier_cwDnm1bar(fDnm1bar, 1, ix, jy, k, nx_glob, ny_glob,
+                            dual_topology.ni);
+          SArray<real, 1, ndims> fH1;
+          fourier_H10<diff_ord>(fH1, primal_geometry, dual_geometry, pis, pjs,
+                                pks, ix, jy, k, 0, nx_glob, ny_glob,
+                                dual_topology.ni);
+
+          SArray<complex, 1, ndims> vhat;
+          if (ndims == 1) {
+            vhat(0) =
+                complex_vcoeff(0, k, j, i, n) * complex_vrhs(0, k, j, i, n);
+          } else {
+            complex div_vrhs = 0;
+            for (int d = 0; d < ndims; ++d) {
+              div_vrhs += fDnm1bar(d) * fH1(d) * complex_vrhs(d, k, j, i, n);
+            }
+            for (int d = 0; d < ndims; ++d) {
+              vhat(d) = complex_vrhs(d, k, j, i, n) +
+                        vdiv_coeff(k, j, i, n) * fD0(d) * div_vrhs;
+            }
+          }
+
+          for (int d = 0; d < ndims; ++d) {
+            for (int d1 = 0; d1 < VS::ndensity_dycore; ++d1) {
+              vhat(d) +=
+                  complex_vcoeff(1 + d1 + d * VS::ndensity_dycore, k, j, i, n) *
+                  (gamma_fac_kp1 * q_di(d1, k + dks + 1, n) * w_kp1 -
+                   gamma_fac_k * q_di(d1, k + dks, n) * w_k);
+            }
+            complex_vrhs(d, k, j, i, n) = vhat(d);
           }
         });
 
     parallel_for(
         "Complex solution to real",
-        yakl::c::Bounds<4>(primal_topology.ni, primal_topology.n_cells_y,
-                           {0, nxf - 1, 2}, primal_topology.nens),
-        YAKL_LAMBDA(int k, int j, int i, int n) {
-          v_transform(k, j, i, n) = complex_vrhs(k, j, i / 2, n).real();
-          v_transform(k, j, i + 1, n) = complex_vrhs(k, j, i / 2, n).imag();
+        SimpleBounds<4>(primal_topology.ni, ny_pairs, nxc,
+                        primal_topology.nens),
+        YAKL_LAMBDA(int k, int jp, int i, int n) {
+          const int j = ndims > 1 ? 2 * jp : jp;
+          // rows of self-mirrored modes are not solved for
+          const int jm =
+              (ndims > 1 && spectral_mode_y(j + 1, spec_j_beg, ny_glob) >= 0)
+                  ? j + 1
+                  : j;
+          for (int d = 0; d < ndims; ++d) {
+            set_fourier_coeffs(v_transform, d, k, jp, i, n,
+                               complex_vrhs(d, k, j, i, n),
+                               complex_vrhs(d, k, jm, i, n));
+          }
           if (k < primal_topology.nl) {
-            w_transform(k, j, i, n) = complex_wrhs(k, j, i / 2, n).real();
-            w_transform(k, j, i + 1, n) = complex_wrhs(k, j, i / 2, n).imag();
+            set_fourier_coeffs(w_transform, 0, k, jp, i, n,
+                               complex_wrhs(k, j, i, n),
+                               complex_wrhs(k, jm, i, n));
           }
         });
 
     yakl::timer_start("ffts");
-    fftv_x.inverse_real(v_transform);
-    fftw_x.inverse_real(w_transform);
-    // fftv_y.inverse_real(v_transform);
-    // fftw_y.inverse_real(w_transform);
+    fftv.inverse_real();
+    fftw.inverse_real();
     yakl::timer_stop("ffts");
 
     parallel_for(
@@ -3327,9 +3441,13 @@ public:
         SimpleBounds<4>(primal_topology.ni, primal_topology.n_cells_y,
                         primal_topology.n_cells_x, primal_topology.nens),
         YAKL_LAMBDA(int k, int j, int i, int n) {
-          sol_v(0, k + pks, j + pjs, i + pis, n) = v_transform(k, j, i, n);
+          for (int d = 0; d < ndims; ++d) {
+            sol_v(d, k + pks, j + pjs, i + pis, n) =
+                v_transform(d, k, j, i, n);
+          }
           if (k < primal_topology.nl) {
-            sol_w(0, k + pks, j + pjs, i + pis, n) = w_transform(k, j, i, n);
+            sol_w(0, k + pks, j + pjs, i + pis, n) =
+                w_transform(0, k, j, i, n);
           }
         });
 
@@ -3347,7 +3465,10 @@ public:
           compute_H10<1, diff_ord>(u, sol_v, primal_geometry, dual_geometry,
                                    dis, djs, dks, i, j, k, n);
 
-          fvar(0, k + dks, j + djs, i + dis, n) = u(0) * rho_pi(0, k + pks, n);
+          for (int d = 0; d < ndims; ++d) {
+            fvar(d, k + dks, j + djs, i + dis, n) =
+                u(d) * rho_pi(0, k + pks, n);
+          }
 
           if (k < dual_topology.ni - 2) {
             const real uw = compute_H01(sol_w, primal_geometry, dual_geometry,
@@ -3385,9 +3506,25 @@ public:
 class ModelStats : public Stats {
   using VS = VariableSet;
 
+  static constexpr int npv = ndims > 1 ? 3 : 1;
+  // layout of the packed per-point values, sums first and then maxima
+  static constexpr int MASS_SLOT = 0;
+  static constexpr int ENERGY_SLOT = MASS_SLOT + VS::ndensity_prognostic;
+  static constexpr int PV_SLOT = ENERGY_SLOT + 4;
+  static constexpr int PENS_SLOT = PV_SLOT + npv;
+  static constexpr int nsum = PENS_SLOT + 1;
+  static constexpr int DENSMAX_SLOT = 0;
+  static constexpr int DENSMIN_SLOT = DENSMAX_SLOT + VS::ndensity_prognostic;
+  static constexpr int nmax = DENSMIN_SLOT + VS::ndensity_prognostic;
+
 public:
-  real3d TEarr, KEarr, PEarr, IEarr, PENSarr, trimmed_density;
-  real4d PVarr;
+  // the columns are split into nchunk chunks of chunk columns each, partial
+  // holds the reduction of every chunk of every level, minima are stored
+  // negated
+  int chunk, nchunk;
+  real4d partial;
+  real2d local_stats;
+  realHost1d local_sums, local_maxs, global_sums, global_maxs;
 
   void initialize(ModelParameters &params, Parallel &par,
                   const Geometry<Straight> &primal_geom,
@@ -3404,28 +3541,26 @@ public:
                                             this->masterproc);
     this->stats_arr[ESTAT].initialize("energy", 4, this->statsize, this->nens,
                                       this->masterproc);
-    this->stats_arr[PVSTAT].initialize("pv", ndims > 1 ? 3 : 1, this->statsize,
-                                       this->nens, this->masterproc);
+    this->stats_arr[PVSTAT].initialize("pv", npv, this->statsize, this->nens,
+                                       this->masterproc);
     this->stats_arr[PESTAT].initialize("pens", 1, this->statsize, this->nens,
                                        this->masterproc);
 
     const auto &primal_topology = primal_geometry.topology;
     const auto &dual_topology = dual_geometry.topology;
 
-    TEarr = real3d("TE", dual_topology.nl, dual_topology.n_cells_y,
-                   dual_topology.n_cells_x);
-    KEarr = real3d("KE", dual_topology.nl, dual_topology.n_cells_y,
-                   dual_topology.n_cells_x);
-    IEarr = real3d("IE", dual_topology.nl, dual_topology.n_cells_y,
-                   dual_topology.n_cells_x);
-    PEarr = real3d("PE", dual_topology.nl, dual_topology.n_cells_y,
-                   dual_topology.n_cells_x);
-    PVarr = real4d("PV", ndims > 1 ? 3 : 1, primal_topology.nl,
-                   primal_topology.n_cells_y, primal_topology.n_cells_x);
-    PENSarr = real3d("PENS", primal_topology.nl, primal_topology.n_cells_y,
-                     primal_topology.n_cells_x);
-    trimmed_density = real3d("trimmed_density", dual_topology.nl,
-                             dual_topology.n_cells_y, dual_topology.n_cells_x);
+    const int nlev = std::max(primal_topology.nl, dual_topology.nl);
+    const int ncol = dual_topology.n_cells_y * dual_topology.n_cells_x;
+    chunk = std::max(1, static_cast<int>(std::ceil(std::sqrt(ncol))));
+    nchunk = (ncol + chunk - 1) / chunk;
+    // levels that a field does not have stay zero
+    partial = real4d("stats partial", nsum + nmax, nlev, nchunk, nens);
+    yakl::memset(partial, 0);
+    local_stats = real2d("stats local", nsum + nmax, nens);
+    local_sums = realHost1d("stats local sums", nsum * nens);
+    local_maxs = realHost1d("stats local maxs", nmax * nens);
+    global_sums = realHost1d("stats global sums", nsum * nens);
+    global_maxs = realHost1d("stats global maxs", nmax * nens);
   }
 
   void compute(FieldSet<nprognostic> &progvars, FieldSet<nconstant> &constvars,
@@ -3434,213 +3569,188 @@ public:
     const auto &primal_topology = primal_geometry.topology;
     const auto &dual_topology = dual_geometry.topology;
 
-    for (int n = 0; n < nens; n++) {
-
-      SArray<real, 1, VS::ndensity_prognostic> masslocal, massglobal;
-      SArray<real, 1, VS::ndensity_prognostic> densmaxlocal, densmaxglobal;
-      SArray<real, 1, VS::ndensity_prognostic> densminlocal, densminglobal;
-      SArray<real, 1, (ndims > 1 ? 3 : 1)> pvlocal, pvglobal;
-      SArray<real, 1, 4> elocal, eglobal;
-      SArray<real, 1, 1> pelocal, peglobal;
-
-      pvlocal(0) = 0.;
-      pvglobal(0) = 0.;
-      pelocal(0) = 0.;
-      peglobal(0) = 0.;
-      elocal(0) = 0.;
-      elocal(1) = 0.;
-      elocal(2) = 0.;
-      elocal(3) = 0.;
-      eglobal(0) = 0.;
-      eglobal(1) = 0.;
-      eglobal(2) = 0.;
-      eglobal(3) = 0.;
-      for (int l = 0; l < VS::ndensity_prognostic; l++) {
-        masslocal(l) = 0.;
-        massglobal(l) = 0.;
-      }
-      for (int l = 0; l < VS::ndensity_prognostic; l++) {
-        densmaxlocal(l) = 0.;
-        densmaxglobal(l) = 0.;
-      }
-      for (int l = 0; l < VS::ndensity_prognostic; l++) {
-        densminlocal(l) = 0.;
-        densminglobal(l) = 0.;
-      }
+    const int dis = dual_topology.is;
+    const int djs = dual_topology.js;
+    const int dks = dual_topology.ks;
+    const int pis = primal_topology.is;
+    const int pjs = primal_topology.js;
+    const int pks = primal_topology.ks;
+    const int dnl = dual_topology.nl;
+    const int pnl = primal_topology.nl;
 
-      int dis = dual_topology.is;
-      int djs = dual_topology.js;
-      int dks = dual_topology.ks;
+    const auto &densvar = progvars.fields_arr[DENSVAR].data;
+    const auto &vvar = progvars.fields_arr[VVAR].data;
+    const auto &wvar = progvars.fields_arr[WVAR].data;
+    const auto &hsvar = constvars.fields_arr[HSVAR].data;
+    const auto &coriolishzvar = constvars.fields_arr[CORIOLISHZVAR].data;
+    const auto &coriolisxyvar = constvars.fields_arr[CORIOLISXYVAR].data;
 
-      YAKL_SCOPE(Hk, equations->Hk);
-      YAKL_SCOPE(Hs, equations->Hs);
-      parallel_for(
-          "Compute energetics stats",
-          SimpleBounds<3>(dual_topology.nl - 2, dual_topology.n_cells_y,
-                          dual_topology.n_cells_x),
-          YAKL_CLASS_LAMBDA(int k, int j, int i) {
-            real KE, PE, IE;
-            KE = Hk.compute_KE(progvars.fields_arr[VVAR].data,
-                               progvars.fields_arr[WVAR].data,
-                               progvars.fields_arr[DENSVAR].data, dis, djs, dks,
-                               i, j, k + 1, n);
-            PE = Hs.compute_PE(progvars.fields_arr[DENSVAR].data,
-                               constvars.fields_arr[HSVAR].data, dis, djs, dks,
-                               i, j, k + 1, n);
-            IE = Hs.compute_IE(progvars.fields_arr[DENSVAR].data, dis, djs, dks,
-                               i, j, k + 1, n);
-            TEarr(k + 1, j, i) = KE + PE + IE;
-            KEarr(k + 1, j, i) = KE;
-            PEarr(k + 1, j, i) = PE;
-            IEarr(k + 1, j, i) = IE;
-          });
-      parallel_for(
-          "Compute energetics stats bnd",
-          SimpleBounds<2>(dual_topology.n_cells_y, dual_topology.n_cells_x),
-          YAKL_CLASS_LAMBDA(int j, int i) {
-            real KE, PE, IE;
-            KE = Hk.compute_KE_bottom(
-                progvars.fields_arr[VVAR].data, progvars.fields_arr[WVAR].data,
-                progvars.fields_arr[DENSVAR].data, dis, djs, dks, i, j, 0, n);
-            PE = Hs.compute_PE(progvars.fields_arr[DENSVAR].data,
-                               constvars.fields_arr[HSVAR].data, dis, djs, dks,
-                               i, j, 0, n);
-            IE = Hs.compute_IE(progvars.fields_arr[DENSVAR].data, dis, djs, dks,
-                               i, j, 0, n);
-            TEarr(0, j, i) = KE + PE + IE;
-            KEarr(0, j, i) = KE;
-            PEarr(0, j, i) = PE;
-            IEarr(0, j, i) = IE;
-            KE = Hk.compute_KE_top(progvars.fields_arr[VVAR].data,
-                                   progvars.fields_arr[WVAR].data,
-                                   progvars.fields_arr[DENSVAR].data, dis, djs,
-                                   dks, i, j, dual_topology.nl - 1, n);
-            PE = Hs.compute_PE(progvars.fields_arr[DENSVAR].data,
-                               constvars.fields_arr[HSVAR].data, dis, djs, dks,
-                               i, j, dual_topology.nl - 1, n);
-            IE = Hs.compute_IE(progvars.fields_arr[DENSVAR].data, dis, djs, dks,
-                               i, j, dual_topology.nl - 1, n);
-            TEarr(dual_topology.nl - 1, j, i) = KE + PE + IE;
-            KEarr(dual_topology.nl - 1, j, i) = KE;
-            PEarr(dual_topology.nl - 1, j, i) = PE;
-            IEarr(dual_topology.nl - 1, j, i) = IE;
-          });
+    YAKL_SCOPE(Hk, equations->Hk);
+    YAKL_SCOPE(Hs, equations->Hs);
+    YAKL_SCOPE(PVPE, equations->PVPE);
+    YAKL_SCOPE(partial, this->partial);
+    YAKL_SCOPE(local_stats, this->local_stats);
+
+    // Each thread reduces one chunk of columns of one level in a fixed order,
+    // so only the small partial array is written and the result does not
+    // depend on thread scheduling. Adjacent threads handle adjacent ensembles
+    const int nx = dual_topology.n_cells_x;
+    const int ncol = dual_topology.n_cells_y * nx;
+    const int chunk = this->chunk;
+    const int nchunk = this->nchunk;
+    const int nlev = partial.extent(1);
 
-      elocal(0) = yakl::intrinsics::sum(TEarr);
-      elocal(1) = yakl::intrinsics::sum(KEarr);
-      elocal(2) = yakl::intrinsics::sum(PEarr);
-      elocal(3) = yakl::intrinsics::sum(IEarr);
+    parallel_for(
+        "Compute energetics and density stats",
+        SimpleBounds<3>(dnl, nchunk, dual_topology.nens),
+        YAKL_LAMBDA(int k, int c, int n) {
+          real KE_sum = 0;
+          real PE_sum = 0;
+          real IE_sum = 0;
+          SArray<real, 1, VS::ndensity_prognostic> mass, densmax, densmin;
+          const int beg = c * chunk;
+          for (int l = 0; l < VS::ndensity_prognostic; l++) {
+            const real dens =
+                densvar(l, k + dks, beg / nx + djs, beg % nx + dis, n);
+            mass(l) = 0;
+            densmax(l) = dens;
+            densmin(l) = -dens;
+          }
+          const int end = (c + 1) * chunk < ncol ? (c + 1) * chunk : ncol;
+          for (int col = beg; col < end; ++col) {
+            const int j = col / nx;
+            const int i = col % nx;
+            real KE;
+            if (k == 0) {
+              KE = Hk.compute_KE_bottom(vvar, wvar, densvar, dis, djs, dks, i,
+                                        j, k, n);
+            } else if (k == dnl - 1) {
+              KE = Hk.compute_KE_top(vvar, wvar, densvar, dis, djs, dks, i, j,
+                                     k, n);
+            } else {
+              KE = Hk.compute_KE(vvar, wvar, densvar, dis, djs, dks, i, j, k,
+                                 n);
+            }
+            KE_sum += KE;
+            PE_sum += Hs.compute_PE(densvar, hsvar, dis, djs, dks, i, j, k, n);
+            IE_sum += Hs.compute_IE(densvar, dis, djs, dks, i, j, k, n);
 
-      int pis = primal_topology.is;
-      int pjs = primal_topology.js;
-      int pks = primal_topology.ks;
+            for (int l = 0; l < VS::ndensity_prognostic; l++) {
+              const real dens = densvar(l, k + dks, j + djs, i + dis, n);
+              mass(l) += dens;
+              densmax(l) = fmax(densmax(l), dens);
+              densmin(l) = fmax(densmin(l), -dens);
+            }
+          }
+          partial(ENERGY_SLOT + 0, k, c, n) = KE_sum + PE_sum + IE_sum;
+          partial(ENERGY_SLOT + 1, k, c, n) = KE_sum;
+          partial(ENERGY_SLOT + 2, k, c, n) = PE_sum;
+          partial(ENERGY_SLOT + 3, k, c, n) = IE_sum;
+          for (int l = 0; l < VS::ndensity_prognostic; l++) {
+            partial(MASS_SLOT + l, k, c, n) = mass(l);
+            partial(nsum + DENSMAX_SLOT + l, k, c, n) = densmax(l);
+            partial(nsum + DENSMIN_SLOT + l, k, c, n) = densmin(l);
+          }
+        });
 
-      YAKL_SCOPE(PVPE, equations->PVPE);
-      parallel_for(
-          "Compute PV/PE stats",
-          SimpleBounds<3>(primal_topology.nl - 2, primal_topology.n_cells_y,
-                          primal_topology.n_cells_x),
-          YAKL_CLASS_LAMBDA(int k, int j, int i) {
+    parallel_for(
+        "Compute PV/PE stats",
+        SimpleBounds<3>(pnl, nchunk, primal_topology.nens),
+        YAKL_LAMBDA(int k, int c, int n) {
+          SArray<real, 1, npv> pv_sum;
+          for (int d = 0; d < npv; ++d) {
+            pv_sum(d) = 0;
+          }
+          real pe_sum = 0;
+          const int end = (c + 1) * chunk < ncol ? (c + 1) * chunk : ncol;
+          for (int col = c * chunk; col < end; ++col) {
+            const int j = col / nx;
+            const int i = col % nx;
             pvpe_extruded vals_pvpe;
-            vals_pvpe = PVPE.compute_PVPE(
-                progvars.fields_arr[VVAR].data, progvars.fields_arr[WVAR].data,
-                progvars.fields_arr[DENSVAR].data,
-                constvars.fields_arr[CORIOLISHZVAR].data,
-                constvars.fields_arr[CORIOLISXYVAR].data, pis, pjs, pks, i, j,
-                k + 1, n);
-
-            for (int d = 0; d < (ndims > 1 ? 3 : 1); ++d) {
-              PVarr(d, k + 1, j, i) = vals_pvpe.pv(d);
+            if (k == 0) {
+              vals_pvpe = PVPE.compute_PVPE_bottom(vvar, wvar, densvar,
+                                                   coriolishzvar, coriolisxyvar,
+                                                   pis, pjs, pks, i, j, k, n);
+            } else if (k == pnl - 1) {
+              vals_pvpe = PVPE.compute_PVPE_top(vvar, wvar, densvar,
+                                                coriolishzvar, coriolisxyvar,
+                                                pis, pjs, pks, i, j, k, n);
+            } else {
+              vals_pvpe =
+                  PVPE.compute_PVPE(vvar, wvar, densvar, coriolishzvar,
+                                    coriolisxyvar, pis, pjs, pks, i, j, k, n);
             }
-            PENSarr(k + 1, j, i) = vals_pvpe.pe;
-          });
-      parallel_for(
-          "Compute PV/PE stats bnd",
-          SimpleBounds<2>(primal_topology.n_cells_y, primal_topology.n_cells_x),
-          YAKL_CLASS_LAMBDA(int j, int i) {
-            pvpe_extruded vals_pvpe;
-            vals_pvpe = PVPE.compute_PVPE_bottom(
-                progvars.fields_arr[VVAR].data, progvars.fields_arr[WVAR].data,
-                progvars.fields_arr[DENSVAR].data,
-                constvars.fields_arr[CORIOLISHZVAR].data,
-                constvars.fields_arr[CORIOLISXYVAR].data, pis, pjs, pks, i, j,
-                0, n);
-            for (int d = 0; d < (ndims > 1 ? 3 : 1); ++d) {
-              PVarr(d, 0, j, i) = vals_pvpe.pv(d);
+            for (int d = 0; d < npv; ++d) {
+              pv_sum(d) += vals_pvpe.pv(d);
             }
-            PENSarr(0, j, i) = vals_pvpe.pe;
-            vals_pvpe = PVPE.compute_PVPE_top(
-                progvars.fields_arr[VVAR].data, progvars.fields_arr[WVAR].data,
-                progvars.fields_arr[DENSVAR].data,
-                constvars.fields_arr[CORIOLISHZVAR].data,
-                constvars.fields_arr[CORIOLISXYVAR].data, pis, pjs, pks, i, j,
-                primal_topology.nl - 1, n);
-            for (int d = 0; d < (ndims > 1 ? 3 : 1); ++d) {
-              PVarr(d, primal_topology.nl - 1, j, i) = vals_pvpe.pv(d);
+            pe_sum += vals_pvpe.pe;
+          }
+          for (int d = 0; d < npv; ++d) {
+            partial(PV_SLOT + d, k, c, n) = pv_sum(d);
+          }
+          partial(PENS_SLOT, k, c, n) = pe_sum;
+        });
+
+    parallel_for(
+        "Reduce stats chunks", SimpleBounds<2>(nsum + nmax, nens),
+        YAKL_LAMBDA(int s, int n) {
+          real acc = partial(s, 0, 0, n);
+          if (s < nsum) {
+            acc = 0;
+            for (int k = 0; k < nlev; ++k) {
+              for (int c = 0; c < nchunk; ++c) {
+                acc += partial(s, k, c, n);
+              }
             }
-            PENSarr(primal_topology.nl - 1, j, i) = vals_pvpe.pe;
-          });
+          } else {
+            for (int k = 0; k < dnl; ++k) {
+              for (int c = 0; c < nchunk; ++c) {
+                acc = fmax(acc, partial(s, k, c, n));
+              }
+            }
+          }
+          local_stats(s, n) = acc;
+        });
 
-      pvlocal(0) = yakl::intrinsics::sum(
-          PVarr.slice<3>(0, yakl::COLON, yakl::COLON, yakl::COLON));
-      if (ndims > 1) {
-        pvlocal(1) = yakl::intrinsics::sum(
-            PVarr.slice<3>(1, yakl::COLON, yakl::COLON, yakl::COLON));
-        pvlocal(2) = yakl::intrinsics::sum(
-            PVarr.slice<3>(2, yakl::COLON, yakl::COLON, yakl::COLON));
+    auto local_stats_host = local_stats.createHostCopy();
+    for (int n = 0; n < nens; n++) {
+      for (int s = 0; s < nsum; s++) {
+        local_sums(s + nsum * n) = local_stats_host(s, n);
       }
-      pelocal(0) = yakl::intrinsics::sum(PENSarr);
-
-      for (int l = 0; l < VS::ndensity_prognostic; l++) {
-        parallel_for(
-            "Compute trimmed density",
-            SimpleBounds<3>(dual_topology.nl, dual_topology.n_cells_y,
-                            dual_topology.n_cells_x),
-            YAKL_CLASS_LAMBDA(int k, int j, int i) {
-              trimmed_density(k, j, i) = progvars.fields_arr[DENSVAR].data(
-                  l, k + dks, j + djs, i + dis, n);
-            });
-
-        masslocal(l) = yakl::intrinsics::sum(trimmed_density);
-        densmaxlocal(l) = yakl::intrinsics::maxval(trimmed_density);
-        densminlocal(l) = yakl::intrinsics::minval(trimmed_density);
+      for (int s = 0; s < nmax; s++) {
+        local_maxs(s + nmax * n) = local_stats_host(nsum + s, n);
       }
+    }
 
-      // MPI sum/min/max
-      this->ierr = MPI_Ireduce(&masslocal, &massglobal, VS::ndensity_prognostic,
-                               PAMC_MPI_REAL, MPI_SUM, 0, MPI_COMM_WORLD,
-                               &this->Req[DENSSTAT]);
-      this->ierr = MPI_Ireduce(&densmaxlocal, &densmaxglobal,
-                               VS::ndensity_prognostic, PAMC_MPI_REAL, MPI_MAX,
-                               0, MPI_COMM_WORLD, &this->Req[DENSMAXSTAT]);
-      this->ierr = MPI_Ireduce(&densminlocal, &densminglobal,
-                               VS::ndensity_prognostic, PAMC_MPI_REAL, MPI_MIN,
-                               0, MPI_COMM_WORLD, &this->Req[DENSMINSTAT]);
-      this->ierr =
-          MPI_Ireduce(&pvlocal, &pvglobal, ndims > 1 ? 3 : 1, PAMC_MPI_REAL,
-                      MPI_SUM, 0, MPI_COMM_WORLD, &this->Req[PVSTAT]);
-      this->ierr = MPI_Ireduce(&pelocal, &peglobal, 1, PAMC_MPI_REAL, MPI_SUM,
-                               0, MPI_COMM_WORLD, &this->Req[PESTAT]);
-      this->ierr = MPI_Ireduce(&elocal, &eglobal, 4, PAMC_MPI_REAL, MPI_SUM, 0,
-                               MPI_COMM_WORLD, &this->Req[ESTAT]);
-
-      this->ierr = MPI_Waitall(nstats, this->Req, this->Status);
-
-      if (masterproc) {
+    // sums and maxima of all ensembles go out in one reduction each
+    this->ierr =
+        MPI_Ireduce(local_sums.data(), global_sums.data(), nsum * nens,
+                    PAMC_MPI_REAL, MPI_SUM, 0, MPI_COMM_WORLD, &this->Req[0]);
+    this->ierr =
+        MPI_Ireduce(local_maxs.data(), global_maxs.data(), nmax * nens,
+                    PAMC_MPI_REAL, MPI_MAX, 0, MPI_COMM_WORLD, &this->Req[1]);
+    this->ierr = MPI_Waitall(2, this->Req, this->Status);
+
+    if (masterproc) {
+      for (int n = 0; n < nens; n++) {
         for (int l = 0; l < VS::ndensity_prognostic; l++) {
-          this->stats_arr[DENSSTAT].data(l, tind, n) = massglobal(l);
-          this->stats_arr[DENSMAXSTAT].data(l, tind, n) = densmaxglobal(l);
-          this->stats_arr[DENSMINSTAT].data(l, tind, n) = densminglobal(l);
+          this->stats_arr[DENSSTAT].data(l, tind, n) =
+              global_sums(MASS_SLOT + l + nsum * n);
+          this->stats_arr[DENSMAXSTAT].data(l, tind, n) =
+              global_maxs(DENSMAX_SLOT + l + nmax * n);
+          this->stats_arr[DENSMINSTAT].data(l, tind, n) =
+              -global_maxs(DENSMIN_SLOT + l + nmax * n);
         }
-
-        this->stats_arr[ESTAT].data(0, tind, n) = eglobal(0);
-        this->stats_arr[ESTAT].data(1, tind, n) = eglobal(1);
-        this->stats_arr[ESTAT].data(2, tind, n) = eglobal(2);
-        this->stats_arr[ESTAT].data(3, tind, n) = eglobal(3);
-        for (int d = 0; d < (ndims > 1 ? 3 : 1); ++d) {
-          this->stats_arr[PVSTAT].data(d, tind, n) = pvglobal(d);
+        for (int e = 0; e < 4; ++e) {
+          this->stats_arr[ESTAT].data(e, tind, n) =
+              global_sums(ENERGY_SLOT + e + nsum * n);
+        }
+        for (int d = 0; d < npv; ++d) {
+          this->stats_arr[PVSTAT].data(d, tind, n) =
+              global_sums(PV_SLOT + d + nsum * n);
         }
-        this->stats_arr[PESTAT].data(0, tind, n) = peglobal(0);
+        this->stats_arr[PESTAT].data(0, tind, n) =
+            global_sums(PENS_SLOT + nsum * n);
       }
     }
   }
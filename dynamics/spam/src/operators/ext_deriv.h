@@ -952,6 +952,23 @@ complex YAKL_INLINE fourier_Dnm1bar(const real c, int i, int j, int k, int nx,
   return Dnm1barhat;
 }
 
+// per-direction contributions to fourier_Dnm1bar
+void YAKL_INLINE fourier_cwDnm1bar(const SArray<complex, 1, ndims> &Dnm1barhat,
+                                   const real c, int i, int j, int k, int nx,
+                                   int ny, int nz) {
+  for (int d = 0; d < ndims; d++) {
+    real fac;
+    if (d == 0) {
+      fac = (2 * pi * i) / nx;
+    }
+    if (d == 1) {
+      fac = (2 * pi * j) / ny;
+    }
+    complex im(0, 1);
+    Dnm1barhat(d) = exp(im * fac) - 1._fp;
+  }
+}
+
 void YAKL_INLINE fourier_cwD0Dnm1bar(const SArray<real, 1, ndims> &D0Dnm1barhat,
                                      const real c, int i, int j, int k, int nx,
                                      int ny, int nz) {
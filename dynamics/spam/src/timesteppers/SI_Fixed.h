@@ -63,7 +63,7 @@ public:
     real initial_res_norm;
     if (monitor_convergence > 0) {
       this->dx.exchange();
-      initial_res_norm = dt * norm(this->dx);
+      initial_res_norm = dt * residual_norm(this->dx);
     }
 
     if (verbosity_level > 0) {
@@ -93,7 +93,7 @@ public:
       if (monitor_convergence > 1) {
         this->xm.waxpbypcz(1, -1, dt, this->xn, *this->x, this->dx);
         this->xm.exchange();
-        res_norm = norm(xm);
+        res_norm = residual_norm(xm);
 
         if (res_norm / initial_res_norm < this->tol) {
           converged = true;
@@ -118,7 +118,7 @@ public:
 
       this->xm.waxpbypcz(1, -1, dt, this->xn, *this->x, this->dx);
       this->xm.exchange();
-      res_norm = norm(xm);
+      res_norm = residual_norm(xm);
 
       if (res_norm / initial_res_norm < this->tol) {
         converged = true;
@@ -54,7 +54,7 @@ public:
     real res_norm;
     real initial_res_norm;
     if (monitor_convergence > 0) {
-      res_norm = norm(xm);
+      res_norm = residual_norm(xm);
       initial_res_norm = res_norm;
     }
 
@@ -90,13 +90,16 @@ public:
                                          *this->auxiliary_vars, this->dx,
                                          ADD_MODE::REPLACE);
 
-      // store residual in xm
-      this->xm.waxpbypcz(-1, 1, -dt, this->xn, *this->x, this->dx);
-      this->xm.exchange();
-
+      // store residual in xm, computing its norm in the same kernel if needed
       if (monitor_convergence > 1) {
-        res_norm = norm(xm);
+        real local_norm = this->xm.waxpbypcz_local_norm(
+            -1, 1, -dt, this->xn, *this->x, this->dx, this->norm_type,
+            this->norm_weights);
+        res_norm = global_norm(local_norm, this->norm_type);
+      } else {
+        this->xm.waxpbypcz(-1, 1, -dt, this->xn, *this->x, this->dx);
       }
+      this->xm.exchange();
 
       iter++;
 
@@ -114,7 +117,7 @@ public:
     this->avg_iters /= step;
 
     if (verbosity_level >= 1) {
-      res_norm = norm(xm);
+      res_norm = residual_norm(xm);
       if (res_norm / initial_res_norm < this->tol) {
         converged = true;
       }
@@ -6,14 +6,66 @@
 
 namespace pamc {
 
-real norm(FieldSet<nprognostic> &x) {
-  // note that this function assumes that x halos have been exchanged
-  real accum = 0;
-  for (auto f : x.fields_arr) {
-    accum = std::max(yakl::intrinsics::maxval(yakl::intrinsics::abs(f.data)),
-                     accum);
+// Combines the local parts of a norm (see FieldSet::local_norm) computed by
+// every process into the global norm, using a single reduction
+real global_norm(real local_norm, NORM_TYPE type) {
+  real result;
+  MPI_Allreduce(&local_norm, &result, 1, PAMC_MPI_REAL,
+                type == NORM_TYPE::MAX ? MPI_MAX : MPI_SUM, MPI_COMM_WORLD);
+  return type == NORM_TYPE::MAX ? result : std::sqrt(result);
+}
+
+// Global norm of x over the interior of all fields and processes. The result
+// does not depend on the domain decomposition
+real norm(const FieldSet<nprognostic> &x, NORM_TYPE type,
+          const SArray<real, 1, nprognostic> &weights) {
+  return global_norm(x.local_norm(type, weights), type);
+}
+
+real norm(const FieldSet<nprognostic> &x) {
+  SArray<real, 1, nprognostic> weights;
+  for (int f = 0; f < nprognostic; f++) {
+    weights(f) = 1;
+  }
+  return norm(x, NORM_TYPE::MAX, weights);
+}
+
+// Field weights for norms of FieldSets shaped like x. The weighted L2 norm
+// divides each field by its global number of interior dofs, so that every field
+// contributes its mean square regardless of its size
+SArray<real, 1, nprognostic> norm_weights(const FieldSet<nprognostic> &x,
+                                          NORM_TYPE type) {
+  SArray<real, 1, nprognostic> weights;
+  for (int f = 0; f < nprognostic; f++) {
+    weights(f) = 1;
+  }
+  if (type == NORM_TYPE::WEIGHTED_L2) {
+    const auto &layout = x.layout;
+    real local_count[nprognostic];
+    real global_count[nprognostic];
+    for (int f = 0; f < nprognostic; f++) {
+      local_count[f] = real(layout.row_offsets(f + 1) - layout.row_offsets(f)) *
+                       layout.n_cells_y * layout.n_cells_x * layout.nens;
+    }
+    MPI_Allreduce(local_count, global_count, nprognostic, PAMC_MPI_REAL,
+                  MPI_SUM, MPI_COMM_WORLD);
+    for (int f = 0; f < nprognostic; f++) {
+      weights(f) = 1 / global_count[f];
+    }
+  }
+  return weights;
+}
+
+NORM_TYPE parse_norm_type(const std::string &name) {
+  if (name == "max") {
+    return NORM_TYPE::MAX;
+  } else if (name == "l2") {
+    return NORM_TYPE::L2;
+  } else if (name == "weighted_l2") {
+    return NORM_TYPE::WEIGHTED_L2;
+  } else {
+    throw std::runtime_error("Unknown norm type: " + name);
   }
-  return accum;
 }
 
 class TimeIntegrator {
@@ -63,10 +115,18 @@ public:
 
   bool two_point_discrete_gradient;
 
+  NORM_TYPE norm_type;
+  SArray<real, 1, nprognostic> norm_weights;
+
   real tol;
   std::vector<real> quad_pts;
   std::vector<real> quad_wts;
 
+  // global residual norm used to monitor convergence
+  real residual_norm(const FieldSet<nprognostic> &x) const {
+    return norm(x, this->norm_type, this->norm_weights);
+  }
+
   void compute_discrete_gradient(real dt, FieldSet<nprognostic> &xn,
                                  FieldSet<nconstant> &const_vars,
                                  FieldSet<nauxiliary> &auxiliary_vars,
@@ -103,6 +163,8 @@ public:
     this->verbosity_level = params.si_verbosity_level;
     this->max_iters = params.si_max_iters;
     this->nquad = params.si_nquad;
+    this->norm_type = parse_norm_type(params.si_norm_type);
+    this->norm_weights = pamc::norm_weights(xvars, this->norm_type);
 
     this->quad_pts.resize(nquad);
     this->quad_wts.resize(nquad);
@@ -0,0 +1,104 @@
+#include "DataManager.h"
+#include <iostream>
+#include <vector>
+
+using yakl::c::parallel_for;
+using yakl::c::SimpleBounds;
+
+using DataManager = pam::DataManager;
+using real1d = yakl::Array<double, 1, yakl::memDevice, yakl::styleC>;
+
+int constexpr n = 64;
+int constexpr nentries = 4;
+
+void fail(std::string const &msg) {
+  std::cout << "Error: " << msg << std::endl;
+  exit(-1);
+}
+
+void fill(DataManager &dm, std::string const &name, double val) {
+  auto arr = dm.get<double, 1>(name);
+  parallel_for(
+      SimpleBounds<1>(arr.extent(0)),
+      YAKL_LAMBDA(int i) { arr(i) = val + i; });
+}
+
+bool check(DataManager &dm, std::string const &name, double val) {
+  auto arr = dm.get<double, 1>(name).createHostCopy();
+  for (int i = 0; i < arr.extent(0); i++) {
+    if (arr(i) != val + i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string entry_name(int i) { return "field" + std::to_string(i); }
+
+void test_save_restore() {
+  DataManager dm;
+  dm.enable_arena(nentries * dm.get_arena_entry_bytes<double>({n}));
+  for (int i = 0; i < nentries; i++) {
+    dm.register_and_allocate<double>(entry_name(i), "", {n}, {"n"});
+    fill(dm, entry_name(i), 100 * i);
+  }
+  if (dm.get_num_slabs() != 1) {
+    fail("arena entries sized up front should fit in one slab");
+  }
+
+  std::vector<char> saved(dm.get_arena_bytes());
+  dm.arena_save(saved.data());
+
+  for (int i = 0; i < nentries; i++) {
+    fill(dm, entry_name(i), -1);
+  }
+  dm.clean_all_entries();
+  dm.arena_restore(saved.data());
+
+  for (int i = 0; i < nentries; i++) {
+    if (!check(dm, entry_name(i), 100 * i)) {
+      fail("arena_restore did not reproduce " + entry_name(i));
+    }
+    if (!dm.entry_is_dirty(entry_name(i))) {
+      fail("arena_restore should mark " + entry_name(i) + " dirty");
+    }
+  }
+}
+
+void test_range_reuse() {
+  DataManager dm;
+  dm.enable_arena(nentries * dm.get_arena_entry_bytes<double>({n}));
+  std::vector<double *> ptrs;
+  for (int i = 0; i < nentries; i++) {
+    dm.register_and_allocate<double>(entry_name(i), "", {n}, {"n"});
+    ptrs.push_back(dm.get<double, 1>(entry_name(i)).data());
+  }
+
+  // A freed range is reused by a registration of the same size
+  dm.unregister_and_deallocate(entry_name(1));
+  dm.register_and_allocate<double>("same_size", "", {n}, {"n"});
+  if (dm.get<double, 1>("same_size").data() != ptrs[1]) {
+    fail("same-size registration did not reuse the freed range");
+  }
+
+  // Adjacent freed ranges are merged, so a registration twice the size fits
+  dm.unregister_and_deallocate("same_size");
+  dm.unregister_and_deallocate(entry_name(2));
+  dm.register_and_allocate<double>("double_size", "", {2 * n}, {"n2"});
+  if (dm.get<double, 1>("double_size").data() != ptrs[1]) {
+    fail("double-size registration did not reuse the merged range");
+  }
+
+  if (dm.get_num_slabs() != 1) {
+    fail("reusing freed ranges should not allocate another slab");
+  }
+}
+
+int main() {
+  yakl::init();
+
+  test_save_restore();
+  test_range_reuse();
+
+  yakl::finalize();
+}
@@ -3,6 +3,9 @@
 
 #include "pam_const.h"
 #include <typeinfo>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
 
 namespace pam {
 
@@ -19,13 +22,18 @@ namespace pam {
       std::string              name;
       std::string              desc;
       size_t                   type_hash;
+      size_t                   type_size;
       void *                   ptr;
       std::vector<int>         dims;
       std::vector<std::string> dim_names;
       bool                     positive;
       bool                     dirty;
+      bool                     untracked_writes;  // Written through pointers held outside the data manager
       bool                     read_only;
       bool                     managed;
+      int                      handle;
+      int                      slab;     // Arena slab holding this entry's data, or -1 if allocated on its own
+      size_t                   offset;   // Byte offset of this entry's data within its arena slab
     };
 
     struct Dimension {
@@ -33,25 +41,63 @@ namespace pam {
       int         len;
     };
 
+    // In arena mode, managed entries are bump-allocated out of a few large slabs instead of one allocation each,
+    // so that the entire state can be checkpointed, restored, or moved with one copy per slab
+    struct Slab {
+      void   *ptr;
+      size_t  bytes;  // Allocated size of the slab
+      size_t  used;   // High-water mark of bytes handed out to entries (including alignment padding)
+      std::vector<std::pair<size_t,size_t>> free_ranges;  // {offset,bytes} below "used" freed by unregistered entries
+    };
+    static size_t constexpr arena_alignment = 256;
+
     std::vector<Entry>     entries;
     std::vector<Dimension> dimensions;
 
+    // Hashed name lookups and stable handles. Entry indices shift when an entry is unregistered, but a handle
+    // returned at registration keeps referring to the same entry until it is unregistered
+    std::unordered_map<std::string,int> entry_ids;      // entry name     -> index in entries
+    std::unordered_map<std::string,int> dimension_ids;  // dimension name -> index in dimensions
+    std::vector<int>                    handle_ids;     // handle         -> index in entries (-1 if unregistered)
+
     std::function<void *( size_t , char const * )> allocate;
     std::function<void  ( void * , char const * )> deallocate;
 
     int num_assigned_dims;
 
+    std::vector<Slab> slabs;
+    size_t            arena_slab_bytes;  // Size of the first slab. Zero means arena mode is off
+
 
     DataManagerTemplate() {
       entries    = std::vector<Entry>();
       dimensions = std::vector<Dimension>();
       num_assigned_dims = 0;
+      slabs      = std::vector<Slab>();
+      arena_slab_bytes = 0;
       if (memSpace == memDevice) {
         allocate   = [] (size_t bytes,char const *label) -> void * { return yakl::alloc_device(bytes,label); };
         deallocate = [] (void *ptr   ,char const *label)           {        yakl::free_device (ptr  ,label); };
       } else if (memSpace == memHost) {
-        allocate   = [] (size_t bytes,char const *label) -> void * { return ::malloc(bytes); };
-        deallocate = [] (void *ptr   ,char const *label)           {        ::free  (ptr  ); };
+        // Page-locked host memory lets host<->device copies run asynchronously and at full bandwidth
+        #if defined(YAKL_ARCH_CUDA)
+          allocate   = [] (size_t bytes,char const *label) -> void * {
+            void *ptr;
+            if (cudaMallocHost( &ptr , bytes ) != cudaSuccess) endrun("ERROR: cudaMallocHost failed");
+            return ptr;
+          };
+          deallocate = [] (void *ptr   ,char const *label)           { cudaFreeHost( ptr ); };
+        #elif defined(YAKL_ARCH_HIP)
+          allocate   = [] (size_t bytes,char const *label) -> void * {
+            void *ptr;
+            if (hipHostMalloc( &ptr , bytes , hipHostMallocDefault ) != hipSuccess) endrun("ERROR: hipHostMalloc failed");
+            return ptr;
+          };
+          deallocate = [] (void *ptr   ,char const *label)           { hipHostFree( ptr ); };
+        #else
+          allocate   = [] (size_t bytes,char const *label) -> void * { return ::malloc(bytes); };
+          deallocate = [] (void *ptr   ,char const *label)           {        ::free  (ptr  ); };
+        #endif
       } else {
         yakl::yakl_throw("ERROR: DataManagerTemplate created with invalid memSpace template parameter");
       }
@@ -77,7 +123,7 @@ namespace pam {
         }
         return;  // Avoid adding a duplicate entry
       }
-      dimensions.push_back( {name , len} );
+      add_dimension_entry( name , len );
     }
 
 
@@ -87,8 +133,9 @@ namespace pam {
     // because many separate kernels are more expensive than one big one when data sizes are small.
     // So it's up to the user to zero out the arrays they allocate to make valgrind happy and avoid unhappy
     // irreproducible bugs.
+    // Returns a handle that can be passed to get() to skip the name lookup
     template <class T>
-    void register_and_allocate( std::string name ,
+    int register_and_allocate( std::string name ,
                                 std::string desc ,
                                 std::vector<int> dims ,
                                 std::vector<std::string> dim_names = std::vector<std::string>() ,
@@ -109,10 +156,7 @@ namespace pam {
         for (int i=0; i < dim_names.size(); i++) {
           int dimid = find_dimension(dim_names[i]);
           if (dimid == -1) {
-            Dimension loc;
-            loc.name = dim_names[i];
-            loc.len  = dims     [i];
-            dimensions.push_back(loc);
+            add_dimension_entry( dim_names[i] , dims[i] );
           } else {
             if (dimensions[dimid].len != dims[i]) {
               endrun("ERROR: Dimension already exists but has a different length");
@@ -141,21 +185,26 @@ namespace pam {
       loc.name      = name;
       loc.desc      = desc;
       loc.type_hash = get_type_hash<T>();
-      loc.ptr       = allocate( get_data_size(dims)*sizeof(T) , name.c_str() );
+      loc.type_size = sizeof(T);
+      loc.slab      = -1;
+      loc.offset    = 0;
+      loc.ptr       = allocate_entry_data( get_data_size(dims)*sizeof(T) , name.c_str() , loc.slab , loc.offset );
       loc.dims      = dims;
       loc.dim_names = dim_names;
       loc.positive  = positive;
       loc.dirty     = false;
+      loc.untracked_writes = false;
       loc.read_only = false;
       loc.managed   = true;
 
-      entries.push_back( loc );
+      return add_entry( loc );
     }
 
 
     // Register an existing allocation with the coupler. This is less safe, so use with care
+    // Returns a handle that can be passed to get() to skip the name lookup
     template <class T>
-    void register_existing( std::string name ,
+    int register_existing( std::string name ,
                             std::string desc ,
                             std::vector<int> dims ,
                             T * ptr ,
@@ -177,10 +226,7 @@ namespace pam {
         for (int i=0; i < dim_names.size(); i++) {
           int dimid = find_dimension(dim_names[i]);
           if (dimid == -1) {
-            Dimension loc;
-            loc.name = dim_names[i];
-            loc.len  = dims     [i];
-            dimensions.push_back(loc);
+            add_dimension_entry( dim_names[i] , dims[i] );
           } else {
             if (dimensions[dimid].len != dims[i]) {
               endrun("ERROR: Dimension already exists but has a different length");
@@ -209,28 +255,48 @@ namespace pam {
       loc.name      = name;
       loc.desc      = desc;
       loc.type_hash = get_type_hash<T>();
+      loc.type_size = sizeof(T);
       loc.ptr       = const_cast<typename std::remove_cv<T>::type *>(ptr);
+      loc.slab      = -1;
+      loc.offset    = 0;
       loc.dims      = dims;
       loc.dim_names = dim_names;
       loc.positive  = positive;
       loc.dirty     = false;
+      // The owner of an existing allocation can write to it at any time without going through get()
+      loc.untracked_writes = true;
       loc.read_only = std::is_const<T>::value ? true : false;
       loc.managed   = false;
 
-      entries.push_back( loc );
+      return add_entry( loc );
     }
 
 
-    void make_readonly( std::string name ) {
+    void make_readonly( std::string const &name ) {
       entries[find_entry_or_error(name)].read_only = true;
     }
 
 
     // deallocate a named entry, and erase the entry from the list
-    void unregister_and_deallocate( std::string name ) {
+    void unregister_and_deallocate( std::string const &name ) {
       int id = find_entry_or_error( name );
-      if (entries[id].managed) deallocate( entries[id].ptr , entries[id].name.c_str() );
+      if (entries[id].managed) {
+        if (entries[id].slab < 0) {
+          deallocate( entries[id].ptr , entries[id].name.c_str() );
+        } else {
+          // Return the entry's range to its slab so later registrations can reuse it
+          free_arena_range( entries[id].slab , entries[id].offset ,
+                            arena_padded_bytes( get_data_size(entries[id].dims)*entries[id].type_size ) );
+        }
+      }
+      handle_ids[entries[id].handle] = -1;
+      entry_ids.erase( entries[id].name );
       entries.erase( entries.begin() + id );
+      // Entries after the removed one have shifted down by one
+      for (int i=id; i < entries.size(); i++) {
+        entry_ids [entries[i].name  ] = i;
+        handle_ids[entries[i].handle] = i;
+      }
     }
 
 
@@ -243,18 +309,23 @@ namespace pam {
 
     // reset the dirty flag to false for a single entry
     // when the dirty flag is true, then the entry has been potentially written to since its creation or previous cleaning
-    void clean_entry( std::string name ) {
+    void clean_entry( std::string const &name ) {
       int id = find_entry_or_error( name );
       entries[id].dirty = false;
     }
 
 
-    bool is_read_only( std::string name ) { return entries[find_entry_or_error( name )].read_only; }
+    bool is_read_only( std::string const &name ) { return entries[find_entry_or_error( name )].read_only; }
+
+
+    // Mark an entry as written through a pointer held outside the data manager (e.g., by Fortran code), so its dirty
+    // flag can't be trusted. Such entries are treated as always dirty when mirroring
+    void mark_untracked_writes( std::string const &name ) { entries[find_entry_or_error( name )].untracked_writes = true; }
 
 
     // Get the dirty flag for a single entry
     // when the dirty flag is true, then the entry has been potentially written to since its creation or previous cleaning
-    bool entry_is_dirty( std::string name ) const {
+    bool entry_is_dirty( std::string const &name ) const {
       int id = find_entry_or_error( name );
       return entries[id].dirty;
     }
@@ -271,7 +342,7 @@ namespace pam {
     }
 
 
-    bool entry_exists( std::string name ) const {
+    bool entry_exists( std::string const &name ) const {
       int id = find_entry(name);
       if (id >= 0) return true;
       return false;
@@ -283,14 +354,15 @@ namespace pam {
     // T must match the registered type (const and volatile are ignored in this comparison)
     // N must match the registered number of dimensions
     template <class T, int N , typename std::enable_if< std::is_const<T>::value , int >::type = 0 >
-    Array<T,N,memSpace,styleC> get( std::string name ) const {
-      // Make sure we have this name as an entry
-      int id = find_entry_or_error( name );
-      // Make sure it's the right type and dimensionality
-      validate_type<T>(id);
-      validate_dims<N>(id);
-      Array<T,N,memSpace,styleC> ret( name.c_str() , (T *) entries[id].ptr , entries[id].dims );
-      return ret;
+    Array<T,N,memSpace,styleC> get( std::string const &name ) const {
+      return get_by_id<T,N>( find_entry_or_error( name ) );
+    }
+
+
+    // Same as get( name ), but using a handle returned at registration or by get_handle() to avoid the name lookup
+    template <class T, int N , typename std::enable_if< std::is_const<T>::value , int >::type = 0 >
+    Array<T,N,memSpace,styleC> get( int handle ) const {
+      return get_by_id<T,N>( find_handle_or_error( handle ) );
     }
 
 
@@ -299,19 +371,22 @@ namespace pam {
     // T must match the registered type (const and volatile are ignored in this comparison)
     // N must match the registered number of dimensions
     template <class T, int N , typename std::enable_if< ! std::is_const<T>::value , int >::type = 0 >
-    Array<T,N,memSpace,styleC> get( std::string name ) {
-      // Make sure we have this name as an entry
-      int id = find_entry_or_error( name );
-      if (entries[id].read_only) endrun("ERROR: Trying to get() a read-only arary without a const type");
-      entries[id].dirty = true;
-      // Make sure it's the right type and dimensionality
-      validate_type<T>(id);
-      validate_dims<N>(id);
-      Array<T,N,memSpace,styleC> ret( name.c_str() , (T *) entries[id].ptr , entries[id].dims );
-      return ret;
+    Array<T,N,memSpace,styleC> get( std::string const &name ) {
+      return get_by_id<T,N>( find_entry_or_error( name ) );
     }
 
 
+    // Same as get( name ), but using a handle returned at registration or by get_handle() to avoid the name lookup
+    template <class T, int N , typename std::enable_if< ! std::is_const<T>::value , int >::type = 0 >
+    Array<T,N,memSpace,styleC> get( int handle ) {
+      return get_by_id<T,N>( find_handle_or_error( handle ) );
+    }
+
+
+    // Get the stable handle for the entry of this name so that it can be fetched later without a name lookup
+    int get_handle( std::string const &name ) const { return entries[find_entry_or_error( name )].handle; }
+
+
     // Get a READ ONLY YAKL array (styleC) for the entry of this name
     // If T is not const, then the dirty flag is set to true because it can be potentially written to
     // T must match the registered type (const and volatile are ignored in this comparison)
@@ -319,7 +394,7 @@ namespace pam {
     // All dimensions after first dimension are assumed to be horizontal indices that can be aggregated without
     //     regard to ordering. Fastest varying dimensions in the aggregated horizontal dimensions are maintained.
     template <class T, typename std::enable_if< std::is_const<T>::value , int>::type = 0 >
-    Array<T,2,memSpace,styleC> get_lev_col( std::string name ) const {
+    Array<T,2,memSpace,styleC> get_lev_col( std::string const &name ) const {
       // Make sure we have this name as an entry
       int id = find_entry_or_error( name );
       // Make sure it's the right type
@@ -342,7 +417,7 @@ namespace pam {
     // All dimensions after first dimension are assumed to be horizontal indices that can be aggregated without
     //     regard to ordering. Fastest varying dimensions in the aggregated horizontal dimensions are maintained.
     template <class T, typename std::enable_if< ! std::is_const<T>::value , int>::type = 0 >
-    Array<T,2,memSpace,styleC> get_lev_col( std::string name ) {
+    Array<T,2,memSpace,styleC> get_lev_col( std::string const &name ) {
       // Make sure we have this name as an entry
       int id = find_entry_or_error( name );
       entries[id].dirty = true;
@@ -366,7 +441,7 @@ namespace pam {
     // All dimensions are collapsed to a single dimension.
     // Fastest varying dimensions in the aggregated dimensions are maintained.
     template <class T, typename std::enable_if< std::is_const<T>::value , int>::type = 0 >
-    Array<T,1,memSpace,styleC> get_collapsed( std::string name ) const {
+    Array<T,1,memSpace,styleC> get_collapsed( std::string const &name ) const {
       // Make sure we have this name as an entry
       int id = find_entry_or_error( name );
       // Make sure it's the right type
@@ -386,7 +461,7 @@ namespace pam {
     // All dimensions are collapsed to a single dimension.
     // Fastest varying dimensions in the aggregated dimensions are maintained.
     template <class T, typename std::enable_if< ! std::is_const<T>::value , int>::type = 0 >
-    Array<T,1,memSpace,styleC> get_collapsed( std::string name ) {
+    Array<T,1,memSpace,styleC> get_collapsed( std::string const &name ) {
       // Make sure we have this name as an entry
       int id = find_entry_or_error( name );
       entries[id].dirty = true;
@@ -402,21 +477,92 @@ namespace pam {
     }
 
 
-    std::vector<int> get_shape( std::string name ) { return entries[find_entry_or_error(name)].dims; }
+    std::vector<int> get_shape( std::string const &name ) { return entries[find_entry_or_error(name)].dims; }
+
+
+    // Turn on arena mode. Subsequent register_and_allocate calls place entries in large slabs, aligned to
+    // arena_alignment, rather than allocating each entry separately. Entries allocated before this call are
+    // unaffected. The first slab is slab_bytes bytes, which should be computed from the dimensions of the entries
+    // about to be registered (see get_arena_entry_bytes). Each later slab is at least as large as all previous slabs
+    // combined, so the slab count only grows logarithmically with the data registered. Space freed by
+    // unregister_and_deallocate is reused by later registrations that fit. A single slab large enough for the whole
+    // state gives single-copy checkpointing via arena_save() and arena_restore()
+    void enable_arena( size_t slab_bytes ) {
+      if (slab_bytes == 0) endrun("ERROR: Arena slab size must be positive");
+      arena_slab_bytes = slab_bytes;
+    }
+
+
+    // Is arena mode turned on?
+    bool arena_enabled() const { return arena_slab_bytes > 0; }
+
+
+    // Arena bytes (including alignment padding) taken by an entry of type T with these dimensions
+    template <class T>
+    size_t get_arena_entry_bytes( std::vector<int> const &dims ) const {
+      return arena_padded_bytes( get_data_size(dims)*sizeof(T) );
+    }
+
+
+    // Number of arena slabs currently allocated
+    int get_num_slabs() const { return slabs.size(); }
+
+
+    // Total bytes of arena data written by arena_save() and read by arena_restore()
+    size_t get_arena_bytes() const {
+      size_t bytes = 0;
+      for (int i=0; i < slabs.size(); i++) { bytes += slabs[i].used; }
+      return bytes;
+    }
+
+
+    // Copy all arena-allocated entries into host memory at dst, which must hold get_arena_bytes() bytes
+    // This is one copy per slab. Entries allocated outside the arena are not included
+    void arena_save( void *dst ) const {
+      size_t offset = 0;
+      for (int i=0; i < slabs.size(); i++) {
+        copy_bytes<memSpace,yakl::memHost>( slabs[i].ptr , ((char *) dst) + offset , slabs[i].used );
+        offset += slabs[i].used;
+      }
+      yakl::fence();
+    }
+
+
+    // Overwrite all arena-allocated entries with host data at src previously produced by arena_save() on a data
+    // manager with the same sequence of registrations. All arena entries are marked dirty
+    void arena_restore( void const *src ) {
+      size_t offset = 0;
+      for (int i=0; i < slabs.size(); i++) {
+        copy_bytes<yakl::memHost,memSpace>( ((char const *) src) + offset , slabs[i].ptr , slabs[i].used );
+        offset += slabs[i].used;
+      }
+      for (int id=0; id < entries.size(); id++) { if (entries[id].slab >= 0) entries[id].dirty = true; }
+      yakl::fence();
+    }
 
 
     // Validate all numerical entries. positive-definite entries are validated to ensure no negative values
     // All floating point values are checked for infinities. All entries are checked for NaNs.
-    // This is EXPENSIVE. All arrays are copied to the host, and the checks are performed on the host
-    void validate_all( bool die_on_failed_check = false ) const {
-      for (int id = 0; id < entries.size(); id++) { validate( entries[id].name , die_on_failed_check ); }
+    // float and double entries are checked in place with one batched kernel per type, and only a small per-entry
+    // summary is copied back to the host, so this is cheap enough to call every step. Entries of other types fall
+    // back to the host-side checks in validate(). Returns true if all batched checks passed
+    bool validate_all( bool die_on_failed_check = false ) const {
+      bool pass = true;
+      pass = validate_batch<float >( die_on_failed_check ) && pass;
+      pass = validate_batch<double>( die_on_failed_check ) && pass;
+      for (int id = 0; id < entries.size(); id++) {
+        if ( ! ( entry_type_is_same<float>(id) || entry_type_is_same<double>(id) ) ) {
+          validate( entries[id].name , die_on_failed_check );
+        }
+      }
+      return pass;
     }
 
 
     // Validate one entry. positive-definite entries are validated to ensure no negative values
     // All floating point values are checked for infinities. All entries are checked for NaNs.
     // This is EXPENSIVE. All arrays are copied to the host, and the checks are performed on the host
-    void validate( std::string name , bool die_on_failed_check = false ) const {
+    void validate( std::string const &name , bool die_on_failed_check = false ) const {
       validate_nan(name,die_on_failed_check);
       validate_inf(name,die_on_failed_check);
       validate_pos(name,die_on_failed_check);
@@ -425,7 +571,7 @@ namespace pam {
 
     // Validate one entry for NaNs
     // This is EXPENSIVE. All arrays are copied to the host, and the checks are performed on the host
-    void validate_nan( std::string name , bool die_on_failed_check = false ) const {
+    void validate_nan( std::string const &name , bool die_on_failed_check = false ) const {
       bool die = die_on_failed_check;
       int id = find_entry_or_error(name);
       if      (entry_type_is_same<short int>             (id)) { validate_single_nan<short int const>             (name,die); }
@@ -444,7 +590,7 @@ namespace pam {
 
     // Validate one entry for infs
     // This is EXPENSIVE. All arrays are copied to the host, and the checks are performed on the host
-    void validate_inf( std::string name , bool die_on_failed_check = false ) const {
+    void validate_inf( std::string const &name , bool die_on_failed_check = false ) const {
       int id = find_entry_or_error(name);
       if      (entry_type_is_same<float>      (id)) { validate_single_inf<float const>      (name,die_on_failed_check); }
       else if (entry_type_is_same<double>     (id)) { validate_single_inf<double const>     (name,die_on_failed_check); }
@@ -454,7 +600,7 @@ namespace pam {
 
     // Validate one entry for negative values
     // This is EXPENSIVE. All arrays are copied to the host, and the checks are performed on the host
-    void validate_pos( std::string name , bool die_on_failed_check = false ) const {
+    void validate_pos( std::string const &name , bool die_on_failed_check = false ) const {
       int id = find_entry_or_error(name);
       if      (entry_type_is_same<short int>    (id)) { validate_single_pos<short int const>    (name,die_on_failed_check); }
       else if (entry_type_is_same<int>          (id)) { validate_single_pos<int const>          (name,die_on_failed_check); }
@@ -468,7 +614,7 @@ namespace pam {
 
     // INTERNAL USE: check one entry id for NaNs
     template <class T>
-    void validate_single_nan(std::string name , bool die_on_failed_check = false) const {
+    void validate_single_nan( std::string const &name , bool die_on_failed_check = false) const {
       auto arr = get_collapsed<T>(name).createHostCopy();
       for (int i=0; i < arr.get_elem_count(); i++) {
         if ( std::isnan( arr(i) ) ) {
@@ -481,7 +627,7 @@ namespace pam {
 
     // INTERNAL USE: check one entry id for infs
     template <class T>
-    void validate_single_inf(std::string name , bool die_on_failed_check = false) const {
+    void validate_single_inf( std::string const &name , bool die_on_failed_check = false) const {
       auto arr = get_collapsed<T>(name).createHostCopy();
       for (int i=0; i < arr.get_elem_count(); i++) {
         if ( std::isinf( arr(i) ) ) {
@@ -494,7 +640,7 @@ namespace pam {
 
     // INTERNAL USE: check one entry id for negative values
     template <class T>
-    void validate_single_pos(std::string name , bool die_on_failed_check = false) const {
+    void validate_single_pos( std::string const &name , bool die_on_failed_check = false) const {
       int id = find_entry_or_error( name );
       if (entries[id].positive) {
         auto arr = get_collapsed<T>(name).createHostCopy();
@@ -509,26 +655,189 @@ namespace pam {
     }
 
 
-    // INTERNAL USE: Return the id of the named entry or -1 if it isn't found
-    int find_entry( std::string name ) const {
-      for (int i=0; i < entries.size(); i++) {
-        if (entries[i].name == name) return i;
+    // INTERNAL USE: Columns of the per-entry validation summary computed by validate_batch()
+    static int constexpr VALIDATE_NAN_COUNT = 0;
+    static int constexpr VALIDATE_INF_COUNT = 1;
+    static int constexpr VALIDATE_NEG_COUNT = 2;
+    static int constexpr VALIDATE_NAN_FIRST = 3;
+    static int constexpr VALIDATE_INF_FIRST = 4;
+    static int constexpr VALIDATE_NEG_FIRST = 5;
+    static int constexpr VALIDATE_NUM_STATS = 6;
+
+
+    // INTERNAL USE: Counts and indices in the validation summary are 64-bit so that large entries and large batches
+    // do not overflow
+    typedef unsigned long long validate_int;
+
+
+    // INTERNAL USE: Per-type buffers for validate_batch(), kept between calls and only reallocated when the number
+    // of entries of that type changes
+    template <class T>
+    struct ValidateBuffers {
+      Array<T const *     ,1,yakl::memHost,styleC> ptrs_host;
+      Array<size_t        ,1,yakl::memHost,styleC> offsets_host;
+      Array<int           ,1,yakl::memHost,styleC> positive_host;
+      Array<validate_int  ,2,yakl::memHost,styleC> summary_host;
+      Array<T const *     ,1,memSpace     ,styleC> ptrs;
+      Array<size_t        ,1,memSpace     ,styleC> offsets;
+      Array<int           ,1,memSpace     ,styleC> positive;
+      Array<validate_int  ,2,memSpace     ,styleC> summary;
+    };
+    mutable ValidateBuffers<float > validate_buffers_float;
+    mutable ValidateBuffers<double> validate_buffers_double;
+
+
+    // INTERNAL USE: Return the validation buffers for type T, sized for nbatch entries
+    template <class T>
+    ValidateBuffers<T> & get_validate_buffers( int nbatch ) const {
+      static_assert( std::is_same<T,float>::value || std::is_same<T,double>::value ,
+                     "ERROR: validate_batch is only implemented for float and double" );
+      ValidateBuffers<T> *bufs;
+      if constexpr (std::is_same<T,float>::value) { bufs = &validate_buffers_float;  }
+      else                                        { bufs = &validate_buffers_double; }
+      if (! bufs->ptrs_host.initialized() || bufs->ptrs_host.extent(0) != nbatch) {
+        bufs->ptrs_host     = Array<T const *   ,1,yakl::memHost,styleC>("validate_ptrs"    ,nbatch  );
+        bufs->offsets_host  = Array<size_t      ,1,yakl::memHost,styleC>("validate_offsets" ,nbatch+1);
+        bufs->positive_host = Array<int         ,1,yakl::memHost,styleC>("validate_positive",nbatch  );
+        bufs->summary_host  = Array<validate_int,2,yakl::memHost,styleC>("validate_summary" ,nbatch,VALIDATE_NUM_STATS);
+        if constexpr (memSpace == yakl::memDevice) {
+          bufs->ptrs     = bufs->ptrs_host    .createDeviceObject();
+          bufs->offsets  = bufs->offsets_host .createDeviceObject();
+          bufs->positive = bufs->positive_host.createDeviceObject();
+          bufs->summary  = bufs->summary_host .createDeviceObject();
+        }
       }
-      return -1;
+      return *bufs;
     }
 
 
-    // INTERNAL USE: Return the id of the named dimension or -1 if it isn't found
-    int find_dimension( std::string name ) const {
-      for (int i=0; i < dimensions.size(); i++) {
-        if (dimensions[i].name == name) return i;
+    // INTERNAL USE: Check one element of entry b of a validation batch, and record failures in the summary
+    template <class T, class PTRS, class OFFSETS, class INTS, class SUMMARY>
+    YAKL_INLINE static void validate_element( PTRS const &ptrs , OFFSETS const &offsets , INTS const &positive ,
+                                              SUMMARY const &summary , int b , size_t glob ) {
+      validate_int i = glob - offsets(b);
+      T v = ptrs(b)[i];
+      if ( std::isnan(v) ) {
+        yakl::atomicAdd( summary(b,VALIDATE_NAN_COUNT) , (validate_int) 1 );
+        yakl::atomicMin( summary(b,VALIDATE_NAN_FIRST) , i );
+      } else if ( std::isinf(v) ) {
+        yakl::atomicAdd( summary(b,VALIDATE_INF_COUNT) , (validate_int) 1 );
+        yakl::atomicMin( summary(b,VALIDATE_INF_FIRST) , i );
       }
-      return -1;
+      if ( positive(b) && v < 0 ) {
+        yakl::atomicAdd( summary(b,VALIDATE_NEG_COUNT) , (validate_int) 1 );
+        yakl::atomicMin( summary(b,VALIDATE_NEG_FIRST) , i );
+      }
+    }
+
+
+    // INTERNAL USE: Check all entries of type T for NaNs, infs, and negative values in positive-definite entries
+    // with a single pass over the concatenation of all of their elements. Only the per-entry summary of counts
+    // and first offending indices is copied to the host. Returns true if no problems were found
+    template <class T>
+    bool validate_batch( bool die_on_failed_check ) const {
+      using yakl::c::parallel_for;
+
+      std::vector<int> ids;
+      for (int id = 0; id < entries.size(); id++) { if (entry_type_is_same<T>(id)) ids.push_back(id); }
+      int nbatch = ids.size();
+      if (nbatch == 0) return true;
+
+      auto &bufs          = get_validate_buffers<T>( nbatch );
+      auto &ptrs_host     = bufs.ptrs_host;
+      auto &offsets_host  = bufs.offsets_host;
+      auto &positive_host = bufs.positive_host;
+      auto &summary_host  = bufs.summary_host;
+      offsets_host(0) = 0;
+      for (int b=0; b < nbatch; b++) {
+        ptrs_host    (b)   = (T const *) entries[ids[b]].ptr;
+        offsets_host (b+1) = offsets_host(b) + get_data_size( entries[ids[b]].dims );
+        positive_host(b)   = entries[ids[b]].positive ? 1 : 0;
+        for (int s=0; s < VALIDATE_NUM_STATS; s++) {
+          summary_host(b,s) = s < VALIDATE_NAN_FIRST ? 0 : std::numeric_limits<validate_int>::max();
+        }
+      }
+      size_t nglob = offsets_host(nbatch);
+
+      if constexpr (memSpace == yakl::memDevice) {
+        ptrs_host    .deep_copy_to(bufs.ptrs    );
+        offsets_host .deep_copy_to(bufs.offsets );
+        positive_host.deep_copy_to(bufs.positive);
+        summary_host .deep_copy_to(bufs.summary );
+        auto ptrs     = bufs.ptrs;
+        auto offsets  = bufs.offsets;
+        auto positive = bufs.positive;
+        auto summary  = bufs.summary;
+        // Launch in pieces of at most INT_MAX elements so the kernel index never overflows
+        size_t constexpr max_launch = std::numeric_limits<int>::max();
+        for (size_t base = 0; base < nglob; base += max_launch) {
+          int nlaunch = std::min( nglob - base , max_launch );
+          parallel_for( YAKL_AUTO_LABEL() , nlaunch , YAKL_LAMBDA (int l) {
+            size_t glob = base + l;
+            // Binary search for the last entry whose offset is <= glob
+            int lo = 0;
+            int hi = nbatch-1;
+            while (lo < hi) {
+              int mid = (lo+hi+1)/2;
+              if (offsets(mid) <= glob) { lo = mid;   }
+              else                      { hi = mid-1; }
+            }
+            validate_element<T>( ptrs , offsets , positive , summary , lo , glob );
+          });
+        }
+        summary.deep_copy_to(summary_host);
+        yakl::fence();
+      } else {
+        for (int b=0; b < nbatch; b++) {
+          for (size_t glob=offsets_host(b); glob < offsets_host(b+1); glob++) {
+            validate_element<T>( ptrs_host , offsets_host , positive_host , summary_host , b , glob );
+          }
+        }
+      }
+
+      bool pass = true;
+      for (int b=0; b < nbatch; b++) {
+        std::string const &name = entries[ids[b]].name;
+        if (summary_host(b,VALIDATE_NAN_COUNT) > 0) {
+          std::cerr << "WARNING: " << summary_host(b,VALIDATE_NAN_COUNT) << " NaNs discovered in: " << name
+                    << " first at global index: " << summary_host(b,VALIDATE_NAN_FIRST) << "\n";
+          pass = false;
+        }
+        if (summary_host(b,VALIDATE_INF_COUNT) > 0) {
+          std::cerr << "WARNING: " << summary_host(b,VALIDATE_INF_COUNT) << " infs discovered in: " << name
+                    << " first at global index: " << summary_host(b,VALIDATE_INF_FIRST) << "\n";
+          pass = false;
+        }
+        if (summary_host(b,VALIDATE_NEG_COUNT) > 0) {
+          std::cerr << "WARNING: " << summary_host(b,VALIDATE_NEG_COUNT)
+                    << " negative values discovered in positive-definite entry: " << name
+                    << " first at global index: " << summary_host(b,VALIDATE_NEG_FIRST) << "\n";
+          pass = false;
+        }
+      }
+      if (die_on_failed_check && ! pass) endrun("");
+      return pass;
+    }
+
+
+    // INTERNAL USE: Return the id of the named entry or -1 if it isn't found
+    int find_entry( std::string const &name ) const {
+      auto it = entry_ids.find( name );
+      if (it == entry_ids.end()) return -1;
+      return it->second;
+    }
+
+
+    // INTERNAL USE: Return the id of the named dimension or -1 if it isn't found
+    int find_dimension( std::string const &name ) const {
+      auto it = dimension_ids.find( name );
+      if (it == dimension_ids.end()) return -1;
+      return it->second;
     }
 
 
     // INTERNAL USE: Return the id of the named dimension or kill the run if it isn't found
-    int find_entry_or_error( std::string name ) const {
+    int find_entry_or_error( std::string const &name ) const {
       int id = find_entry( name );
       if (id >= 0) return id;
       endrun("ERROR: Could not find entry in coupler data");
@@ -536,16 +845,147 @@ namespace pam {
     }
 
 
+    // INTERNAL USE: Return the id of the entry with this handle or kill the run if it's invalid or unregistered
+    int find_handle_or_error( int handle ) const {
+      if (handle >= 0 && handle < handle_ids.size()) {
+        if (handle_ids[handle] >= 0) return handle_ids[handle];
+      }
+      endrun("ERROR: Invalid or unregistered coupler data handle");
+      return -1;
+    }
+
+
+    // INTERNAL USE: Append an entry, index its name, and assign its handle. Returns the handle
+    int add_entry( Entry loc ) {
+      loc.handle = handle_ids.size();
+      handle_ids.push_back( entries.size() );
+      entry_ids[loc.name] = entries.size();
+      entries.push_back( loc );
+      return loc.handle;
+    }
+
+
+    // INTERNAL USE: Allocate data for a managed entry, either on its own or from the arena when arena mode is on.
+    // slab and offset are set to the arena location, or to -1 and 0 for a standalone allocation
+    void *allocate_entry_data( size_t bytes , char const *label , int &slab , size_t &offset ) {
+      if (! arena_enabled()) {
+        slab   = -1;
+        offset = 0;
+        return allocate( bytes , label );
+      }
+      size_t padded = arena_padded_bytes( bytes );
+      // First fit in the ranges freed by unregistered entries
+      for (int islab=0; islab < slabs.size(); islab++) {
+        auto &ranges = slabs[islab].free_ranges;
+        for (int r=0; r < ranges.size(); r++) {
+          if (ranges[r].second >= padded) {
+            slab   = islab;
+            offset = ranges[r].first;
+            ranges[r].first  += padded;
+            ranges[r].second -= padded;
+            if (ranges[r].second == 0) ranges.erase( ranges.begin() + r );
+            return ((char *) slabs[islab].ptr) + offset;
+          }
+        }
+      }
+      // Otherwise bump-allocate out of the last slab, and start a new one if this entry doesn't fit
+      if (slabs.empty() || slabs.back().used + padded > slabs.back().bytes) {
+        size_t total = 0;
+        for (int i=0; i < slabs.size(); i++) { total += slabs[i].bytes; }
+        Slab loc;
+        loc.bytes = std::max( std::max( arena_slab_bytes , total ) , padded );
+        loc.used  = 0;
+        loc.ptr   = allocate( loc.bytes , "pam_data_manager_arena" );
+        slabs.push_back( loc );
+      }
+      slab   = slabs.size()-1;
+      offset = slabs.back().used;
+      slabs.back().used += padded;
+      return ((char *) slabs.back().ptr) + offset;
+    }
+
+
+    // INTERNAL USE: Copy bytes between memory spaces, in chunks small enough for YAKL's int indexing
+    template <int srcSpace, int dstSpace>
+    static void copy_bytes( void const *src , void *dst , size_t bytes ) {
+      size_t constexpr chunk = std::numeric_limits<int>::max();
+      for (size_t beg=0; beg < bytes; beg += chunk) {
+        int len = (int) std::min( chunk , bytes - beg );
+        Array<char,1,srcSpace,styleC> from( "arena_copy" , const_cast<char *>((char const *) src) + beg , len );
+        Array<char,1,dstSpace,styleC> to  ( "arena_copy" , ((char *) dst) + beg , len );
+        from.deep_copy_to(to);
+      }
+    }
+
+
+    // INTERNAL USE: Entry size rounded up to the arena alignment
+    static size_t arena_padded_bytes( size_t bytes ) {
+      return ( (bytes + arena_alignment - 1) / arena_alignment ) * arena_alignment;
+    }
+
+
+    // INTERNAL USE: Return a range to a slab's free list, merging it with adjacent free ranges. A range that ends at
+    // the slab's high-water mark lowers the mark instead
+    void free_arena_range( int islab , size_t offset , size_t bytes ) {
+      auto &sl     = slabs[islab];
+      auto &ranges = sl.free_ranges;
+      auto it = std::lower_bound( ranges.begin() , ranges.end() , std::make_pair(offset,(size_t) 0) );
+      it = ranges.insert( it , std::make_pair(offset,bytes) );
+      if (it+1 != ranges.end() && it->first + it->second == (it+1)->first) {
+        it->second += (it+1)->second;
+        ranges.erase( it+1 );
+      }
+      if (it != ranges.begin() && (it-1)->first + (it-1)->second == it->first) {
+        (it-1)->second += it->second;
+        it = ranges.erase( it ) - 1;
+      }
+      if (it->first + it->second == sl.used) {
+        sl.used = it->first;
+        ranges.erase( it );
+      }
+    }
+
+
+    // INTERNAL USE: Append a dimension and index its name
+    void add_dimension_entry( std::string const &name , int len ) {
+      dimension_ids[name] = dimensions.size();
+      dimensions.push_back( {name , len} );
+    }
+
+
+    // INTERNAL USE: Return a READ ONLY YAKL array (styleC) for entry id after validating type and dimensionality
+    template <class T, int N , typename std::enable_if< std::is_const<T>::value , int >::type = 0 >
+    Array<T,N,memSpace,styleC> get_by_id( int id ) const {
+      validate_type<T>(id);
+      validate_dims<N>(id);
+      Array<T,N,memSpace,styleC> ret( entries[id].name.c_str() , (T *) entries[id].ptr , entries[id].dims );
+      return ret;
+    }
+
+
+    // INTERNAL USE: Return a READ/WRITE YAKL array (styleC) for entry id after validating type and dimensionality
+    // The dirty flag is set to true because it can be potentially written to
+    template <class T, int N , typename std::enable_if< ! std::is_const<T>::value , int >::type = 0 >
+    Array<T,N,memSpace,styleC> get_by_id( int id ) {
+      if (entries[id].read_only) endrun("ERROR: Trying to get() a read-only arary without a const type");
+      entries[id].dirty = true;
+      validate_type<T>(id);
+      validate_dims<N>(id);
+      Array<T,N,memSpace,styleC> ret( entries[id].name.c_str() , (T *) entries[id].ptr , entries[id].dims );
+      return ret;
+    }
+
+
     // INTERNAL USE: Return the product of the vector of dimensions
-    int get_data_size( std::vector<int> dims ) const {
-      int size = 1;
+    size_t get_data_size( std::vector<int> dims ) const {
+      size_t size = 1;
       for (int i=0; i < dims.size(); i++) { size *= dims[i]; }
       return size;
     }
 
 
     // INTERNAL USE: Return the size of the named dimension or kill the run if it isn't found
-    int get_dimension_size( std::string name ) const {
+    int get_dimension_size( std::string const &name ) const {
       int id = find_dimension( name );
       if (id == -1) { endrun("ERROR: Could not find dimension."); }
       return dimensions[id].len;
@@ -595,10 +1035,17 @@ namespace pam {
     // Generally meat for internal use, but perhaps there are cases where the user might want to call this directly.
     void finalize() {
       for (int i=0; i < entries.size(); i++) {
-        if (entries[i].managed) deallocate( entries[i].ptr , entries[i].name.c_str() );
+        if (entries[i].managed && entries[i].slab < 0) deallocate( entries[i].ptr , entries[i].name.c_str() );
       }
-      entries    = std::vector<Entry>();
-      dimensions = std::vector<Dimension>();
+      for (int i=0; i < slabs.size(); i++) { deallocate( slabs[i].ptr , "pam_data_manager_arena" ); }
+      slabs         = std::vector<Slab>();
+      entries       = std::vector<Entry>();
+      dimensions    = std::vector<Dimension>();
+      entry_ids     = std::unordered_map<std::string,int>();
+      dimension_ids = std::unordered_map<std::string,int>();
+      handle_ids    = std::vector<int>();
+      validate_buffers_float  = ValidateBuffers<float >();
+      validate_buffers_double = ValidateBuffers<double>();
     }
 
 
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace pam {
+
+  // NetCDF is not thread safe, and the dycore and the standalone driver may each run their own writer thread. Every
+  // NetCDF call in the process, on any thread, must hold this lock from creating or opening a file until closing it
+  inline std::mutex & netcdf_mutex() {
+    static std::mutex mtx;
+    return mtx;
+  }
+
+
+  // Runs jobs one at a time, in submission order, on a background thread, so output classes can move file writing
+  // out of the time loop. Jobs that call NetCDF must still take netcdf_mutex(). Jobs and the submitting thread can
+  // share state (e.g., which host buffers are still being written) through locked() and wait()
+  class AsyncWriter {
+  public:
+
+    AsyncWriter() { stop = false; pending = 0; }
+    AsyncWriter(AsyncWriter const &rhs) = delete;
+    AsyncWriter &operator=(AsyncWriter const &rhs) = delete;
+    ~AsyncWriter() { finalize(); }
+
+
+    // Start the background thread. Until this is called, submit() runs each job immediately on the calling thread
+    void start() {
+      if (thread.joinable()) return;
+      stop = false;
+      thread = std::thread( [this] () { loop(); } );
+    }
+
+
+    bool running() const { return thread.joinable(); }
+
+
+    void submit( std::function<void()> job ) {
+      if (! running()) { job(); return; }
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        jobs.push_back( std::move(job) );
+        pending++;
+      }
+      cv.notify_all();
+    }
+
+
+    // Run f under the writer's lock, and wake anyone blocked in wait()
+    template <class F>
+    void locked( F const &f ) {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        f();
+      }
+      cv.notify_all();
+    }
+
+
+    // Block until pred() is true. pred is evaluated under the writer's lock
+    template <class P>
+    void wait( P const &pred ) {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait( lock , pred );
+    }
+
+
+    // Wait for all submitted jobs to finish
+    void flush() { wait( [&] () { return pending == 0; } ); }
+
+
+    // Finish all submitted jobs and stop the background thread
+    void finalize() {
+      if (! thread.joinable()) return;
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+      }
+      cv.notify_all();
+      thread.join();
+    }
+
+
+  private:
+
+    std::thread                        thread;
+    std::mutex                         mtx;
+    std::condition_variable            cv;
+    std::deque<std::function<void()>>  jobs;
+    int                                pending;
+    bool                               stop;
+
+
+    void loop() {
+      while (true) {
+        std::function<void()> job;
+        {
+          std::unique_lock<std::mutex> lock(mtx);
+          cv.wait( lock , [&] () { return stop || !jobs.empty(); } );
+          if (jobs.empty()) { return; }
+          job = std::move(jobs.front());
+          jobs.pop_front();
+        }
+        job();
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          pending--;
+        }
+        cv.notify_all();
+      }
+    }
+
+  };
+
+}
@@ -0,0 +1,61 @@
+
+#pragma once
+
+#include "pam_const.h"
+#include "DataManager.h"
+
+namespace pam {
+
+  // Persistent scratch of at least n reals for horizontal_sum's chunk partials. It lives in the data manager as
+  // "horizontal_sum_scratch", so it is shared by every caller and only reallocated when a larger one is needed.
+  // It's zeroed on allocation so that validating the data manager never sees uninitialized values
+  inline real1d get_horizontal_sum_scratch( DataManager &dm , int n ) {
+    char const *name = "horizontal_sum_scratch";
+    if (dm.entry_exists(name) && dm.get_shape(name)[0] < n) dm.unregister_and_deallocate(name);
+    if (! dm.entry_exists(name)) {
+      dm.register_and_allocate<real>( name , "horizontal_sum chunk partials" , {n} );
+      yakl::memset( dm.get<real,1>(name) , 0._fp );
+    }
+    return dm.get<real,1>(name);
+  }
+
+
+  // Batched reduction over the horizontal for every field, level and ensemble:
+  //    result(ifld,k,iens) = scale * sum over (j,i) of func(ifld,k,j,i,iens)
+  // where func is a YAKL_LAMBDA returning the value at a point. The ny*nx columns are split into chunks of about
+  // sqrt(ny*nx) columns. One kernel sums each chunk in a fixed order, and a second sums the chunk partials in a fixed
+  // order. This avoids atomics entirely, so there is no contention on the per-level sums and the result is bitwise
+  // reproducible from run to run. Adjacent threads handle adjacent ensembles, so reads stay coalesced.
+  // The chunk partials go in persistent scratch from dm (see get_horizontal_sum_scratch)
+  template <class F>
+  inline void horizontal_sum( DataManager &dm , int num_fields , int nz , int ny , int nx , int nens , F const &func ,
+                              real3d const &result , real scale = 1._fp ) {
+    using yakl::c::parallel_for;
+    using yakl::c::SimpleBounds;
+
+    int ncol   = ny*nx;
+    int chunk  = std::max( 1 , (int) std::ceil( std::sqrt( (double) ncol ) ) );
+    int nchunk = (ncol + chunk - 1) / chunk;
+
+    auto scratch = get_horizontal_sum_scratch( dm , num_fields*nz*nchunk*nens );
+    real4d partial("horizontal_sum_partial",scratch.data(),num_fields,nz,nchunk,nens);
+
+    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(num_fields,nz,nchunk,nens) ,
+                  YAKL_LAMBDA (int ifld, int k, int c, int iens) {
+      int beg = c*chunk;
+      int end = beg+chunk < ncol ? beg+chunk : ncol;
+      real sum = 0;
+      for (int col=beg; col < end; col++) { sum += func(ifld,k,col/nx,col%nx,iens); }
+      partial(ifld,k,c,iens) = sum;
+    });
+
+    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<3>(num_fields,nz,nens) , YAKL_LAMBDA (int ifld, int k, int iens) {
+      real sum = 0;
+      for (int c=0; c < nchunk; c++) { sum += partial(ifld,k,c,iens); }
+      result(ifld,k,iens) = sum * scale;
+    });
+  }
+
+}
+
+
@@ -5,6 +5,17 @@
 
 namespace modules {
 
+  // Persistent (nfld,nz,nens) work array kept in the coupler's data manager, so it's only allocated on first use.
+  // It's zeroed on allocation so that validating the data manager never sees uninitialized values
+  inline real3d get_gcm_forcing_scratch( pam::DataManager &dm , std::string name , int nfld , int nz , int nens ) {
+    if (! dm.entry_exists(name)) {
+      dm.register_and_allocate<real>( name , "GCM forcing work array" , {nfld,nz,nens} );
+      yakl::memset( dm.get<real,3>(name) , 0._fp );
+    }
+    return dm.get<real,3>(name);
+  }
+
+
   // This routine is only called once at the beginning of an MMF calculation (at the beginning of a GCM time step)
   // 
   // Let's call the current GCM state at the beginning of the MMF step for this GCM physics time step: state_gcm
@@ -18,7 +29,6 @@ namespace modules {
   inline void compute_gcm_forcing_tendencies( pam::PamCoupler &coupler ) {
     using yakl::c::parallel_for;
     using yakl::c::SimpleBounds;
-    using yakl::atomicAdd;
 
     auto &dm = coupler.get_data_manager_device_readwrite();
 
@@ -58,59 +68,24 @@ namespace modules {
     int nx   = dm.get_dimension_size("x"   );
     int nens = dm.get_dimension_size("nens");
 
-    // Create arrays to hold the current column average of the CRM internal columns
-    real2d colavg_rho_d("colavg_rho_d",nz,nens);
-    real2d colavg_uvel ("colavg_uvel" ,nz,nens);
-    real2d colavg_vvel ("colavg_vvel" ,nz,nens);
-    // #ifdef MMF_PAM_FORCE_ALL_WATER_SPECIES
-    real2d colavg_temp("colavg_temp" ,nz,nens);
-    real2d colavg_qv  ("colavg_qv",nz,nens);
-    real2d colavg_ql  ("colavg_ql",nz,nens);
-    real2d colavg_qi  ("colavg_qi",nz,nens);
-    // #endif
-    // #ifdef MMF_PAM_FORCE_TOTAL_WATER
-    // real2d colavg_temp_adj("colavg_temp_adj",nz,nens);
-    // real2d colavg_qtot("colavg_qtot",nz,nens);
-    // #endif
-
-    real2d colavg_nc("colavg_nc",nz,nens);
-    real2d colavg_ni("colavg_ni",nz,nens);
-    real2d colavg_nr("colavg_nr",nz,nens);
-
-    // We will be essentially reducing a summation to these variables, so initialize them to zero
-    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<2>(nz,nens) , YAKL_LAMBDA (int k, int iens) {
-      colavg_rho_d(k,iens) = 0;
-      colavg_uvel (k,iens) = 0;
-      colavg_vvel (k,iens) = 0;
-      // #ifdef MMF_PAM_FORCE_ALL_WATER_SPECIES
-      colavg_temp(k,iens) = 0;
-      colavg_qv  (k,iens) = 0;
-      colavg_ql  (k,iens) = 0;
-      colavg_qi  (k,iens) = 0;
-      // #endif
-      // #ifdef MMF_PAM_FORCE_TOTAL_WATER
-      // colavg_temp_adj(k,iens) = 0;
-      // colavg_qtot    (k,iens) = 0;
-      // #endif
-      colavg_nc(k,iens) = 0;
-      colavg_ni(k,iens) = 0;
-      colavg_nr(k,iens) = 0;
-    });
+    // Column averages of the CRM internal columns, one entry per averaged quantity
+    int constexpr AVG_RHO_D = 0;
+    int constexpr AVG_UVEL  = 1;
+    int constexpr AVG_VVEL  = 2;
+    int constexpr AVG_TEMP  = 3;
+    int constexpr AVG_QV    = 4;
+    int constexpr AVG_QL    = 5;
+    int constexpr AVG_QI    = 6;
+    int constexpr AVG_NC    = 7;
+    int constexpr AVG_NI    = 8;
+    int constexpr AVG_NR    = 9;
+    int constexpr NUM_AVG   = 10;
+    auto colavg = get_gcm_forcing_scratch( dm , "gcm_forcing_colavg" , NUM_AVG , nz , nens );
 
     real r_nx_ny  = 1._fp / (nx*ny);  // precompute reciprocal to avoid costly divisions
-    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
-      // yakl::atomicAdd ensures only one thread performs an update at a time to avoid data races and wrong answers
-      atomicAdd( colavg_rho_d(k,iens) , rho_d(k,j,i,iens) * r_nx_ny );
-      atomicAdd( colavg_uvel (k,iens) , uvel (k,j,i,iens) * r_nx_ny );
-      atomicAdd( colavg_vvel (k,iens) , vvel (k,j,i,iens) * r_nx_ny );
+    pam::horizontal_sum( dm , NUM_AVG , nz , ny , nx , nens , YAKL_LAMBDA (int ifld, int k, int j, int i, int iens) -> real {
       // #ifdef MMF_PAM_FORCE_ALL_WATER_SPECIES
-      atomicAdd( colavg_temp (k,iens) , temp (k,j,i,iens) * r_nx_ny );
-      real tmp_qv = rho_v(k,j,i,iens) / ( rho_d(k,j,i,iens) + rho_v(k,j,i,iens) );
-      real tmp_ql = rho_l(k,j,i,iens) / ( rho_d(k,j,i,iens) + rho_v(k,j,i,iens) );
-      real tmp_qi = rho_i(k,j,i,iens) / ( rho_d(k,j,i,iens) + rho_v(k,j,i,iens) );
-      atomicAdd( colavg_qv(k,iens) , tmp_qv * r_nx_ny );
-      atomicAdd( colavg_ql(k,iens) , tmp_ql * r_nx_ny );
-      atomicAdd( colavg_qi(k,iens) , tmp_qi * r_nx_ny );
+      real r_rho_dv = 1._fp / ( rho_d(k,j,i,iens) + rho_v(k,j,i,iens) );
       // #endif
       // #ifdef MMF_PAM_FORCE_TOTAL_WATER
       // real rho_total_water = rho_v(k,j,i,iens) + rho_l(k,j,i,iens) + rho_i(k,j,i,iens);
@@ -120,13 +95,18 @@ namespace modules {
       // real liq_adj         = ql_tmp* Lv     / cp_d;
       // real ice_adj         = qi_tmp*(Lv+Lf) / cp_d;
       // real temp_adj        = temp (k,j,i,iens) - liq_adj - ice_adj;
-      // atomicAdd( colavg_temp_adj(k,iens) , temp_adj        * r_nx_ny );
-      // atomicAdd( colavg_qtot    (k,iens) , qt_tmp          * r_nx_ny );
       // #endif
-      atomicAdd( colavg_nc(k,iens), crm_nc(k,j,i,iens) * r_nx_ny );
-      atomicAdd( colavg_ni(k,iens), crm_ni(k,j,i,iens) * r_nx_ny );
-      atomicAdd( colavg_nr(k,iens), crm_nr(k,j,i,iens) * r_nx_ny );
-    });
+      if      (ifld == AVG_RHO_D) { return rho_d (k,j,i,iens); }
+      else if (ifld == AVG_UVEL ) { return uvel  (k,j,i,iens); }
+      else if (ifld == AVG_VVEL ) { return vvel  (k,j,i,iens); }
+      else if (ifld == AVG_TEMP ) { return temp  (k,j,i,iens); }
+      else if (ifld == AVG_QV   ) { return rho_v (k,j,i,iens) * r_rho_dv; }
+      else if (ifld == AVG_QL   ) { return rho_l (k,j,i,iens) * r_rho_dv; }
+      else if (ifld == AVG_QI   ) { return rho_i (k,j,i,iens) * r_rho_dv; }
+      else if (ifld == AVG_NC   ) { return crm_nc(k,j,i,iens); }
+      else if (ifld == AVG_NI   ) { return crm_ni(k,j,i,iens); }
+      else                        { return crm_nr(k,j,i,iens); }
+    } , colavg , r_nx_ny );
 
     // We need the GCM forcing tendencies later, so store these in the coupler's data manager
     // If they've already been registered, the do not register them again
@@ -168,17 +148,17 @@ namespace modules {
     // colavg'd CRM state divided by the GCM physics time step to be evenly
     // distributed over the course of the CRM steps for the current GCM step
     parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<2>(nz,nens) , YAKL_LAMBDA (int k, int iens) {
-      gcm_forcing_tend_rho_d(k,iens) = ( rho_d_gcm(k,iens) - colavg_rho_d(k,iens) ) * r_dt_gcm;
-      gcm_forcing_tend_uvel (k,iens) = ( uvel_gcm (k,iens) - colavg_uvel (k,iens) ) * r_dt_gcm;
-      gcm_forcing_tend_vvel (k,iens) = ( vvel_gcm (k,iens) - colavg_vvel (k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_rho_d(k,iens) = ( rho_d_gcm(k,iens) - colavg(AVG_RHO_D,k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_uvel (k,iens) = ( uvel_gcm (k,iens) - colavg(AVG_UVEL ,k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_vvel (k,iens) = ( vvel_gcm (k,iens) - colavg(AVG_VVEL ,k,iens) ) * r_dt_gcm;
       // #ifdef MMF_PAM_FORCE_ALL_WATER_SPECIES
-      gcm_forcing_tend_temp (k,iens) = ( temp_gcm (k,iens) - colavg_temp (k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_temp (k,iens) = ( temp_gcm (k,iens) - colavg(AVG_TEMP ,k,iens) ) * r_dt_gcm;
       real tmp_qv_gcm = rho_v_gcm(k,iens) / ( rho_d_gcm(k,iens) + rho_v_gcm(k,iens) );
       real tmp_ql_gcm = rho_l_gcm(k,iens) / ( rho_d_gcm(k,iens) + rho_v_gcm(k,iens) );
       real tmp_qi_gcm = rho_i_gcm(k,iens) / ( rho_d_gcm(k,iens) + rho_v_gcm(k,iens) );
-      gcm_forcing_tend_qv(k,iens) = ( tmp_qv_gcm - colavg_qv(k,iens) ) * r_dt_gcm;
-      gcm_forcing_tend_ql(k,iens) = ( tmp_ql_gcm - colavg_ql(k,iens) ) * r_dt_gcm;
-      gcm_forcing_tend_qi(k,iens) = ( tmp_qi_gcm - colavg_qi(k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_qv(k,iens) = ( tmp_qv_gcm - colavg(AVG_QV,k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_ql(k,iens) = ( tmp_ql_gcm - colavg(AVG_QL,k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_qi(k,iens) = ( tmp_qi_gcm - colavg(AVG_QI,k,iens) ) * r_dt_gcm;
       // #endif
       // #ifdef MMF_PAM_FORCE_TOTAL_WATER
       // real gcm_rho_totq = rho_v_gcm(k,iens) + rho_l_gcm(k,iens) + rho_i_gcm(k,iens);
@@ -193,9 +173,9 @@ namespace modules {
       // gcm_forcing_tend_ql   (k,iens) = 0;
       // gcm_forcing_tend_qi   (k,iens) = 0;
       // #endif
-      gcm_forcing_tend_nc(k,iens) = ( gcm_nc(k,iens) - colavg_nc(k,iens) ) * r_dt_gcm;
-      gcm_forcing_tend_ni(k,iens) = ( gcm_ni(k,iens) - colavg_ni(k,iens) ) * r_dt_gcm;
-      gcm_forcing_tend_nr(k,iens) = ( gcm_nr(k,iens) - colavg_nr(k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_nc(k,iens) = ( gcm_nc(k,iens) - colavg(AVG_NC,k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_ni(k,iens) = ( gcm_ni(k,iens) - colavg(AVG_NI,k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_nr(k,iens) = ( gcm_nr(k,iens) - colavg(AVG_NR,k,iens) ) * r_dt_gcm;
       // save total water mixing ratio forcing for output
       gcm_forcing_tend_qtot(k,iens) = gcm_forcing_tend_qv(k,iens) 
                                     + gcm_forcing_tend_ql(k,iens) 
@@ -207,7 +187,6 @@ namespace modules {
   inline void fill_holes( pam::PamCoupler &coupler, real2d &rho_x_neg_mass, std::string tracer_name ) {
     using yakl::c::parallel_for;
     using yakl::c::SimpleBounds;
-    using yakl::atomicAdd;
     using yakl::ScalarLiveOut;
     using yakl::max;
     auto &dm = coupler.get_data_manager_device_readwrite();
@@ -220,20 +199,12 @@ namespace modules {
 
     auto rho_x = dm.get<real,4>( tracer_name );
 
-    // We need these arrays for multiplicative hole filling. Holes are only filled 
-    // inside vertical columns at first because it leads to a very infrequent 
-    // collision rate for atomidAdd() operations, reducing the runtime.
-    real2d rho_x_pos_mass("rho_v_pos_mass",nz,nens);
-
-    // initialize rho_x_pos_mass to zero
-    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<2>(nz,nens) , YAKL_LAMBDA (int k, int iens) {
-      rho_x_pos_mass(k,iens) = 0;
-    });
-
-    // Calculate available positive mass for hole filling at each vertical level 
-    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
-      if (rho_x(k,j,i,iens) > 0) atomicAdd( rho_x_pos_mass(k,iens) ,  rho_x(k,j,i,iens)*dz(k,iens) );
-    });
+    // Available positive mass for hole filling at each vertical level. Holes are only filled
+    // inside vertical levels at first, which is usually enough
+    auto rho_x_pos_mass = get_gcm_forcing_scratch( dm , "gcm_forcing_pos_mass" , 1 , nz , nens );
+    pam::horizontal_sum( dm , 1 , nz , ny , nx , nens , YAKL_LAMBDA (int ifld, int k, int j, int i, int iens) -> real {
+      return rho_x(k,j,i,iens) > 0 ? rho_x(k,j,i,iens)*dz(k,iens) : 0;
+    } , rho_x_pos_mass );
 
     // The negative is too large if the mass added to fill in negative values is greater than the available mass
     ScalarLiveOut<bool> neg_too_large(false);
@@ -242,36 +213,29 @@ namespace modules {
     parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
       // Determine if mass added to negatives is too large to compensate for in this vertical level
       if (i == 0 && j == 0) {
-        if (rho_x_neg_mass(k,iens) > rho_x_pos_mass(k,iens)) neg_too_large = true;
+        if (rho_x_neg_mass(k,iens) > rho_x_pos_mass(0,k,iens)) neg_too_large = true;
       }
       // Subtract mass proportional to this cells' portion of the total mass at the vertical level
-      real factor = rho_x(k,j,i,iens)*dz(k,iens) / rho_x_pos_mass(k,iens);
+      real factor = rho_x(k,j,i,iens)*dz(k,iens) / rho_x_pos_mass(0,k,iens);
       rho_x(k,j,i,iens) = max( 0._fp , rho_x(k,j,i,iens) - (rho_x_neg_mass(k,iens) * factor)/dz(k,iens) );
     });
 
     if (neg_too_large.hostRead()) {
       // If negative mass was too large, let's expand the domain of hole filling to the entire CRM
-      // This will have a large contention rate for atomicAdd() and will be less efficient than before
-      real1d rho_x_neg_mass_glob("rho_x_neg_mass_glob",nens);
-      real1d rho_x_pos_mass_glob("rho_x_pos_mass_glob",nens);
-
-      // These are essentially reductions, so initialize to zero
-      parallel_for( YAKL_AUTO_LABEL() , nens , YAKL_LAMBDA (int iens) {
-        rho_x_neg_mass_glob(iens) = 0;
-        rho_x_pos_mass_glob(iens) = 0;
-      });
-
-      // Compute the amount of negative mass we need to compensate for 
-      // as well as how much positive mass we still have
-      parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
-        if (i == 0 && j == 0) atomicAdd( rho_x_neg_mass_glob(iens) , max(0._fp,rho_x_neg_mass(k,iens)-rho_x_pos_mass(k,iens)) );
-        atomicAdd( rho_x_pos_mass_glob(iens) , rho_x(k,j,i,iens)*dz(k,iens) );
-      });
+      // Compute the amount of negative mass we need to compensate for as well as how much positive
+      // mass we still have, reducing over every (k,j,i) of an ensemble as one "level" of nz*ny*nx cells
+      int constexpr NEG_GLOB = 0;
+      int constexpr POS_GLOB = 1;
+      auto rho_x_mass_glob = get_gcm_forcing_scratch( dm , "gcm_forcing_mass_glob" , 2 , 1 , nens );
+      pam::horizontal_sum( dm , 2 , 1 , nz , ny*nx , nens , YAKL_LAMBDA (int ifld, int kk, int k, int col, int iens) -> real {
+        if (ifld == NEG_GLOB) { return col == 0 ? max(0._fp,rho_x_neg_mass(k,iens)-rho_x_pos_mass(0,k,iens)) : 0; }
+        return rho_x(k,col/nx,col%nx,iens)*dz(k,iens);
+      } , rho_x_mass_glob );
 
       // Remove mass proportionally to the mass in a given cell
       parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
-        real factor = rho_x(k,j,i,iens)*dz(k,iens) / rho_x_pos_mass_glob(iens);
-        rho_x(k,j,i,iens) = max( 0._fp , rho_x(k,j,i,iens) - (rho_x_neg_mass_glob(iens) * factor)/dz(k,iens) );
+        real factor = rho_x(k,j,i,iens)*dz(k,iens) / rho_x_mass_glob(POS_GLOB,0,iens);
+        rho_x(k,j,i,iens) = max( 0._fp , rho_x(k,j,i,iens) - (rho_x_mass_glob(NEG_GLOB,0,iens) * factor)/dz(k,iens) );
       });
       
     } // if (neg_too_large.hostRead()) {
@@ -292,7 +256,6 @@ namespace modules {
   inline void apply_gcm_forcing_tendencies( pam::PamCoupler &coupler ) {
     using yakl::c::parallel_for;
     using yakl::c::SimpleBounds;
-    using yakl::atomicAdd;
     auto &dm = coupler.get_data_manager_device_readwrite();
 
     auto dt = coupler.get_option<real>("crm_dt");
@@ -335,41 +298,7 @@ namespace modules {
     auto rho_l_gcm = dm.get<real const,2> ( "gcm_cloud_water" );
     auto rho_i_gcm = dm.get<real const,2> ( "gcm_cloud_ice"   );
 
-    // We need these arrays for multiplicative hole filling
-    // Holes are only filled inside vertical columns at first because it leads to a very infrequent collision
-    //    rate for atomidAdd() operations, reducing the runtime of the operations.
-    real2d rho_v_neg_mass("rho_v_neg_mass",nz,nens);
-    real2d rho_v_pos_mass("rho_v_pos_mass",nz,nens);
-    real2d rho_l_neg_mass("rho_l_neg_mass",nz,nens);
-    real2d rho_l_pos_mass("rho_l_pos_mass",nz,nens);
-    real2d rho_i_neg_mass("rho_i_neg_mass",nz,nens);
-    real2d rho_i_pos_mass("rho_i_pos_mass",nz,nens);
-
-    real2d colavg_rho_v("colavg_rho_v",nz,nens);
-    real2d colavg_rho_l("colavg_rho_l",nz,nens);
-    real2d colavg_rho_i("colavg_rho_i",nz,nens);
-    
-    // These are essentially reductions, so initialize to zero
-    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<2>(nz,nens) , YAKL_LAMBDA (int k, int iens) {
-      rho_v_neg_mass(k,iens) = 0;
-      rho_v_pos_mass(k,iens) = 0;
-      rho_l_neg_mass(k,iens) = 0;
-      rho_l_pos_mass(k,iens) = 0;
-      rho_i_neg_mass(k,iens) = 0;
-      rho_i_pos_mass(k,iens) = 0;
-      colavg_rho_v          (k,iens) = 0;
-      colavg_rho_l          (k,iens) = 0;
-      colavg_rho_i          (k,iens) = 0;
-      gcm_forcing_tend_rho_v(k,iens) = 0;
-      gcm_forcing_tend_rho_l(k,iens) = 0;
-      gcm_forcing_tend_rho_i(k,iens) = 0;
-    });
-
-    // Apply the GCM forcing, and keep track of negative mass we had to fill and available positive mass
-    //    to balance the added mass in the corrective step in the next kernel
-    // Multiplicative hole filling is done among a single vertical level at a time unless there isn't
-    //    enough mass available to fill the negatives. Then it is done globally
-    real r_nx_ny  = 1._fp / (nx*ny);  // precompute reciprocal to avoid costly divisions
+    // Apply the GCM forcing. Negative values are clipped after the column sums below
     parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
       real rho_d_old = rho_d(k,j,i,iens);
       // Apply forcing
@@ -395,37 +324,51 @@ namespace modules {
       if (nc(k,j,i,iens) < 0) { nc(k,j,i,iens) = 0; }
       if (ni(k,j,i,iens) < 0) { ni(k,j,i,iens) = 0; }
       if (nr(k,j,i,iens) < 0) { nr(k,j,i,iens) = 0; }
-      
-      // calculate column mean of updated densities for diagnostic forcing output
-      atomicAdd( colavg_rho_v(k,iens) , rho_v(k,j,i,iens) * r_nx_ny );
-      atomicAdd( colavg_rho_l(k,iens) , rho_l(k,j,i,iens) * r_nx_ny );
-      atomicAdd( colavg_rho_i(k,iens) , rho_i(k,j,i,iens) * r_nx_ny );
-
-      // Compute negative and positive mass for rho_v, and set negative masses to zero (essentially adding mass)
-      if (rho_v(k,j,i,iens) < 0) {
-        atomicAdd( rho_v_neg_mass(k,iens) , -rho_v(k,j,i,iens)*dz(k,iens) );
-        rho_v(k,j,i,iens) = 0;
-      }
+    });
+
+    // Column means of the updated densities for diagnostic forcing output, and the negative mass at each level
+    //    that the multiplicative hole filling has to balance. Holes are only filled inside vertical levels at
+    //    first, and globally only when a level doesn't have enough positive mass
+    int constexpr AVG_RHO_V = 0;
+    int constexpr AVG_RHO_L = 1;
+    int constexpr AVG_RHO_I = 2;
+    int constexpr NEG_RHO_V = 3;
+    int constexpr NEG_RHO_L = 4;
+    int constexpr NEG_RHO_I = 5;
+    int constexpr NUM_SUMS  = 6;
+    auto colsum = get_gcm_forcing_scratch( dm , "gcm_forcing_colsum" , NUM_SUMS , nz , nens );
+    real r_nx_ny = 1._fp / (nx*ny);  // precompute reciprocal to avoid costly divisions
+    pam::horizontal_sum( dm , NUM_SUMS , nz , ny , nx , nens , YAKL_LAMBDA (int ifld, int k, int j, int i, int iens) -> real {
+      if      (ifld == AVG_RHO_V) { return rho_v(k,j,i,iens) * r_nx_ny; }
+      else if (ifld == AVG_RHO_L) { return rho_l(k,j,i,iens) * r_nx_ny; }
+      else if (ifld == AVG_RHO_I) { return rho_i(k,j,i,iens) * r_nx_ny; }
+      else if (ifld == NEG_RHO_V) { return rho_v(k,j,i,iens) < 0 ? -rho_v(k,j,i,iens)*dz(k,iens) : 0; }
       // #ifdef MMF_PAM_FORCE_ALL_WATER_SPECIES
-      if (rho_l(k,j,i,iens) < 0) {
-        atomicAdd( rho_l_neg_mass(k,iens) , -rho_l(k,j,i,iens)*dz(k,iens) );
-        rho_l(k,j,i,iens) = 0;
-      }
-      if (rho_i(k,j,i,iens) < 0) {
-        atomicAdd( rho_i_neg_mass(k,iens) , -rho_i(k,j,i,iens)*dz(k,iens) );
-        rho_i(k,j,i,iens) = 0;
-      }
+      else if (ifld == NEG_RHO_L) { return rho_l(k,j,i,iens) < 0 ? -rho_l(k,j,i,iens)*dz(k,iens) : 0; }
+      else                        { return rho_i(k,j,i,iens) < 0 ? -rho_i(k,j,i,iens)*dz(k,iens) : 0; }
       // #endif
+    } , colsum );
 
+    // Set negative masses to zero (essentially adding mass)
+    parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int iens) {
+      if (rho_v(k,j,i,iens) < 0) { rho_v(k,j,i,iens) = 0; }
+      // #ifdef MMF_PAM_FORCE_ALL_WATER_SPECIES
+      if (rho_l(k,j,i,iens) < 0) { rho_l(k,j,i,iens) = 0; }
+      if (rho_i(k,j,i,iens) < 0) { rho_i(k,j,i,iens) = 0; }
+      // #endif
     });
 
+    real2d rho_v_neg_mass = colsum.slice<2>(NEG_RHO_V,yakl::COLON,yakl::COLON);
+    real2d rho_l_neg_mass = colsum.slice<2>(NEG_RHO_L,yakl::COLON,yakl::COLON);
+    real2d rho_i_neg_mass = colsum.slice<2>(NEG_RHO_I,yakl::COLON,yakl::COLON);
+
     // diagnose density forcing to be aggregated in the driver for output
     auto dt_gcm = coupler.get_option<real>("gcm_physics_dt");
     real r_dt_gcm = 1._fp / dt_gcm;  // precompute reciprocal to avoid costly divisions
     parallel_for( YAKL_AUTO_LABEL() , SimpleBounds<2>(nz,nens) , YAKL_LAMBDA (int k, int iens) {
-      gcm_forcing_tend_rho_v(k,iens) = ( rho_v_gcm(k,iens) - colavg_rho_v(k,iens) ) * r_dt_gcm;
-      gcm_forcing_tend_rho_l(k,iens) = ( rho_l_gcm(k,iens) - colavg_rho_l(k,iens) ) * r_dt_gcm;
-      gcm_forcing_tend_rho_i(k,iens) = ( rho_i_gcm(k,iens) - colavg_rho_i(k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_rho_v(k,iens) = ( rho_v_gcm(k,iens) - colsum(AVG_RHO_V,k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_rho_l(k,iens) = ( rho_l_gcm(k,iens) - colsum(AVG_RHO_L,k,iens) ) * r_dt_gcm;
+      gcm_forcing_tend_rho_i(k,iens) = ( rho_i_gcm(k,iens) - colsum(AVG_RHO_I,k,iens) ) * r_dt_gcm;
     });      
 
     // Only do the hole filing if there's negative mass
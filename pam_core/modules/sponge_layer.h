@@ -37,18 +37,6 @@ namespace modules {
     std::vector<std::string> tracer_names = coupler.get_tracer_names();
     int num_tracers = coupler.get_num_tracers();
 
-    // Allocate MultiField of all state and tracer havg variables, since we're doing the same operation on each
-    pam::MultiField<real,2> havg_fields;
-    havg_fields.add_field( real2d("havg_rho_d",nz,nens) );
-    havg_fields.add_field( real2d("havg_uvel" ,nz,nens) );
-    havg_fields.add_field( real2d("havg_vvel" ,nz,nens) );
-    havg_fields.add_field( real2d("havg_wvel" ,nz,nens) );
-    havg_fields.add_field( real2d("havg_temp" ,nz,nens) );
-    for (int tr=0; tr < num_tracers; tr++) {
-      char const * name = (std::string("havg_")+tracer_names[tr]).c_str();
-      havg_fields.add_field( real2d(name,nz,nens) );
-    }
-
     auto &dm = coupler.get_data_manager_device_readwrite();
 
     // Create MultiField of all state and tracer full variables, since we're doing the same operation on each
@@ -62,20 +50,17 @@ namespace modules {
       full_fields.add_field( dm.get<real,4>(tracer_names[tr]) );
     }
 
-    int num_fields = havg_fields.get_num_fields();
+    int num_fields = full_fields.get_num_fields();
 
     real r_nx_ny = 1._fp / (nx*ny);
 
-    // Zero out the havg_fields
-    parallel_for( SimpleBounds<3>(num_fields,nz,nens) , YAKL_LAMBDA (int ifld, int k, int iens) {
-      havg_fields(ifld,k,iens) = 0;
-    });
-
     // Compute the horizontal average for each vertical level (that we use for the sponge layer) and ensemble
-    parallel_for( SimpleBounds<5>(num_fields,num_layers,ny,nx,nens) , YAKL_LAMBDA (int ifld, int kloc, int j, int i, int iens) {
+    real3d havg_fields("havg_fields",num_fields,num_layers,nens);
+    pam::horizontal_sum( dm , num_fields , num_layers , ny , nx , nens ,
+                         YAKL_LAMBDA (int ifld, int kloc, int j, int i, int iens) -> real {
       int k = nz - 1 - kloc;
-      if (ifld != WFLD) yakl::atomicAdd( havg_fields(ifld,k,iens) , full_fields(ifld,k,j,i,iens) * r_nx_ny );
-    });
+      return ifld != WFLD ? full_fields(ifld,k,j,i,iens) : 0;
+    } , havg_fields , r_nx_ny );
 
     auto zint = dm.get<real const,2>("vertical_interface_height");
     auto zmid = dm.get<real const,2>("vertical_midpoint_height" );
@@ -91,7 +76,7 @@ namespace modules {
       real rel_dist = ( zint(nz,iens) - zmid(k,iens) ) / ( zint(nz,iens) - zmid(nz-1-(num_layers-1),iens) );
       real space_factor = ( cos(M_PI*rel_dist) + 1 ) / 2;
       real factor = space_factor * time_factor;
-      full_fields(ifld,k,j,i,iens) += ( havg_fields(ifld,k,iens) - full_fields(ifld,k,j,i,iens) ) * factor;
+      full_fields(ifld,k,j,i,iens) += ( havg_fields(ifld,kloc,iens) - full_fields(ifld,k,j,i,iens) ) * factor;
     });
   }
 
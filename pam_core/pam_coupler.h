@@ -4,6 +4,7 @@
 #include "pam_const.h"
 #include "DataManager.h"
 #include "vertical_interp.h"
+#include "horizontal_reduce.h"
 //#include "YAKL_netcdf.h"
 #include "Options.h"
 
@@ -31,6 +32,61 @@ namespace pam {
     };
     std::vector<Tracer> tracers;
 
+    // Stream and event used by the host<->device mirror copies, so the copies overlap with kernels on YAKL's stream
+    // and mirror_fence() only waits for the copies. Created on first use
+    struct MirrorStream {
+      #if defined(YAKL_ARCH_CUDA)
+        cudaStream_t stream = nullptr;
+        cudaEvent_t  event  = nullptr;
+      #elif defined(YAKL_ARCH_HIP)
+        hipStream_t  stream = nullptr;
+        hipEvent_t   event  = nullptr;
+      #endif
+      bool created = false;
+
+      MirrorStream() = default;
+      MirrorStream(MirrorStream &&rhs) { swap(rhs); }
+      MirrorStream &operator=(MirrorStream &&rhs) { swap(rhs); return *this; }
+      MirrorStream(MirrorStream const &) = delete;
+      MirrorStream &operator=(MirrorStream const &) = delete;
+      ~MirrorStream() { destroy(); }
+
+      void swap(MirrorStream &rhs) {
+        #if defined(YAKL_ARCH_CUDA) || defined(YAKL_ARCH_HIP)
+          std::swap(stream,rhs.stream);
+          std::swap(event ,rhs.event );
+        #endif
+        std::swap(created,rhs.created);
+      }
+
+      void create() {
+        if (created) return;
+        #if defined(YAKL_ARCH_CUDA)
+          cudaStreamCreateWithFlags( &stream , cudaStreamNonBlocking );
+          cudaEventCreateWithFlags ( &event  , cudaEventDisableTiming );
+        #elif defined(YAKL_ARCH_HIP)
+          hipStreamCreateWithFlags( &stream , hipStreamNonBlocking );
+          hipEventCreateWithFlags ( &event  , hipEventDisableTiming );
+        #endif
+        created = true;
+      }
+
+      void destroy() {
+        if (! created) return;
+        #if defined(YAKL_ARCH_CUDA)
+          cudaStreamSynchronize( stream );
+          cudaEventDestroy ( event  );
+          cudaStreamDestroy( stream );
+        #elif defined(YAKL_ARCH_HIP)
+          hipStreamSynchronize( stream );
+          hipEventDestroy ( event  );
+          hipStreamDestroy( stream );
+        #endif
+        created = false;
+      }
+    };
+    MirrorStream mirror_stream;
+
 
   public:
 
@@ -48,6 +104,7 @@ namespace pam {
 
 
     ~PamCoupler() {
+      mirror_stream.destroy();
       dm.finalize();
       options.finalize();
       tracers = std::vector<Tracer>();
@@ -148,6 +205,10 @@ namespace pam {
       #ifdef PAM_FUNCTION_TIMERS
         yakl::timer_stop ( name.c_str() );
       #endif
+      // Optionally trap NaNs, infs, and negative positive-definite values right after the module that produced them
+      if (get_option<bool>("validate_every_module",false)) {
+        if (! dm.validate_all()) endrun(std::string("ERROR: Invalid coupler data after module: ")+name);
+      }
       #ifdef PAM_FUNCTION_TRACE
         auto dirty_entry_names = dm.get_dirty_entries();
         std::cout << "MMF Module " << name << " wrote to the following coupler entries: ";
@@ -256,41 +317,63 @@ namespace pam {
       using yakl::c::parallel_for;
       using yakl::c::SimpleBounds;
 
-      dm.register_and_allocate<real>("density_dry"              ,"dry density"                ,{nz,ny,nx,nens},{"z","y","x","nens"});
-      dm.register_and_allocate<real>("uvel"                     ,"x-direction velocity"       ,{nz,ny,nx,nens},{"z","y","x","nens"});
-      dm.register_and_allocate<real>("vvel"                     ,"y-direction velocity"       ,{nz,ny,nx,nens},{"z","y","x","nens"});
-      dm.register_and_allocate<real>("wvel"                     ,"z-direction velocity"       ,{nz,ny,nx,nens},{"z","y","x","nens"});
-      dm.register_and_allocate<real>("temp"                     ,"temperature"                ,{nz,ny,nx,nens},{"z","y","x","nens"});
-      dm.register_and_allocate<real>("vertical_interface_height","vertical interface height"  ,{nz+1    ,nens},{"zp1"      ,"nens"});
-      dm.register_and_allocate<real>("vertical_cell_dz"         ,"vertical grid spacing"      ,{nz      ,nens},{"z"        ,"nens"});
-      dm.register_and_allocate<real>("vertical_midpoint_height" ,"vertical midpoint height"   ,{nz      ,nens},{"z"        ,"nens"});
-
-      dm.register_and_allocate<real>("gcm_pressure_int","GCM column interface pressure"             ,{nz+1,nens},{"zp1","nens"});
-      dm.register_and_allocate<real>("gcm_pressure_mid","GCM column midpoint pressure"              ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("gcm_density_dry" ,"GCM column dry density"                    ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("gcm_uvel"        ,"GCM column u-velocity"                     ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("gcm_vvel"        ,"GCM column v-velocity"                     ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("gcm_wvel"        ,"GCM column w-velocity"                     ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("gcm_temp"        ,"GCM column temperature"                    ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("gcm_water_vapor" ,"GCM column water vapor density"            ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("gcm_cloud_water" ,"GCM column cloud water density"            ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("gcm_cloud_ice"   ,"GCM column cloud ice density"              ,{nz  ,nens},{"z"  ,"nens"});
-
-      dm.register_and_allocate<real>("gcm_num_liq"   ,"GCM column cloud liq number"              ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("gcm_num_ice"   ,"GCM column cloud ice number"              ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("gcm_num_rain"  ,"GCM column liq rain number"               ,{nz  ,nens},{"z"  ,"nens"});
-
-      dm.register_and_allocate<real>("ref_presi"        ,"Reference state column interface pressure" ,{nz+1,nens},{"zp1","nens"});
-      dm.register_and_allocate<real>("ref_pres"         ,"Reference state column mid-point pressure" ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("ref_density_dry"  ,"Reference state column dry density"        ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("ref_density_vapor","Reference state column water vapor density",{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("ref_density_liq"  ,"Reference state column water liq density"  ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("ref_density_ice"  ,"Reference state column water ice density"  ,{nz  ,nens},{"z"  ,"nens"});
-      dm.register_and_allocate<real>("ref_temp"         ,"Reference state column temperature"        ,{nz  ,nens},{"z"  ,"nens"});
-
-      dm.register_and_allocate<real>("uvel_stag"                     ,"staggered x-direction velocity"       ,{nz,ny,nx+1,nens},{"z","y","xp1","nens"});
-      dm.register_and_allocate<real>("vvel_stag"                     ,"staggered y-direction velocity"       ,{nz,ny+1,nx,nens},{"z","yp1","x","nens"});
-      dm.register_and_allocate<real>("wvel_stag"                     ,"staggered z-direction velocity"       ,{nz+1,ny,nx,nens},{"zp1","y","x","nens"});
+      // The coupler state. This one list is used both to size the arena and to register the entries
+      struct StateEntry {
+        std::string              name;
+        std::string              desc;
+        std::vector<int>         dims;
+        std::vector<std::string> dim_names;
+      };
+      std::vector<StateEntry> state = {
+        {"density_dry"              ,"dry density"                ,{nz,ny,nx,nens},{"z","y","x","nens"}},
+        {"uvel"                     ,"x-direction velocity"       ,{nz,ny,nx,nens},{"z","y","x","nens"}},
+        {"vvel"                     ,"y-direction velocity"       ,{nz,ny,nx,nens},{"z","y","x","nens"}},
+        {"wvel"                     ,"z-direction velocity"       ,{nz,ny,nx,nens},{"z","y","x","nens"}},
+        {"temp"                     ,"temperature"                ,{nz,ny,nx,nens},{"z","y","x","nens"}},
+        {"vertical_interface_height","vertical interface height"  ,{nz+1    ,nens},{"zp1"      ,"nens"}},
+        {"vertical_cell_dz"         ,"vertical grid spacing"      ,{nz      ,nens},{"z"        ,"nens"}},
+        {"vertical_midpoint_height" ,"vertical midpoint height"   ,{nz      ,nens},{"z"        ,"nens"}},
+
+        {"gcm_pressure_int","GCM column interface pressure"             ,{nz+1,nens},{"zp1","nens"}},
+        {"gcm_pressure_mid","GCM column midpoint pressure"              ,{nz  ,nens},{"z"  ,"nens"}},
+        {"gcm_density_dry" ,"GCM column dry density"                    ,{nz  ,nens},{"z"  ,"nens"}},
+        {"gcm_uvel"        ,"GCM column u-velocity"                     ,{nz  ,nens},{"z"  ,"nens"}},
+        {"gcm_vvel"        ,"GCM column v-velocity"                     ,{nz  ,nens},{"z"  ,"nens"}},
+        {"gcm_wvel"        ,"GCM column w-velocity"                     ,{nz  ,nens},{"z"  ,"nens"}},
+        {"gcm_temp"        ,"GCM column temperature"                    ,{nz  ,nens},{"z"  ,"nens"}},
+        {"gcm_water_vapor" ,"GCM column water vapor density"            ,{nz  ,nens},{"z"  ,"nens"}},
+        {"gcm_cloud_water" ,"GCM column cloud water density"            ,{nz  ,nens},{"z"  ,"nens"}},
+        {"gcm_cloud_ice"   ,"GCM column cloud ice density"              ,{nz  ,nens},{"z"  ,"nens"}},
+
+        {"gcm_num_liq"   ,"GCM column cloud liq number"              ,{nz  ,nens},{"z"  ,"nens"}},
+        {"gcm_num_ice"   ,"GCM column cloud ice number"              ,{nz  ,nens},{"z"  ,"nens"}},
+        {"gcm_num_rain"  ,"GCM column liq rain number"               ,{nz  ,nens},{"z"  ,"nens"}},
+
+        {"ref_presi"        ,"Reference state column interface pressure" ,{nz+1,nens},{"zp1","nens"}},
+        {"ref_pres"         ,"Reference state column mid-point pressure" ,{nz  ,nens},{"z"  ,"nens"}},
+        {"ref_density_dry"  ,"Reference state column dry density"        ,{nz  ,nens},{"z"  ,"nens"}},
+        {"ref_density_vapor","Reference state column water vapor density",{nz  ,nens},{"z"  ,"nens"}},
+        {"ref_density_liq"  ,"Reference state column water liq density"  ,{nz  ,nens},{"z"  ,"nens"}},
+        {"ref_density_ice"  ,"Reference state column water ice density"  ,{nz  ,nens},{"z"  ,"nens"}},
+        {"ref_temp"         ,"Reference state column temperature"        ,{nz  ,nens},{"z"  ,"nens"}},
+
+        {"uvel_stag"                     ,"staggered x-direction velocity"       ,{nz,ny,nx+1,nens},{"z","y","xp1","nens"}},
+        {"vvel_stag"                     ,"staggered y-direction velocity"       ,{nz,ny+1,nx,nens},{"z","yp1","x","nens"}},
+        {"wvel_stag"                     ,"staggered z-direction velocity"       ,{nz+1,ny,nx,nens},{"zp1","y","x","nens"}}
+      };
+
+      // Optionally place the coupler state (and tracers and module data registered later) in a contiguous arena,
+      // so the whole state can be checkpointed or moved with a single copy. The first slab is sized exactly for the
+      // state above; tracers and module data go into later slabs that grow geometrically
+      if (get_option<bool>("data_manager_arena",false) && ! dm.arena_enabled()) {
+        size_t slab_bytes = 0;
+        for (auto &entry : state) { slab_bytes += dm.get_arena_entry_bytes<real>(entry.dims); }
+        dm.enable_arena( slab_bytes );
+      }
+
+      for (auto &entry : state) {
+        dm.register_and_allocate<real>( entry.name , entry.desc , entry.dims , entry.dim_names );
+      }
 
       auto density_dry  = dm.get_collapsed<real>("density_dry"              );
       auto uvel         = dm.get_collapsed<real>("uvel"                     );
@@ -388,6 +471,100 @@ namespace pam {
 
 
 
+    // Asynchronously copy host entries to the device entries of the same name on the mirror stream. Only entries that
+    // exist in both dm_host and dm are mirrored. By default, only host entries whose dirty flag is set (written through
+    // a non-const get since the last mirror) or whose writes can't be tracked (GCM-owned arrays registered with
+    // register_existing, and arrays whose pointers were handed to Fortran) are copied. Kernels launched after this
+    // call wait for the copies, but the host data must not be modified until mirror_fence() returns
+    void mirror_host_to_device( bool dirty_only = true ) {
+      mirror_stream.create();
+      for (int ih=0; ih < dm_host.entries.size(); ih++) {
+        int id = dm.find_entry( dm_host.entries[ih].name );
+        if (id < 0) continue;
+        if (dirty_only && ! dm_host.entries[ih].dirty && ! dm_host.entries[ih].untracked_writes) continue;
+        mirror_entry( dm_host.entries[ih] , dm.entries[id] , true );
+      }
+      // Make later kernels on YAKL's stream wait for the copies without blocking the host
+      #if defined(YAKL_ARCH_CUDA)
+        cudaEventRecord( mirror_stream.event , mirror_stream.stream );
+        cudaStreamWaitEvent( 0 , mirror_stream.event , 0 );
+      #elif defined(YAKL_ARCH_HIP)
+        hipEventRecord( mirror_stream.event , mirror_stream.stream );
+        hipStreamWaitEvent( 0 , mirror_stream.event , 0 );
+      #endif
+    }
+
+
+    // Asynchronously copy device entries to the host entries of the same name on the mirror stream, after all kernels
+    // previously launched on YAKL's stream. Only entries that exist in both dm and dm_host are mirrored, and by
+    // default only those whose device dirty flag is set or whose device writes can't be tracked, as in
+    // mirror_host_to_device. Read-only host entries (e.g., GCM inputs registered as const) are never overwritten.
+    // The host data is not valid until mirror_fence() returns
+    void mirror_device_to_host( bool dirty_only = true ) {
+      mirror_stream.create();
+      #if defined(YAKL_ARCH_CUDA)
+        cudaEventRecord( mirror_stream.event , 0 );
+        cudaStreamWaitEvent( mirror_stream.stream , mirror_stream.event , 0 );
+      #elif defined(YAKL_ARCH_HIP)
+        hipEventRecord( mirror_stream.event , 0 );
+        hipStreamWaitEvent( mirror_stream.stream , mirror_stream.event , 0 );
+      #else
+        yakl::fence();
+      #endif
+      for (int id=0; id < dm.entries.size(); id++) {
+        int ih = dm_host.find_entry( dm.entries[id].name );
+        if (ih < 0) continue;
+        if (dm_host.entries[ih].read_only) continue;
+        if (dirty_only && ! dm.entries[id].dirty && ! dm.entries[id].untracked_writes) continue;
+        mirror_entry( dm_host.entries[ih] , dm.entries[id] , false );
+      }
+    }
+
+
+    // Wait for outstanding mirror copies to complete. This waits only on the mirror stream, so previously launched
+    // CRM kernels may still be running when it returns
+    void mirror_fence() {
+      if (! mirror_stream.created) return;
+      #if defined(YAKL_ARCH_CUDA)
+        cudaStreamSynchronize( mirror_stream.stream );
+      #elif defined(YAKL_ARCH_HIP)
+        hipStreamSynchronize( mirror_stream.stream );
+      #else
+        yakl::fence();
+      #endif
+    }
+
+
+    // INTERNAL USE: Launch one host<->device copy of a host/device entry pair on the mirror stream, and clear both
+    // dirty flags so the entry isn't bounced back on the next mirror in the other direction
+    void mirror_entry( DataManagerHost::Entry &host_entry , DataManager::Entry &dev_entry , bool host_to_device ) {
+      if ( host_entry.type_hash != dev_entry.type_hash || host_entry.dims != dev_entry.dims ) {
+        endrun("ERROR: Cannot mirror entry "+host_entry.name+": host and device types or dimensions differ");
+      }
+      size_t bytes = dm.get_data_size( dev_entry.dims ) * dev_entry.type_size;
+      #if defined(YAKL_ARCH_CUDA)
+        if (host_to_device) { cudaMemcpyAsync( dev_entry.ptr , host_entry.ptr , bytes , cudaMemcpyHostToDevice , mirror_stream.stream ); }
+        else                { cudaMemcpyAsync( host_entry.ptr , dev_entry.ptr , bytes , cudaMemcpyDeviceToHost , mirror_stream.stream ); }
+      #elif defined(YAKL_ARCH_HIP)
+        if (host_to_device) { hipMemcpyAsync( dev_entry.ptr , host_entry.ptr , bytes , hipMemcpyHostToDevice , mirror_stream.stream ); }
+        else                { hipMemcpyAsync( host_entry.ptr , dev_entry.ptr , bytes , hipMemcpyDeviceToHost , mirror_stream.stream ); }
+      #else
+        // Copy in chunks so each YAKL array stays within int indexing
+        size_t constexpr chunk = std::numeric_limits<int>::max();
+        for (size_t beg=0; beg < bytes; beg += chunk) {
+          int len = (int) std::min( chunk , bytes - beg );
+          Array<char,1,memHost  ,styleC> host( host_entry.name.c_str() , ((char *) host_entry.ptr) + beg , len );
+          Array<char,1,memDevice,styleC> dev ( dev_entry .name.c_str() , ((char *) dev_entry .ptr) + beg , len );
+          if (host_to_device) { host.deep_copy_to(dev ); }
+          else                { dev .deep_copy_to(host); }
+        }
+      #endif
+      host_entry.dirty = false;
+      dev_entry .dirty = false;
+    }
+
+
+
     YAKL_INLINE static real compute_pressure( real rho_d, real rho_v, real T, real R_d, real R_v ) {
       return rho_d*R_d*T + rho_v*R_v*T;
     }
@@ -28,6 +28,18 @@ module pam_fortran_interface
     module procedure pam_finalize
   end interface
 
+  interface pam_mirror_to_device
+    module procedure pam_mirror_to_device
+  end interface
+
+  interface pam_mirror_to_host
+    module procedure pam_mirror_to_host
+  end interface
+
+  interface pam_mirror_fence
+    module procedure pam_mirror_fence
+  end interface
+
   interface pam_register_dimension
     module procedure pam_register_dimension
   end interface
@@ -95,6 +107,24 @@ f.write('''
     end subroutine
   end interface
 
+  interface
+    subroutine pam_mirror_to_device_c(dirty_only) &
+               bind(C,name='pam_interface_mirror_to_device')
+      use iso_c_binding
+      implicit none
+      logical(c_bool), value :: dirty_only
+    end subroutine
+    subroutine pam_mirror_to_host_c(dirty_only) &
+               bind(C,name='pam_interface_mirror_to_host')
+      use iso_c_binding
+      implicit none
+      logical(c_bool), value :: dirty_only
+    end subroutine
+    subroutine pam_mirror_fence_c() &
+               bind(C,name='pam_interface_mirror_fence')
+    end subroutine
+  end interface
+
   interface
     subroutine pam_set_option_logical_c(key,val) &
                bind(C,name='pam_interface_set_option_bool')
@@ -434,6 +464,31 @@ contains
   end subroutine
 
 
+  subroutine pam_mirror_to_device(dirty_only)
+    implicit none
+    logical, intent(in), optional :: dirty_only
+    logical(c_bool) :: dirty_only_loc
+    dirty_only_loc = .true.
+    if (present(dirty_only)) dirty_only_loc = dirty_only
+    call pam_mirror_to_device_c( dirty_only_loc )
+  end subroutine
+
+
+  subroutine pam_mirror_to_host(dirty_only)
+    implicit none
+    logical, intent(in), optional :: dirty_only
+    logical(c_bool) :: dirty_only_loc
+    dirty_only_loc = .true.
+    if (present(dirty_only)) dirty_only_loc = dirty_only
+    call pam_mirror_to_host_c( dirty_only_loc )
+  end subroutine
+
+
+  subroutine pam_mirror_fence()
+    call pam_mirror_fence_c()
+  end subroutine
+
+
   subroutine pam_register_dimension(key,len)
     implicit none
     character(len=*), intent(in) :: key
@@ -5,6 +5,9 @@
 #include "Options.h"
 #include <string>
 #include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
 
 // IMPORTANT: The pam_interface routines only deal with host-side data. These are the GCM-facing routines,
 // and only some of them are callable from Fortran bindings. All routines with Fortran bindings have a comment
@@ -13,25 +16,73 @@
 
 namespace pam_interface {
 
-  // This is a vector because CPU threaded regions will require a different PamCoupler instance for each thread
-  extern std::vector<pam::PamCoupler> couplers;
+  // One PamCoupler per host thread. This is a deque because emplace_back on a deque never moves existing elements,
+  // so a reference handed out to one thread stays valid while other threads create their own couplers
+  extern std::deque<pam::PamCoupler> couplers;
+  // Guards creation and destruction of entries in "couplers". Lookups of an existing coupler never take this lock
+  extern std::mutex                  couplers_mutex;
+  // Incremented by finalize() so that each thread's cached coupler pointer is known to be stale afterward
+  extern std::atomic<unsigned long>  couplers_generation;
 
 
   // This is intended to be called at the end of the simulation, not at the end of every GCM time step
+  // No other thread may be using its coupler while this is called
   // THIS HAS FORTRAN BINDINGS
-  inline void finalize() { couplers.clear(); }
+  inline void finalize() {
+    std::lock_guard<std::mutex> lock(couplers_mutex);
+    couplers.clear();
+    couplers_generation++;
+  }
 
 
   // Obtains the coupler for this thread ID: std::this_thread::get_id()
+  // Each thread caches a pointer to its own coupler, so repeat calls are O(1) and lock-free. Only the first call from
+  // a thread (or the first call after finalize()) takes the lock to find or create its coupler. This makes it safe for
+  // several host threads (e.g., an OpenMP-threaded GCM) to each drive their own coupler concurrently.
   inline pam::PamCoupler & get_coupler() {
+    struct CouplerCache {
+      pam::PamCoupler *coupler    = nullptr;
+      unsigned long    generation = 0;
+    };
+    static thread_local CouplerCache cache;
+    unsigned long generation = couplers_generation.load(std::memory_order_acquire);
+    if (cache.coupler != nullptr && cache.generation == generation) return *cache.coupler;
+
+    std::lock_guard<std::mutex> lock(couplers_mutex);
     std::thread::id tid = std::this_thread::get_id();
-    for (int i=0; i < couplers.size(); i++) { if (tid == couplers[i].get_thread_id()) return couplers[i]; }
-    // If we got here, there isn't a coupler for this thread yet, so let's create one and return it
-    couplers.emplace_back();
-    return couplers.back();
+    pam::PamCoupler *found = nullptr;
+    for (auto &coupler : couplers) { if (tid == coupler.get_thread_id()) { found = &coupler; break; } }
+    // If we got here without a match, there isn't a coupler for this thread yet, so let's create one
+    if (found == nullptr) {
+      couplers.emplace_back();
+      found = &couplers.back();
+    }
+    cache.coupler    = found;
+    cache.generation = couplers_generation.load(std::memory_order_relaxed);
+    return *found;
   }
 
 
+  // Launch copies of this thread's host-side "dm_host" entries into the device-side entries of the same name. This is
+  // intended to be called by the GCM right before running the CRM for a chunk of columns. By default only entries that
+  // may have changed since the last mirror are copied. Kernels launched afterward will see the new data, but the host
+  // data must not change until mirror_fence() returns
+  // THIS HAS FORTRAN BINDINGS
+  inline void mirror_to_device(bool dirty_only = true) { get_coupler().mirror_host_to_device(dirty_only); }
+
+
+  // Launch copies of this thread's device-side entries into the host-side "dm_host" entries of the same name. This is
+  // intended to be called by the GCM right after running the CRM. The copies wait on previously launched kernels, and
+  // the host data is not valid until mirror_fence() returns
+  // THIS HAS FORTRAN BINDINGS
+  inline void mirror_to_host(bool dirty_only = true) { get_coupler().mirror_device_to_host(dirty_only); }
+
+
+  // Wait for this thread's outstanding mirror copies to complete
+  // THIS HAS FORTRAN BINDINGS
+  inline void mirror_fence() { get_coupler().mirror_fence(); }
+
+
   // Register a dimension name in this thread's coupler
   // When you register and allocate an array, the dimensions are named for you. Therefore, this exists to predefine
   // a name for a dimension of a given size so that you have the dimensions names you want.
@@ -66,10 +117,14 @@ namespace pam_interface {
 
 
   // Get an array from the host-side data manager "dm_host" for this thread's coupler
+  // The caller may keep writing through the returned data after this call, so the entry is marked as having
+  // untracked writes, and it is always included when mirroring to the device
   // THIS HAS FORTRAN BINDINGS
   template <class T, int N>
   inline Array<T,N,memHost,styleC> get_array(std::string name) {
-    return get_coupler().get_data_manager_host_readwrite().get<T,N>(name);
+    auto &dm_host = get_coupler().get_data_manager_host_readwrite();
+    dm_host.mark_untracked_writes(name);
+    return dm_host.get<T,N>(name);
   }
 
 
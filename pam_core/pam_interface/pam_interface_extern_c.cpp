@@ -7,6 +7,17 @@ extern "C" void pam_interface_finalize() {
 }
 
 
+extern "C" void pam_interface_mirror_to_device(bool dirty_only) {
+  pam_interface::mirror_to_device(dirty_only);
+}
+extern "C" void pam_interface_mirror_to_host(bool dirty_only) {
+  pam_interface::mirror_to_host(dirty_only);
+}
+extern "C" void pam_interface_mirror_fence() {
+  pam_interface::mirror_fence();
+}
+
+
 extern "C" void pam_interface_mirror_array_readonly_bool(char const *name, char const *desc, int *dims, int ndims, bool *ptr) {
   auto reg = [] (std::string name , std::string desc , std::vector<int> dims , bool *ptr ) {
     pam_interface::register_existing_array<bool const>(name,desc,dims,const_cast<bool const *>(ptr));
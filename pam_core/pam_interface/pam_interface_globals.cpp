@@ -1,10 +1,15 @@
 
 #include "pam_coupler.h"
 #include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
 
 namespace pam_interface {
-  // This is a vector because CPU threaded regions will require a different PamCoupler instance for each thread
-  std::vector<pam::PamCoupler> couplers;
+  // One PamCoupler per host thread. See pam_interface.h for why this is a deque
+  std::deque<pam::PamCoupler> couplers;
+  std::mutex                  couplers_mutex;
+  std::atomic<unsigned long>  couplers_generation(0);
 
   std::function<void()> gcm_initialize = [] () { yakl::yakl_throw("ERROR: user has not set gcm_initialize()"); };
   std::function<void()> gcm_tendency   = [] () { yakl::yakl_throw("ERROR: user has not set gcm_tendency  ()"); };
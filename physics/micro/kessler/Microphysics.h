@@ -2,6 +2,8 @@
 #pragma once
 
 #include "pam_coupler.h"
+#include <algorithm>
+#include <limits>
 
 extern "C" void kessler_fortran(double *theta, double *qv, double *qc, double *qr, double *rho,
                                 double *pk, double &dt, double *z, int &nz, double &precl);
@@ -19,6 +21,7 @@ public:
   real cv_v   ;
   real p0     ;
   real grav   ;
+  real lv     ;
 
   int static constexpr ID_V = 0;  // Local index for water vapor
   int static constexpr ID_C = 1;  // Local index for cloud liquid
@@ -36,6 +39,7 @@ public:
     cv_v    = R_v - cp_v;
     p0      = 1.e5;
     grav    = 9.81;
+    lv      = 2.5e6;
   }
 
 
@@ -172,72 +176,35 @@ public:
 
     auto precl = dm.get_collapsed<real>("precl");
 
-    // #define KESSLER_USE_FORTRAN
-
-    
-    #ifdef KESSLER_USE_FORTRAN
-
-      ////////////////////////////////////////////
-      // Call Fortran Kessler code
-      ////////////////////////////////////////////
-      auto theta_host   = theta  .createHostCopy();
-      auto qv_host      = qv     .createHostCopy();
-      auto qc_host      = qc     .createHostCopy();
-      auto qr_host      = qr     .createHostCopy();
-      auto rho_dry_host = rho_dry.createHostCopy();
-      auto precl_host   = precl  .createHostCopy();
-      auto zmid_host    = zmid   .createHostCopy();
-      auto exner_host   = exner  .createHostCopy();
-      for (int i=0; i < ncol; i++) {
-        realHost1d theta_col("theta_col",nz);
-        realHost1d qv_col   ("qv_col   ",nz);
-        realHost1d qc_col   ("qc_col   ",nz);
-        realHost1d qr_col   ("qr_col   ",nz);
-        realHost1d rho_col  ("rho_col  ",nz);
-        realHost1d zmid_col ("zmid_col ",nz);
-        realHost1d exner_col("exner_col",nz);
-        real precl_col;
-        for (int k=0; k < nz; k++) {
-          theta_col(k) = theta_host  (k,i);
-          qv_col   (k) = qv_host     (k,i);
-          qc_col   (k) = qc_host     (k,i);
-          qr_col   (k) = qr_host     (k,i);
-          rho_col  (k) = rho_dry_host(k,i);
-          zmid_col (k) = zmid_host   (k,i);
-          exner_col(k) = exner_host  (k,i);
-          precl_col    = precl_host  (  i);
-        }
-        kessler_fortran( theta_col.data() , qv_col.data() , qc_col.data() , qr_col.data() , rho_col.data() ,
-                         exner_col.data() , dt , zmid_col.data() , nz , precl_col );
-        for (int k=0; k < nz; k++) {
-          theta_host    (k,i) = theta_col(k);
-          qv_host       (k,i) = qv_col   (k);
-          qc_host       (k,i) = qc_col   (k);
-          qr_host       (k,i) = qr_col   (k);
-          rho_dry_host  (k,i) = rho_col  (k);
-          zmid_host     (k,i) = zmid_col (k);
-          exner_host    (k,i) = exner_col(k);
-          precl_host    (  i) = precl_col;
-        }
-      }
-      theta_host  .deep_copy_to(theta  );
-      qv_host     .deep_copy_to(qv     );
-      qc_host     .deep_copy_to(qc     );
-      qr_host     .deep_copy_to(qr     );
-      rho_dry_host.deep_copy_to(rho_dry);
-      precl_host  .deep_copy_to(precl  );
-      zmid_host   .deep_copy_to(zmid   );
-      exner_host  .deep_copy_to(exner  );
-
-    #else
-
-      ////////////////////////////////////////////
-      // Call C++ Kessler code
-      ////////////////////////////////////////////
-      kessler(theta, qv, qc, qr, rho_dry, precl, zmid, exner, dt, R_d, cp_d, p0);
-
-    #endif
+    // Regression harness: when "kessler_check_fortran" is set, run the device implementation and the original
+    // Fortran scheme on copies of the same inputs, with the device implementation given the constants hard-coded
+    // in kessler.f90, and require them to agree to round-off. This is expensive (host round trip and serial column
+    // loop), so it is only intended for testing. The model state is still advanced with the constants below.
+    if (coupler.get_option<bool>("kessler_check_fortran",false)) {
+      real2d theta_chk = theta.createDeviceCopy();
+      real2d qv_chk    = qv   .createDeviceCopy();
+      real2d qc_chk    = qc   .createDeviceCopy();
+      real2d qr_chk    = qr   .createDeviceCopy();
+      real1d precl_chk = precl.createDeviceCopy();
+      real2d theta_ref = theta.createDeviceCopy();
+      real2d qv_ref    = qv   .createDeviceCopy();
+      real2d qc_ref    = qc   .createDeviceCopy();
+      real2d qr_ref    = qr   .createDeviceCopy();
+      real1d precl_ref = precl.createDeviceCopy();
+      real kappa_f90 = 0.2875_fp;
+      real f5_f90    = 237.3_fp * 17.27_fp * 2500000._fp / 1003._fp;
+      kessler(theta_chk, qv_chk, qc_chk, qr_chk, rho_dry, precl_chk, zmid, exner, dt, 1003._fp, 1.e5_fp,
+              kappa_f90, f5_f90);
+      kessler_fortran_host(theta_ref, qv_ref, qc_ref, qr_ref, rho_dry, precl_ref, zmid, exner, dt);
+      real tol = coupler.get_option<real>("kessler_check_fortran_tol",1000*std::numeric_limits<real>::epsilon());
+      check_against_fortran( "theta" , theta_chk , theta_ref , tol );
+      check_against_fortran( "qv"    , qv_chk    , qv_ref    , tol );
+      check_against_fortran( "qc"    , qc_chk    , qc_ref    , tol );
+      check_against_fortran( "qr"    , qr_chk    , qr_ref    , tol );
+      check_against_fortran( "precl" , precl_chk.reshape(1,ncol) , precl_ref.reshape(1,ncol) , tol );
+    }
 
+    kessler(theta, qv, qc, qr, rho_dry, precl, zmid, exner, dt, cp_d, p0, R_d/cp_d, 4093._fp*lv/cp_d);
 
     parallel_for( "kessler timeStep 3" , SimpleBounds<2>(nz,ncol) , YAKL_LAMBDA (int k, int i) {
       rho_v   (k,i) = qv(k,i)*rho_dry(k,i);
@@ -266,6 +233,80 @@ public:
 
 
 
+  // Runs the original Fortran Kessler scheme (kessler.f90) column by column on the host. This is the reference
+  // implementation for the "kessler_check_fortran" regression check, not a production path.
+  void kessler_fortran_host(real2d const &theta, real2d const &qv, real2d const &qc, real2d const &qr,
+                            realConst2d rho, real1d const &precl, realConst2d z, realConst2d pk, real dt) const {
+    int nz   = theta.dimension[0];
+    int ncol = theta.dimension[1];
+    auto theta_host = theta.createHostCopy();
+    auto qv_host    = qv   .createHostCopy();
+    auto qc_host    = qc   .createHostCopy();
+    auto qr_host    = qr   .createHostCopy();
+    auto rho_host   = rho  .createHostCopy();
+    auto precl_host = precl.createHostCopy();
+    auto z_host     = z    .createHostCopy();
+    auto pk_host    = pk   .createHostCopy();
+    realHost1d theta_col("theta_col",nz);
+    realHost1d qv_col   ("qv_col"   ,nz);
+    realHost1d qc_col   ("qc_col"   ,nz);
+    realHost1d qr_col   ("qr_col"   ,nz);
+    realHost1d rho_col  ("rho_col"  ,nz);
+    realHost1d z_col    ("z_col"    ,nz);
+    realHost1d pk_col   ("pk_col"   ,nz);
+    for (int i=0; i < ncol; i++) {
+      for (int k=0; k < nz; k++) {
+        theta_col(k) = theta_host(k,i);
+        qv_col   (k) = qv_host   (k,i);
+        qc_col   (k) = qc_host   (k,i);
+        qr_col   (k) = qr_host   (k,i);
+        rho_col  (k) = rho_host  (k,i);
+        z_col    (k) = z_host    (k,i);
+        pk_col   (k) = pk_host   (k,i);
+      }
+      real precl_col = precl_host(i);
+      kessler_fortran( theta_col.data() , qv_col.data() , qc_col.data() , qr_col.data() , rho_col.data() ,
+                       pk_col.data() , dt , z_col.data() , nz , precl_col );
+      for (int k=0; k < nz; k++) {
+        theta_host(k,i) = theta_col(k);
+        qv_host   (k,i) = qv_col   (k);
+        qc_host   (k,i) = qc_col   (k);
+        qr_host   (k,i) = qr_col   (k);
+      }
+      precl_host(i) = precl_col;
+    }
+    theta_host.deep_copy_to(theta);
+    qv_host   .deep_copy_to(qv   );
+    qc_host   .deep_copy_to(qc   );
+    qr_host   .deep_copy_to(qr   );
+    precl_host.deep_copy_to(precl);
+  }
+
+
+
+  // Compares the device result against the Fortran reference, normalizing the largest absolute difference by the
+  // largest magnitude of the reference field. With matching constants the two differ only by the order and
+  // library implementation of floating point operations, so the tolerance should be a small multiple of epsilon.
+  void check_against_fortran( std::string label , realConst2d cxx , realConst2d ref , real tol ) const {
+    auto cxx_host = cxx.createHostCopy();
+    auto ref_host = ref.createHostCopy();
+    real maxdiff = 0;
+    real maxref  = 0;
+    for (int k=0; k < cxx_host.dimension[0]; k++) {
+      for (int i=0; i < cxx_host.dimension[1]; i++) {
+        maxdiff = std::max( maxdiff , std::abs( cxx_host(k,i) - ref_host(k,i) ) );
+        maxref  = std::max( maxref  , std::abs( ref_host(k,i) ) );
+      }
+    }
+    real reldiff = maxdiff / ( maxref + 1.e-20 );
+    if (reldiff > tol) {
+      std::cout << "Kessler C++ vs. Fortran relative difference in " << label << ": " << reldiff << std::endl;
+      endrun("ERROR: kessler device implementation does not match the Fortran reference");
+    }
+  }
+
+
+
   ///////////////////////////////////////////////////////////////////////////////
   //
   //  Version:  2.0
@@ -300,9 +341,10 @@ public:
   //     dt    (in   ) - time step (s)
   //     z     (in   ) - heights of thermodynamic levels in the grid column (m)
   //     precl (  out) - Precipitation rate (m_water/s)
-  //     Rd    (in   ) - Dry air ideal gas constant
   //     cp    (in   ) - Specific heat of dry air at constant pressure
   //     p0    (in   ) - Reference pressure (Pa)
+  //     kappa (in   ) - Rd/cp, the exponent of the Exner function
+  //     f5    (in   ) - Saturation adjustment constant (237.3*17.27*lv/cp in KW; 4093*lv/cp here by default)
   //
   // Output variables:
   //     Increments are added into t, qv, qc, qr, and precl which are
@@ -335,7 +377,8 @@ public:
   ///////////////////////////////////////////////////////////////////////////////
 
   void kessler(real2d const &theta, real2d const &qv, real2d const &qc, real2d const &qr, realConst2d rho,
-               real1d const &precl, realConst2d z, realConst2d pk, real dt, real Rd, real cp, real p0) const {
+               real1d const &precl, realConst2d z, realConst2d pk, real dt, real cp, real p0, real kappa,
+               real f5) const {
     int nz = theta.dimension[0];
     int ncol = theta.dimension[1];
 
@@ -344,93 +387,69 @@ public:
 
     real psl    = p0 / 100;  //  pressure at sea level (mb)
     real rhoqr  = 1000._fp;  //  density of liquid water (kg/m^3)
-    real lv     = 2.5e6_fp;  //  latent heat of vaporization (J/kg)
+    real lv     = this->lv;  //  latent heat of vaporization (J/kg)
 
     real2d r    ("r"    ,nz  ,ncol);
     real2d rhalf("rhalf",nz  ,ncol);
     real2d pc   ("pc"   ,nz  ,ncol);
     real2d velqr("velqr",nz  ,ncol);
-    real2d dt2d ("dt2d" ,nz-1,ncol);
 
     parallel_for( "kessler main 1" , SimpleBounds<2>(nz,ncol) , YAKL_LAMBDA (int k, int i) {
       r    (k,i) = 0.001_fp * rho(k,i);
       rhalf(k,i) = sqrt( rho(0,i) / rho(k,i) );
-      pc   (k,i) = 3.8_fp / ( pow( pk(k,i) , cp/Rd ) * psl );
+      pc   (k,i) = 3.8_fp / ( pow( pk(k,i) , 1._fp/kappa ) * psl );
       // Liquid water terminal velocity (m/s) following KW eq. 2.15
       velqr(k,i) = 36.34_fp * pow( qr(k,i)*r(k,i) , 0.1364_fp ) * rhalf(k,i);
-      // Compute maximum stable time step for each cell
-      if (k < nz-1) {
-        if (velqr(k,i) > 1.e-10_fp) {
-          dt2d(k,i) = 0.8_fp * (z(k+1,i)-z(k,i))/velqr(k,i);
-        } else {
-          dt2d(k,i) = dt;
-        }
+    });
+
+    // Each column gets its own number of sedimentation subcycles from its own maximum stable time step, as in
+    // kessler.f90. A heavily precipitating column no longer shrinks the time step of every other column.
+    int1d  rainsplit("rainsplit",ncol);
+    real1d dt0      ("dt0"      ,ncol);
+    parallel_for( "kessler main rainsplit" , ncol , YAKL_LAMBDA (int i) {
+      real dt_max = dt;
+      for (int k=0; k < nz-1; k++) {
+        if (velqr(k,i) > 1.e-10_fp) dt_max = std::min( dt_max , 0.8_fp * (z(k+1,i)-z(k,i))/velqr(k,i) );
       }
+      rainsplit(i) = ceil(dt / dt_max);
+      dt0      (i) = dt / static_cast<real>(rainsplit(i));
       // Initialize precip rate to zero
-      if (k == 0) {
-        precl(i) = 0;
-      }
+      precl(i) = 0;
     });
 
-    // Reduce down the minimum time step among the cells
-    real dt_max = yakl::intrinsics::minval(dt2d);
-
-    // Number of subcycles
-    int rainsplit = ceil(dt / dt_max);
-    real dt0 = dt / static_cast<real>(rainsplit);
+    // Sort the columns by their subcycle count (largest first) so that, at subcycle nt, the columns still needing
+    // work are exactly the first nactive entries of "order". Each launch then covers only those columns instead of
+    // masking out finished ones, so a few heavily precipitating columns no longer drag every column in every ensemble
+    // through the worst-case number of subcycles. The sort is stable, so columns with equal counts stay in memory order.
+    auto rainsplit_host = rainsplit.createHostCopy();
+    intHost1d order_host("order",ncol);
+    for (int i=0; i < ncol; i++) { order_host(i) = i; }
+    std::stable_sort( order_host.data() , order_host.data()+ncol , [&] (int a, int b) {
+      return rainsplit_host(a) > rainsplit_host(b);
+    });
+    auto order = order_host.createDeviceCopy();
+    int max_rainsplit = ncol > 0 ? rainsplit_host(order_host(0)) : 0;
 
     real2d sed("sed",nz,ncol);
 
     // Subcycle through rain process
-    for (int nt=0; nt < rainsplit; nt++) {
+    int nactive = ncol;
+    for (int nt=0; nt < max_rainsplit; nt++) {
+      // Drop the columns that have finished all of their subcycles
+      while (nactive > 0 && rainsplit_host(order_host(nactive-1)) <= nt) { nactive--; }
 
       // Sedimentation term using upstream differencing
-      parallel_for( "kessler main 2" , SimpleBounds<2>(nz,ncol) , YAKL_LAMBDA (int k, int i) {
-        if (k == 0) {
-          // Precipitation rate (m/s)
-          precl(i) = precl(i) + rho(0,i) * qr(0,i) * velqr(0,i) / rhoqr;
-        }
-        if (k == nz-1) {
-          sed(nz-1,i) = -dt0*qr(nz-1,i)*velqr(nz-1,i)/(0.5_fp * (z(nz-1,i)-z(nz-2,i)));
-        } else {
-          sed(k,i) = dt0 * ( r(k+1,i)*qr(k+1,i)*velqr(k+1,i) - 
-                             r(k  ,i)*qr(k  ,i)*velqr(k  ,i) ) / ( r(k,i)*(z(k+1,i)-z(k,i)) );
-        }
+      parallel_for( "kessler main 2" , SimpleBounds<2>(nz,nactive) , YAKL_LAMBDA (int k, int icol) {
+        int i = order(icol);
+        sedimentation( k , i , nz , dt0(i) , rhoqr , qr , r , velqr , rho , z , precl , sed );
       });
 
       // Adjustment terms
-      parallel_for( "kessler main 3" , SimpleBounds<2>(nz,ncol) , YAKL_LAMBDA (int k, int i) {
-        // Autoconversion and accretion rates following KW eq. 2.13a,b
-        real qrprod = qc(k,i) - ( qc(k,i)-dt0*std::max( 0.001_fp * (qc(k,i)-0.001_fp) , 0._fp ) ) /
-                                ( 1 + dt0 * 2.2_fp * pow( qr(k,i) , 0.875_fp ) );
-        qc(k,i) = std::max( qc(k,i)-qrprod , 0._fp );
-        qr(k,i) = std::max( qr(k,i)+qrprod+sed(k,i) , 0._fp );
-
-        // Saturation vapor mixing ratio (gm/gm) following KW eq. 2.11
-        real tmp = pk(k,i)*theta(k,i)-36._fp;
-        real qvs = pc(k,i)*exp( 17.27_fp * (pk(k,i)*theta(k,i)-273._fp) / tmp );
-        real prod = (qv(k,i)-qvs) / (1._fp + qvs*(4093._fp * lv/cp)/(tmp*tmp));
-
-        // Evaporation rate following KW eq. 2.14a,b
-        real tmp1 = dt0*( ( ( 1.6_fp + 124.9_fp * pow( r(k,i)*qr(k,i) , 0.2046_fp ) ) *
-                            pow( r(k,i)*qr(k,i) , 0.525_fp ) ) /
-                          ( 2550000._fp * pc(k,i) / (3.8_fp * qvs)+540000._fp) ) * 
-                        ( std::max(qvs-qv(k,i),0._fp) / (r(k,i)*qvs) );
-        real tmp2 = std::max( -prod-qc(k,i) , 0._fp );
-        real tmp3 = qr(k,i);
-        real ern = std::min( tmp1 , std::min( tmp2 , tmp3 ) );
-
-        // Saturation adjustment following KW eq. 3.10
-        theta(k,i)= theta(k,i) + lv / (cp*pk(k,i)) * 
-                                 ( std::max( prod , -qc(k,i) ) - ern );
-        qv(k,i) = std::max( qv(k,i) - std::max( prod , -qc(k,i) ) + ern , 0._fp );
-        qc(k,i) = qc(k,i) + std::max( prod , -qc(k,i) );
-        qr(k,i) = qr(k,i) - ern;
-
-        // Recalculate liquid water terminal velocity
-        velqr(k,i)  = 36.34_fp * pow( qr(k,i)*r(k,i) , 0.1364_fp ) * rhalf(k,i);
-        if (k == 0 && nt == rainsplit-1) {
-          precl(i) = precl(i) / static_cast<real>(rainsplit);
+      parallel_for( "kessler main 3" , SimpleBounds<2>(nz,nactive) , YAKL_LAMBDA (int k, int icol) {
+        int i = order(icol);
+        adjustment( k , i , dt0(i) , lv , cp , f5 , theta , qv , qc , qr , r , rhalf , pc , pk , sed , velqr );
+        if (k == 0 && nt == rainsplit(i)-1) {
+          precl(i) = precl(i) / static_cast<real>(rainsplit(i));
         }
       });
 
@@ -440,6 +459,62 @@ public:
 
 
 
+  // Sedimentation tendency for one cell of one subcycle (upstream differencing) and the surface precip rate
+  YAKL_INLINE static void sedimentation( int k , int i , int nz , real dt0 , real rhoqr , real2d const &qr ,
+                                         real2d const &r , real2d const &velqr , realConst2d const &rho ,
+                                         realConst2d const &z , real1d const &precl , real2d const &sed ) {
+    if (k == 0) {
+      // Precipitation rate (m/s)
+      precl(i) = precl(i) + rho(0,i) * qr(0,i) * velqr(0,i) / rhoqr;
+    }
+    if (k == nz-1) {
+      sed(nz-1,i) = -dt0*qr(nz-1,i)*velqr(nz-1,i)/(0.5_fp * (z(nz-1,i)-z(nz-2,i)));
+    } else {
+      sed(k,i) = dt0 * ( r(k+1,i)*qr(k+1,i)*velqr(k+1,i) - 
+                         r(k  ,i)*qr(k  ,i)*velqr(k  ,i) ) / ( r(k,i)*(z(k+1,i)-z(k,i)) );
+    }
+  }
+
+
+
+  // Autoconversion, accretion, evaporation and saturation adjustment for one cell of one subcycle
+  YAKL_INLINE static void adjustment( int k , int i , real dt0 , real lv , real cp , real f5 , real2d const &theta ,
+                                      real2d const &qv , real2d const &qc , real2d const &qr , real2d const &r ,
+                                      real2d const &rhalf , real2d const &pc , realConst2d const &pk ,
+                                      real2d const &sed , real2d const &velqr ) {
+    // Autoconversion and accretion rates following KW eq. 2.13a,b
+    real qrprod = qc(k,i) - ( qc(k,i)-dt0*std::max( 0.001_fp * (qc(k,i)-0.001_fp) , 0._fp ) ) /
+                            ( 1 + dt0 * 2.2_fp * pow( qr(k,i) , 0.875_fp ) );
+    qc(k,i) = std::max( qc(k,i)-qrprod , 0._fp );
+    qr(k,i) = std::max( qr(k,i)+qrprod+sed(k,i) , 0._fp );
+
+    // Saturation vapor mixing ratio (gm/gm) following KW eq. 2.11
+    real tmp = pk(k,i)*theta(k,i)-36._fp;
+    real qvs = pc(k,i)*exp( 17.27_fp * (pk(k,i)*theta(k,i)-273._fp) / tmp );
+    real prod = (qv(k,i)-qvs) / (1._fp + qvs*f5/(tmp*tmp));
+
+    // Evaporation rate following KW eq. 2.14a,b
+    real tmp1 = dt0*( ( ( 1.6_fp + 124.9_fp * pow( r(k,i)*qr(k,i) , 0.2046_fp ) ) *
+                        pow( r(k,i)*qr(k,i) , 0.525_fp ) ) /
+                      ( 2550000._fp * pc(k,i) / (3.8_fp * qvs)+540000._fp) ) * 
+                    ( std::max(qvs-qv(k,i),0._fp) / (r(k,i)*qvs) );
+    real tmp2 = std::max( -prod-qc(k,i) , 0._fp );
+    real tmp3 = qr(k,i);
+    real ern = std::min( tmp1 , std::min( tmp2 , tmp3 ) );
+
+    // Saturation adjustment following KW eq. 3.10
+    theta(k,i)= theta(k,i) + lv / (cp*pk(k,i)) * 
+                             ( std::max( prod , -qc(k,i) ) - ern );
+    qv(k,i) = std::max( qv(k,i) - std::max( prod , -qc(k,i) ) + ern , 0._fp );
+    qc(k,i) = qc(k,i) + std::max( prod , -qc(k,i) );
+    qr(k,i) = qr(k,i) - ern;
+
+    // Recalculate liquid water terminal velocity
+    velqr(k,i)  = 36.34_fp * pow( qr(k,i)*r(k,i) , 0.1364_fp ) * rhalf(k,i);
+  }
+
+
+
   std::string micro_name() const {
     return "kessler";
   }
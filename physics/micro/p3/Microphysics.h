@@ -2,6 +2,7 @@
 #pragma once
 
 #include "pam_coupler.h"
+#include <map>
 // #include <stdio.h>
 
 #include "scream_cxx_interface_p3.h"
@@ -56,6 +57,10 @@ public:
 
   real etime;
 
+  // Work arrays that persist across calls to timeStep, keyed by name, so that micro steps do not allocate
+  std::map<std::string,real1d> scratch1d;
+  std::map<std::string,real2d> scratch2d;
+
   // Indices for all of your tracer quantities
   int static constexpr ID_C  = 0;  // Local index for Cloud Water Mass
   int static constexpr ID_NC = 1;  // Local index for Cloud Water Number
@@ -261,7 +266,7 @@ public:
     auto temp    = dm.get_lev_col<real>("temp"       );
 
     // Set grid spacing
-    real2d dz("dz",nz,ny*nx*nens);
+    auto dz = get_scratch("dz",nz,ny*nx*nens);
     parallel_for( "micro dz" , SimpleBounds<4>(nz,ny,nx,nens) ,
                   YAKL_LAMBDA (int k, int j, int i, int iens) {
       dz(k,j*nx*nens + i*nens + iens) = zint_in(k+1,iens) - zint_in(k,iens);
@@ -271,42 +276,42 @@ public:
     auto q_prev = dm.get_lev_col<real>("q_prev");
     auto t_prev = dm.get_lev_col<real>("t_prev" );
 
-    // Allocates inputs and outputs
-    real2d qc                ( "qc"                 ,           nz   , ncol );
-    real2d nc                ( "nc"                 ,           nz   , ncol );
-    real2d qr                ( "qr"                 ,           nz   , ncol );
-    real2d nr                ( "nr"                 ,           nz   , ncol );
-    real2d qi                ( "qi"                 ,           nz   , ncol );
-    real2d ni                ( "ni"                 ,           nz   , ncol );
-    real2d qm                ( "qm"                 ,           nz   , ncol );
-    real2d bm                ( "bm"                 ,           nz   , ncol );
-    real2d qv                ( "qv"                 ,           nz   , ncol );
-    real2d pressure_dry      ( "pressure_dry"       ,           nz   , ncol );
-    real2d theta             ( "theta"              ,           nz   , ncol );
-    real2d exner             ( "exner"              ,           nz   , ncol );
-    real2d inv_exner         ( "inv_exner"          ,           nz   , ncol );
-    real2d dpres_dry         ( "dpres_dry"          ,           nz   , ncol );
-    real2d cld_frac_i        ( "cld_frac_i"         ,           nz   , ncol );
-    real2d cld_frac_l        ( "cld_frac_l"         ,           nz   , ncol );
-    real2d cld_frac_r        ( "cld_frac_r"         ,           nz   , ncol );
-    real2d inv_qc_relvar     ( "inv_qc_relvar"      ,           nz   , ncol );
-    real2d col_location      ( "col_location"       ,           3    , ncol );
-    real1d precip_liq_surf   ( "precip_liq_surf"    ,                  ncol );
-    real1d precip_ice_surf   ( "precip_ice_surf"    ,                  ncol );
-    real2d diag_eff_radius_qc( "diag_eff_radius_qc" ,           nz   , ncol );
-    real2d diag_eff_radius_qi( "diag_eff_radius_qi" ,           nz   , ncol );
-    real2d bulk_qi           ( "bulk_qi"            ,           nz   , ncol );
-    real2d mu_c              ( "mu_c"               ,           nz   , ncol );
-    real2d lamc              ( "lamc"               ,           nz   , ncol );
-    real2d qv2qi_depos_tend  ( "qv2qi_depos_tend"   ,           nz   , ncol );
-    real2d precip_total_tend ( "precip_total_tend"  ,           nz   , ncol );
-    real2d nevapr            ( "nevapr"             ,           nz   , ncol );
-    real2d qr_evap_tend      ( "qr_evap_tend"       ,           nz   , ncol );
-    real2d precip_liq_flux   ( "precip_liq_flux"    ,           nz+1 , ncol );
-    real2d precip_ice_flux   ( "precip_ice_flux"    ,           nz+1 , ncol );
-    real2d liq_ice_exchange  ( "liq_ice_exchange"   ,           nz   , ncol );
-    real2d vap_liq_exchange  ( "vap_liq_exchange"   ,           nz   , ncol );
-    real2d vap_ice_exchange  ( "vap_ice_exchange"   ,           nz   , ncol );
+    // Inputs and outputs. These persist across calls, so they are only allocated on the first step
+    auto qc                 = get_scratch( "qc"                 ,           nz   , ncol );
+    auto nc                 = get_scratch( "nc"                 ,           nz   , ncol );
+    auto qr                 = get_scratch( "qr"                 ,           nz   , ncol );
+    auto nr                 = get_scratch( "nr"                 ,           nz   , ncol );
+    auto qi                 = get_scratch( "qi"                 ,           nz   , ncol );
+    auto ni                 = get_scratch( "ni"                 ,           nz   , ncol );
+    auto qm                 = get_scratch( "qm"                 ,           nz   , ncol );
+    auto bm                 = get_scratch( "bm"                 ,           nz   , ncol );
+    auto qv                 = get_scratch( "qv"                 ,           nz   , ncol );
+    auto pressure_dry       = get_scratch( "pressure_dry"       ,           nz   , ncol );
+    auto theta              = get_scratch( "theta"              ,           nz   , ncol );
+    auto exner              = get_scratch( "exner"              ,           nz   , ncol );
+    auto inv_exner          = get_scratch( "inv_exner"          ,           nz   , ncol );
+    auto dpres_dry          = get_scratch( "dpres_dry"          ,           nz   , ncol );
+    auto cld_frac_i         = get_scratch( "cld_frac_i"         ,           nz   , ncol );
+    auto cld_frac_l         = get_scratch( "cld_frac_l"         ,           nz   , ncol );
+    auto cld_frac_r         = get_scratch( "cld_frac_r"         ,           nz   , ncol );
+    auto inv_qc_relvar      = get_scratch( "inv_qc_relvar"      ,           nz   , ncol );
+    auto col_location       = get_scratch( "col_location"       ,           3    , ncol );
+    auto precip_liq_surf    = get_scratch( "precip_liq_surf"    ,                  ncol );
+    auto precip_ice_surf    = get_scratch( "precip_ice_surf"    ,                  ncol );
+    auto diag_eff_radius_qc = get_scratch( "diag_eff_radius_qc" ,           nz   , ncol );
+    auto diag_eff_radius_qi = get_scratch( "diag_eff_radius_qi" ,           nz   , ncol );
+    auto bulk_qi            = get_scratch( "bulk_qi"            ,           nz   , ncol );
+    auto mu_c               = get_scratch( "mu_c"               ,           nz   , ncol );
+    auto lamc               = get_scratch( "lamc"               ,           nz   , ncol );
+    auto qv2qi_depos_tend   = get_scratch( "qv2qi_depos_tend"   ,           nz   , ncol );
+    auto precip_total_tend  = get_scratch( "precip_total_tend"  ,           nz   , ncol );
+    auto nevapr             = get_scratch( "nevapr"             ,           nz   , ncol );
+    auto qr_evap_tend       = get_scratch( "qr_evap_tend"       ,           nz   , ncol );
+    auto precip_liq_flux    = get_scratch( "precip_liq_flux"    ,           nz+1 , ncol );
+    auto precip_ice_flux    = get_scratch( "precip_ice_flux"    ,           nz+1 , ncol );
+    auto liq_ice_exchange   = get_scratch( "liq_ice_exchange"   ,           nz   , ncol );
+    auto vap_liq_exchange   = get_scratch( "vap_liq_exchange"   ,           nz   , ncol );
+    auto vap_ice_exchange   = get_scratch( "vap_ice_exchange"   ,           nz   , ncol );
     #ifndef P3_CXX
     int p3_nout = 49;
     real3d p3_tend_out       ( "p3_tend_out"        , p3_nout , nz   , ncol );
@@ -410,40 +415,41 @@ public:
       kts = 0;
       kte = nz-1;
 
-      // Create room for transposed variables (only 2-D variables need to be transposed)
-      auto transposed_qc                 = qc                .createDeviceCopy().reshape(qc                .extent(1),qc                .extent(0)); // inout
-      auto transposed_nc                 = nc                .createDeviceCopy().reshape(nc                .extent(1),nc                .extent(0)); // inout
-      auto transposed_qr                 = qr                .createDeviceCopy().reshape(qr                .extent(1),qr                .extent(0)); // inout
-      auto transposed_nr                 = nr                .createDeviceCopy().reshape(nr                .extent(1),nr                .extent(0)); // inout
-      auto transposed_theta              = theta             .createDeviceCopy().reshape(theta             .extent(1),theta             .extent(0)); // inout
-      auto transposed_qv                 = qv                .createDeviceCopy().reshape(qv                .extent(1),qv                .extent(0)); // inout
-      auto transposed_qi                 = qi                .createDeviceCopy().reshape(qi                .extent(1),qi                .extent(0)); // inout
-      auto transposed_qm                 = qm                .createDeviceCopy().reshape(qm                .extent(1),qm                .extent(0)); // inout
-      auto transposed_ni                 = ni                .createDeviceCopy().reshape(ni                .extent(1),ni                .extent(0)); // inout
-      auto transposed_bm                 = bm                .createDeviceCopy().reshape(bm                .extent(1),bm                .extent(0)); // inout
-      auto transposed_pressure_dry       = pressure_dry      .createDeviceCopy().reshape(pressure_dry      .extent(1),pressure_dry      .extent(0)); // in
-      auto transposed_dz                 = dz                .createDeviceCopy().reshape(dz                .extent(1),dz                .extent(0)); // in
-      auto transposed_nc_nuceat_tend     = nc_nuceat_tend    .createDeviceCopy().reshape(nc_nuceat_tend    .extent(1),nc_nuceat_tend    .extent(0)); // in
-      auto transposed_nccn_prescribed    = nccn_prescribed   .createDeviceCopy().reshape(nccn_prescribed   .extent(1),nccn_prescribed   .extent(0)); // in
-      auto transposed_ni_activated       = ni_activated      .createDeviceCopy().reshape(ni_activated      .extent(1),ni_activated      .extent(0)); // in
-      auto transposed_inv_qc_relvar      = inv_qc_relvar     .createDeviceCopy().reshape(inv_qc_relvar     .extent(1),inv_qc_relvar     .extent(0)); // in
-      auto transposed_dpres_dry          = dpres_dry         .createDeviceCopy().reshape(dpres_dry         .extent(1),dpres_dry         .extent(0)); // in
-      auto transposed_inv_exner          = inv_exner         .createDeviceCopy().reshape(inv_exner         .extent(1),inv_exner         .extent(0)); // in
-      auto transposed_cld_frac_r         = cld_frac_r        .createDeviceCopy().reshape(cld_frac_r        .extent(1),cld_frac_r        .extent(0)); // in
-      auto transposed_cld_frac_l         = cld_frac_l        .createDeviceCopy().reshape(cld_frac_l        .extent(1),cld_frac_l        .extent(0)); // in
-      auto transposed_cld_frac_i         = cld_frac_i        .createDeviceCopy().reshape(cld_frac_i        .extent(1),cld_frac_i        .extent(0)); // in
-      auto transposed_q_prev             = q_prev            .createDeviceCopy().reshape(q_prev            .extent(1),q_prev            .extent(0)); // in
-      auto transposed_t_prev             = t_prev            .createDeviceCopy().reshape(t_prev            .extent(1),t_prev            .extent(0)); // in
-      auto transposed_col_location       = col_location      .createDeviceCopy().reshape(col_location      .extent(1),col_location      .extent(0)); // in
-      auto transposed_diag_eff_radius_qc = diag_eff_radius_qc.createDeviceCopy().reshape(diag_eff_radius_qc.extent(1),diag_eff_radius_qc.extent(0)); //   out
-      auto transposed_diag_eff_radius_qi = diag_eff_radius_qi.createDeviceCopy().reshape(diag_eff_radius_qi.extent(1),diag_eff_radius_qi.extent(0)); //   out
-      auto transposed_bulk_qi            = bulk_qi           .createDeviceCopy().reshape(bulk_qi           .extent(1),bulk_qi           .extent(0)); //   out
-      auto transposed_qv2qi_depos_tend   = qv2qi_depos_tend  .createDeviceCopy().reshape(qv2qi_depos_tend  .extent(1),qv2qi_depos_tend  .extent(0)); //   out
-      auto transposed_precip_liq_flux    = precip_liq_flux   .createDeviceCopy().reshape(precip_liq_flux   .extent(1),precip_liq_flux   .extent(0)); //   out
-      auto transposed_precip_ice_flux    = precip_ice_flux   .createDeviceCopy().reshape(precip_ice_flux   .extent(1),precip_ice_flux   .extent(0)); //   out
-      auto transposed_liq_ice_exchange   = liq_ice_exchange  .createDeviceCopy().reshape(liq_ice_exchange  .extent(1),liq_ice_exchange  .extent(0)); //   out
-      auto transposed_vap_liq_exchange   = vap_liq_exchange  .createDeviceCopy().reshape(vap_liq_exchange  .extent(1),vap_liq_exchange  .extent(0)); //   out
-      auto transposed_vap_ice_exchange   = vap_ice_exchange  .createDeviceCopy().reshape(vap_ice_exchange  .extent(1),vap_ice_exchange  .extent(0)); //   out
+      // Persistent (ncol,nz) buffers in the layout P3 expects (only 2-D variables need to be transposed). These are
+      // allocated on the first step only, and the fused kernels below are the only per-step cost of the transposition
+      auto transposed_qc                 = get_scratch( "transposed_qc"                 , qc                .extent(1) , qc                .extent(0) ); // inout
+      auto transposed_nc                 = get_scratch( "transposed_nc"                 , nc                .extent(1) , nc                .extent(0) ); // inout
+      auto transposed_qr                 = get_scratch( "transposed_qr"                 , qr                .extent(1) , qr                .extent(0) ); // inout
+      auto transposed_nr                 = get_scratch( "transposed_nr"                 , nr                .extent(1) , nr                .extent(0) ); // inout
+      auto transposed_theta              = get_scratch( "transposed_theta"              , theta             .extent(1) , theta             .extent(0) ); // inout
+      auto transposed_qv                 = get_scratch( "transposed_qv"                 , qv                .extent(1) , qv                .extent(0) ); // inout
+      auto transposed_qi                 = get_scratch( "transposed_qi"                 , qi                .extent(1) , qi                .extent(0) ); // inout
+      auto transposed_qm                 = get_scratch( "transposed_qm"                 , qm                .extent(1) , qm                .extent(0) ); // inout
+      auto transposed_ni                 = get_scratch( "transposed_ni"                 , ni                .extent(1) , ni                .extent(0) ); // inout
+      auto transposed_bm                 = get_scratch( "transposed_bm"                 , bm                .extent(1) , bm                .extent(0) ); // inout
+      auto transposed_pressure_dry       = get_scratch( "transposed_pressure_dry"       , pressure_dry      .extent(1) , pressure_dry      .extent(0) ); // in
+      auto transposed_dz                 = get_scratch( "transposed_dz"                 , dz                .extent(1) , dz                .extent(0) ); // in
+      auto transposed_nc_nuceat_tend     = get_scratch( "transposed_nc_nuceat_tend"     , nc_nuceat_tend    .extent(1) , nc_nuceat_tend    .extent(0) ); // in
+      auto transposed_nccn_prescribed    = get_scratch( "transposed_nccn_prescribed"    , nccn_prescribed   .extent(1) , nccn_prescribed   .extent(0) ); // in
+      auto transposed_ni_activated       = get_scratch( "transposed_ni_activated"       , ni_activated      .extent(1) , ni_activated      .extent(0) ); // in
+      auto transposed_inv_qc_relvar      = get_scratch( "transposed_inv_qc_relvar"      , inv_qc_relvar     .extent(1) , inv_qc_relvar     .extent(0) ); // in
+      auto transposed_dpres_dry          = get_scratch( "transposed_dpres_dry"          , dpres_dry         .extent(1) , dpres_dry         .extent(0) ); // in
+      auto transposed_inv_exner          = get_scratch( "transposed_inv_exner"          , inv_exner         .extent(1) , inv_exner         .extent(0) ); // in
+      auto transposed_cld_frac_r         = get_scratch( "transposed_cld_frac_r"         , cld_frac_r        .extent(1) , cld_frac_r        .extent(0) ); // in
+      auto transposed_cld_frac_l         = get_scratch( "transposed_cld_frac_l"         , cld_frac_l        .extent(1) , cld_frac_l        .extent(0) ); // in
+      auto transposed_cld_frac_i         = get_scratch( "transposed_cld_frac_i"         , cld_frac_i        .extent(1) , cld_frac_i        .extent(0) ); // in
+      auto transposed_q_prev             = get_scratch( "transposed_q_prev"             , q_prev            .extent(1) , q_prev            .extent(0) ); // in
+      auto transposed_t_prev             = get_scratch( "transposed_t_prev"             , t_prev            .extent(1) , t_prev            .extent(0) ); // in
+      auto transposed_col_location       = get_scratch( "transposed_col_location"       , col_location      .extent(1) , col_location      .extent(0) ); // in
+      auto transposed_diag_eff_radius_qc = get_scratch( "transposed_diag_eff_radius_qc" , diag_eff_radius_qc.extent(1) , diag_eff_radius_qc.extent(0) ); //   out
+      auto transposed_diag_eff_radius_qi = get_scratch( "transposed_diag_eff_radius_qi" , diag_eff_radius_qi.extent(1) , diag_eff_radius_qi.extent(0) ); //   out
+      auto transposed_bulk_qi            = get_scratch( "transposed_bulk_qi"            , bulk_qi           .extent(1) , bulk_qi           .extent(0) ); //   out
+      auto transposed_qv2qi_depos_tend   = get_scratch( "transposed_qv2qi_depos_tend"   , qv2qi_depos_tend  .extent(1) , qv2qi_depos_tend  .extent(0) ); //   out
+      auto transposed_precip_liq_flux    = get_scratch( "transposed_precip_liq_flux"    , precip_liq_flux   .extent(1) , precip_liq_flux   .extent(0) ); //   out
+      auto transposed_precip_ice_flux    = get_scratch( "transposed_precip_ice_flux"    , precip_ice_flux   .extent(1) , precip_ice_flux   .extent(0) ); //   out
+      auto transposed_liq_ice_exchange   = get_scratch( "transposed_liq_ice_exchange"   , liq_ice_exchange  .extent(1) , liq_ice_exchange  .extent(0) ); //   out
+      auto transposed_vap_liq_exchange   = get_scratch( "transposed_vap_liq_exchange"   , vap_liq_exchange  .extent(1) , vap_liq_exchange  .extent(0) ); //   out
+      auto transposed_vap_ice_exchange   = get_scratch( "transposed_vap_ice_exchange"   , vap_ice_exchange  .extent(1) , vap_ice_exchange  .extent(0) ); //   out
 
       // For in and inout variables, copy transposed data (One kernel for efficiency)
       parallel_for( SimpleBounds<2>(nz,ncol) , YAKL_LAMBDA (int k, int i) {
@@ -726,6 +732,24 @@ public:
 
 
 
+  // Returns the persistent work array with this name, allocating it only on first use or if its size changed
+  real1d get_scratch( std::string name , int d0 ) {
+    auto it = scratch1d.emplace(name,real1d()).first;
+    if (! it->second.initialized() || it->second.extent(0) != d0) {
+      it->second = real1d(it->first.c_str(),d0);
+    }
+    return it->second;
+  }
+  real2d get_scratch( std::string name , int d0 , int d1 ) {
+    auto it = scratch2d.emplace(name,real2d()).first;
+    if (! it->second.initialized() || it->second.extent(0) != d0 || it->second.extent(1) != d1) {
+      it->second = real2d(it->first.c_str(),d0,d1);
+    }
+    return it->second;
+  }
+
+
+
   // Returns saturation vapor pressure
   YAKL_INLINE static real saturation_vapor_pressure(real temp) {
     real tc = temp - 273.15;
@@ -103,6 +103,8 @@ int main(int argc, char** argv) {
     auto dt_crm_phys       = config["dt_crm_phys"      ].as<real>();
     auto out_freq          = config["out_freq"         ].as<real>();
     auto out_prefix        = config["out_prefix"       ].as<std::string>();
+    auto out_ranks_per_file= config["out_ranks_per_file"].as<int>(1);
+    auto out_async         = config["out_async"        ].as<bool>(false);
     auto inner_mpi         = config["inner_mpi"        ].as<bool>(false);
     auto vcoords_file      = config["vcoords"          ].as<std::string>();
 
@@ -121,6 +123,16 @@ int main(int argc, char** argv) {
 
     coupler.set_option<real>("gcm_physics_dt",dt_gcm);
     coupler.set_option<real>("crm_dt",dt_crm_phys);
+    if (config["awfl_time_integrator"]) {
+      coupler.set_option<std::string>("awfl_time_integrator",config["awfl_time_integrator"].as<std::string>());
+    }
+    coupler.set_option<bool>("validate_every_module",config["validate_every_module"].as<bool>(false));
+    if (config["kessler_check_fortran"]) {
+      coupler.set_option<bool>("kessler_check_fortran",config["kessler_check_fortran"].as<bool>());
+    }
+    if (config["kessler_check_fortran_tol"]) {
+      coupler.set_option<real>("kessler_check_fortran_tol",config["kessler_check_fortran_tol"].as<real>());
+    }
     
     if (idealized) {
       // This is for the dycore to pull out to determine how to do idealized test cases
@@ -156,6 +168,7 @@ int main(int argc, char** argv) {
     } else {
       // Read vertical coordinates
       //THIS IS BROKEN FOR PARALLEL IO CASE- maybe this is okay ie switch entirely to standard netcdf?
+      std::lock_guard<std::mutex> lock(pam::netcdf_mutex());
       yakl::SimpleNetCDF nc;
       nc.open(vcoords_file);
       crm_nz = nc.getDimSize("num_interfaces") - 1;
@@ -170,7 +183,20 @@ int main(int argc, char** argv) {
     }
 
     if (inner_mpi) {
+      int crm_nx_glob = crm_nx;
+      int crm_ny_glob = crm_ny;
       partition_domain(inFile, crm_nx, crm_ny);
+      // Describe the decomposition for the dycore. The coupler holds this process's part of the domain
+      coupler.set_option<bool>("inner_mpi"  ,true                       );
+      coupler.set_option<int >("nprocx"     ,config["nprocx"].as<int>());
+      coupler.set_option<int >("nprocy"     ,config["nprocy"].as<int>());
+      coupler.set_option<int >("crm_nx_glob",crm_nx_glob                );
+      coupler.set_option<int >("crm_ny_glob",crm_ny_glob                );
+      #ifdef PAM_DYCORE_AWFL
+        // AWFL expects per-process domain lengths so that the coupler's dx and dy are correct
+        xlen = xlen * crm_nx / crm_nx_glob;
+        ylen = ylen * crm_ny / crm_ny_glob;
+      #endif
     }
 
     // Allocates the coupler state (density_dry, uvel, vvel, wvel, temp, vert grid, hydro background) for thread 0
@@ -225,7 +251,11 @@ int main(int argc, char** argv) {
     int  num_out = 0;
 
     // Output the initial state
-    if (out_freq >= 0. ) output( coupler , out_prefix , etime_gcm );
+    OutputWriter output;
+    if (out_freq >= 0. ) {
+      output.initialize( coupler , out_prefix , out_ranks_per_file , out_async );
+      output.write( coupler , etime_gcm );
+    }
 
     yakl::fence();
     auto ts = std::chrono::steady_clock::now();
@@ -252,7 +282,7 @@ int main(int argc, char** argv) {
 
         if (out_freq >= 0. && etime_gcm / out_freq >= num_out+1) {
           yakl::timer_start("output");
-          output( coupler , out_prefix , etime_gcm);
+          output.write( coupler , etime_gcm );
           yakl::timer_stop("output");
     
           auto &dm = coupler.get_data_manager_device_readonly();
@@ -269,6 +299,8 @@ int main(int argc, char** argv) {
 
     yakl::timer_stop("main_loop");
     yakl::fence();
+
+    output.finalize();
     auto te = std::chrono::steady_clock::now();
 
     auto runtime = std::chrono::duration<double>(te - ts).count();
@@ -276,6 +308,9 @@ int main(int argc, char** argv) {
     if (mainproc) {
       std::cout << "Simulation Time: " << etime_gcm << "\n";
       std::cout << "Run Time: " << runtime << "\n";
+      #ifdef PAM_DYCORE_AWFL
+        std::cout << "Dycore workspace allocations inside the time loop: " << dycore.get_num_time_loop_allocations() << "\n";
+      #endif
     }
 
     dycore.finalize( coupler );
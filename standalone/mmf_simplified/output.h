@@ -3,121 +3,318 @@
 
 #include "mpi.h"
 #include "pam_coupler.h"
+#include "async_writer.h"
 #include "YAKL_netcdf.h"
 
-inline void output( pam::PamCoupler const &coupler , std::string out_prefix , real etime ) {
-  using yakl::c::parallel_for;
-  using yakl::c::SimpleBounds;
-
-  int nranks;
-  int myrank;
-  MPI_Comm_size( MPI_COMM_WORLD , &nranks );
-  MPI_Comm_rank( MPI_COMM_WORLD , &myrank );
-
-  auto dx = coupler.get_dx();
-  auto dy = coupler.get_dy();
-  auto nx = coupler.get_nx();
-  auto ny = coupler.get_ny();
-  auto nz = coupler.get_nz();
-  auto nens = coupler.get_nens();
-
-  auto &dm = coupler.get_data_manager_device_readonly();
-
-  MPI_Barrier(MPI_COMM_WORLD);
-  for (int rr=0; rr < nranks; rr++) {
-    MPI_Barrier(MPI_COMM_WORLD);
-    if (rr == myrank) {
-
-
-
-      std::string fname = out_prefix + std::string("_") + std::to_string(myrank) + std::string(".nc");
-
-      yakl::SimpleNetCDF nc;
-      int ulIndex = 0; // Unlimited dimension index to place this data at
-      // Create or open the file
-      if (etime == 0.) {
-        nc.create(fname);
-
-        // x-coordinate
-        real1d xloc("xloc",nx);
-        real1d xp1loc("xp1loc",nx+1);
-        parallel_for( "Spatial.h output 1" , nx , YAKL_LAMBDA (int i) { xloc(i) = (i+0.5)*dx; });
-        parallel_for( "Spatial.h output 2" , nx+1 , YAKL_LAMBDA (int i) { xp1loc(i) = (i)*dx; });
-        nc.write(xloc.createHostCopy(),"x",{"x"});
-        nc.write(xp1loc.createHostCopy(),"xp1",{"xp1"});
-
-        // y-coordinate
-        real1d yloc("yloc",ny);
-        real1d yp1loc("yp1loc",ny+1);
-        parallel_for( "Spatial.h output 3" , ny , YAKL_LAMBDA (int i) { yloc(i) = (i+0.5)*dy; });
-        parallel_for( "Spatial.h output 4" , ny+1 , YAKL_LAMBDA (int i) { yp1loc(i) = (i)*dy; });
-        nc.write(yloc.createHostCopy(),"y",{"y"});
-        nc.write(yp1loc.createHostCopy(),"yp1",{"yp1"});
-
-        // z-coordinate
-        auto zint = dm.get<real const,2>("vertical_interface_height");
-        auto dz = dm.get<real const,2>("vertical_cell_dz");
-        auto zmid = dm.get<real const,2>("vertical_midpoint_height");
-        nc.write(zmid.createHostCopy(),"z", {"z","nens"});
-        nc.write(dz.createHostCopy(),"dz", {"z","nens"});
-        nc.write(zint.createHostCopy(),"zp1", {"zp1","nens"});
-
-        // Create time variable
-        nc.write1(0._fp,"t",0,"t");
-      } else {
-        nc.open(fname,yakl::NETCDF_MODE_WRITE);
-        ulIndex = nc.getDimSize("t");
-
-        // Write the elapsed time
-        nc.write1(etime,"t",ulIndex,"t");
-      }
 
-      std::vector<std::string> tracer_names = coupler.get_tracer_names();
-      int num_tracers = coupler.get_num_tracers();
-      // Create MultiField of all state and tracer full variables, since we're doing the same operation on each
-      pam::MultiField<real const,4> fields;
-      fields.add_field( dm.get<real const,4>("density_dry") );
-      fields.add_field( dm.get<real const,4>("uvel"       ) );
-      fields.add_field( dm.get<real const,4>("vvel"       ) );
-      fields.add_field( dm.get<real const,4>("wvel"       ) );
-      fields.add_field( dm.get<real const,4>("temp"       ) );
-      for (int tr=0; tr < num_tracers; tr++) {
-        fields.add_field( dm.get<real const,4>(tracer_names[tr]) );
+// Writes the coupler state at every output time. Ranks are split into groups of ranks_per_file
+// consecutive ranks. Each group gathers its snapshot to the group's first rank, which writes one
+// file holding the ensembles of every rank in the group stacked along "nens" (ens_rank and
+// ens_index record where each entry came from), so all ranks in a group must have the same nx and
+// ny. All groups write at the same time, and with ranks_per_file == 1 every rank writes its own
+// file as before. The main loop pays for one device-to-host snapshot and the gather. With async
+// the NetCDF work runs on a pam::AsyncWriter thread from one of two host buffers, so the loop only
+// waits when both are still being written
+class OutputWriter {
+public:
+  std::string out_prefix;
+  bool async;
+  bool created;
+  int  nx, ny, nz, nens;
+  real dx, dy;
+
+  MPI_Comm     group_comm;
+  MPI_Datatype mpi_real;
+  int  ranks_per_file;
+  int  group;
+  int  group_rank;
+  int  group_size;
+  int  group_nens;
+  std::vector<int> rank_nens;     // ensembles of each rank in the group
+  std::vector<int> rank_nx;       // horizontal extents of each rank in the group
+  std::vector<int> rank_ny;
+  std::vector<int> rank_counts;
+  std::vector<int> rank_displs;
+
+  std::vector<std::string> var_names;
+  real1d                     stage_dev;   // (nfields,nz,ny,nx,nens)
+  realHost1d                 stage_host;
+  std::array<realHost1d,2>   gather_host; // group root only
+  std::array<bool,2>         gather_busy;
+  int                        gather_next;
+  realHost1d                 zint_host, dz_host, zmid_host;
+
+  pam::AsyncWriter           writer;
+
+
+  OutputWriter() { created = false; async = false; group_comm = MPI_COMM_NULL; }
+  OutputWriter(OutputWriter const &rhs) = delete;
+  OutputWriter &operator=(OutputWriter const &rhs) = delete;
+  ~OutputWriter() { finalize(); }
+
+
+  void initialize( pam::PamCoupler const &coupler , std::string out_prefix , int ranks_per_file , bool async ) {
+    using yakl::c::parallel_for;
+    using yakl::c::SimpleBounds;
+
+    if (ranks_per_file < 1) { endrun("ERROR: out_ranks_per_file must be positive"); }
+
+    this->out_prefix     = out_prefix;
+    this->ranks_per_file = ranks_per_file;
+    this->async          = async;
+    this->created        = false;
+    mpi_real = std::is_same<real,float>::value ? MPI_FLOAT : MPI_DOUBLE;
+    dx   = coupler.get_dx();
+    dy   = coupler.get_dy();
+    nx   = coupler.get_nx();
+    ny   = coupler.get_ny();
+    nz   = coupler.get_nz();
+    nens = coupler.get_nens();
+
+    int myrank;
+    MPI_Comm_rank( MPI_COMM_WORLD , &myrank );
+    group = myrank / ranks_per_file;
+    MPI_Comm_split( MPI_COMM_WORLD , group , myrank , &group_comm );
+    MPI_Comm_rank( group_comm , &group_rank );
+    MPI_Comm_size( group_comm , &group_size );
+
+    var_names = {"density","uvel","vvel","wvel","temperature"};
+    for (auto &name : coupler.get_tracer_names()) { var_names.push_back(name); }
+    int nfields = var_names.size();
+    int size = nfields*nz*ny*nx*nens;
+
+    // Every rank gets every rank's extents, so that all of them agree on whether the group can share a file
+    int extents[3] = {nx, ny, nens};
+    std::vector<int> rank_extents(3*group_size);
+    MPI_Allgather( extents , 3 , MPI_INT , rank_extents.data() , 3 , MPI_INT , group_comm );
+    rank_nx  .resize(group_size);
+    rank_ny  .resize(group_size);
+    rank_nens.resize(group_size);
+    for (int r=0; r < group_size; r++) {
+      rank_nx  [r] = rank_extents[3*r+0];
+      rank_ny  [r] = rank_extents[3*r+1];
+      rank_nens[r] = rank_extents[3*r+2];
+      // The file's x and y dimensions are shared by all ensembles in it, which uneven inner_mpi partitions break
+      if (rank_nx[r] != rank_nx[0] || rank_ny[r] != rank_ny[0]) {
+        endrun("ERROR: out_ranks_per_file > 1 requires every rank in a file group to have the same crm_nx and crm_ny");
       }
+    }
+    group_nens = 0;
+    rank_counts.resize(group_size);
+    rank_displs.resize(group_size);
+    for (int r=0; r < group_size; r++) {
+      rank_counts[r] = nfields*nz*rank_ny[r]*rank_nx[r]*rank_nens[r];
+      rank_displs[r] = r == 0 ? 0 : rank_displs[r-1] + rank_counts[r-1];
+      group_nens += rank_nens[r];
+    }
 
-      // First, write out standard coupler state
-      real4d data("data",nz,ny,nx,nens);
-      parallel_for( SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int n) { data(k,j,i,n) = fields(0,k,j,i,n); });
-      nc.write1(data,"density"    ,{"z","y","x","nens"},ulIndex,"t");
-      parallel_for( SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int n) { data(k,j,i,n) = fields(1,k,j,i,n); });
-      nc.write1(data,"uvel"       ,{"z","y","x","nens"},ulIndex,"t");
-      parallel_for( SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int n) { data(k,j,i,n) = fields(2,k,j,i,n); });
-      nc.write1(data,"vvel"       ,{"z","y","x","nens"},ulIndex,"t");
-      parallel_for( SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int n) { data(k,j,i,n) = fields(3,k,j,i,n); });
-      nc.write1(data,"wvel"       ,{"z","y","x","nens"},ulIndex,"t");
-      parallel_for( SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int n) { data(k,j,i,n) = fields(4,k,j,i,n); });
-      nc.write1(data,"temperature",{"z","y","x","nens"},ulIndex,"t");
-      for (int tr=0; tr < num_tracers; tr++) {
-        parallel_for( SimpleBounds<4>(nz,ny,nx,nens) , YAKL_LAMBDA (int k, int j, int i, int n) {
-          // data(k,j,i) = fields(5+tr,k,j,i,0) / (state(idR,hs+k,hs+j,hs+i,0) + hyDensCells(k,0));
-          data(k,j,i,n) = fields(5+tr,k,j,i,n);
-        });
-        nc.write1(data,tracer_names[tr],{"z","y","x","nens"},ulIndex,"t");
+    stage_dev  = real1d    ("output stage"     ,size);
+    stage_host = realHost1d("output stage host",size);
+    register_host(stage_host);
+    gather_next = 0;
+    gather_busy = {false,false};
+    if (group_rank == 0) {
+      for (int b=0; b < (async ? 2 : 1); b++) {
+        gather_host[b] = realHost1d("output gather host",rank_displs[group_size-1] + rank_counts[group_size-1]);
       }
+    }
+
+    // the vertical grid is gathered once and written when the file is created
+    auto &dm = coupler.get_data_manager_device_readonly();
+    zint_host = gather_column( dm.get<real const,2>("vertical_interface_height") , nz+1 );
+    dz_host   = gather_column( dm.get<real const,2>("vertical_cell_dz"         ) , nz   );
+    zmid_host = gather_column( dm.get<real const,2>("vertical_midpoint_height" ) , nz   );
+
+    if (async) { writer.start(); }
+  }
+
+
+  void write( pam::PamCoupler const &coupler , real etime ) {
+    using yakl::c::parallel_for;
+    using yakl::c::SimpleBounds;
+
+    auto &dm = coupler.get_data_manager_device_readonly();
+
+    // Create MultiField of all state and tracer full variables, since we're doing the same operation on each
+    std::vector<std::string> tracer_names = coupler.get_tracer_names();
+    int num_tracers = coupler.get_num_tracers();
+    pam::MultiField<real const,4> fields;
+    fields.add_field( dm.get<real const,4>("density_dry") );
+    fields.add_field( dm.get<real const,4>("uvel"       ) );
+    fields.add_field( dm.get<real const,4>("vvel"       ) );
+    fields.add_field( dm.get<real const,4>("wvel"       ) );
+    fields.add_field( dm.get<real const,4>("temp"       ) );
+    for (int tr=0; tr < num_tracers; tr++) {
+      fields.add_field( dm.get<real const,4>(tracer_names[tr]) );
+    }
+
+    // Snapshot every field with one kernel and one device-to-host copy
+    int nfields = var_names.size();
+    YAKL_SCOPE( stage_dev , this->stage_dev );
+    YAKL_SCOPE( nx        , this->nx        );
+    YAKL_SCOPE( ny        , this->ny        );
+    YAKL_SCOPE( nz        , this->nz        );
+    YAKL_SCOPE( nens      , this->nens      );
+    parallel_for( "output snapshot" , SimpleBounds<5>(nfields,nz,ny,nx,nens) , YAKL_LAMBDA (int f, int k, int j, int i, int n) {
+      stage_dev( (((f*nz + k)*ny + j)*nx + i)*nens + n ) = fields(f,k,j,i,n);
+    });
+    stage_dev.deep_copy_to(stage_host);
+    yakl::fence();
+
+    int b = gather_next;
+    gather_next = async ? 1 - b : 0;
+    if (group_rank == 0) {
+      writer.wait  ( [&] () { return !gather_busy[b]; } );
+      writer.locked( [&] () { gather_busy[b] = true;   } );
+    }
+    MPI_Gatherv( stage_host.data() , stage_host.totElems() , mpi_real ,
+                 group_rank == 0 ? gather_host[b].data() : nullptr , rank_counts.data() , rank_displs.data() ,
+                 mpi_real , 0 , group_comm );
 
-    auto uvel_stag = dm.get<real const, 4>("uvel_stag");
-    auto vvel_stag = dm.get<real const, 4>("vvel_stag");
-    auto wvel_stag = dm.get<real const, 4>("wvel_stag");
+    if (group_rank == 0) {
+      writer.submit( [this, b, etime] () {
+        write_file( gather_host[b] , etime );
+        writer.locked( [&] () { gather_busy[b] = false; } );
+      } );
+    }
+  }
+
+
+  // Waits for pending writes and stops the writer thread
+  void finalize() {
+    writer.finalize();
+    if (stage_host.initialized()) {
+      #if defined(YAKL_ARCH_CUDA)
+        cudaHostUnregister(stage_host.data());
+      #elif defined(YAKL_ARCH_HIP)
+        hipHostUnregister(stage_host.data());
+      #endif
+      stage_host = realHost1d();
+    }
+    if (group_comm != MPI_COMM_NULL) {
+      MPI_Comm_free( &group_comm );
+      group_comm = MPI_COMM_NULL;
+    }
+  }
 
-//WRITE OUT OTHER VARIABLES!
 
-      // Close the file
-      nc.close();
+private:
 
+  // page-locked host memory lets the snapshot copy run at full bandwidth
+  static void register_host( realHost1d const &arr ) {
+    #if defined(YAKL_ARCH_CUDA)
+      cudaHostRegister(arr.data(), arr.totElems()*sizeof(real), cudaHostRegisterDefault);
+    #elif defined(YAKL_ARCH_HIP)
+      hipHostRegister(arr.data(), arr.totElems()*sizeof(real), hipHostRegisterDefault);
+    #endif
+  }
 
 
+  // Gathers a (nlev,nens) column array to the group root as (nlev,group_nens)
+  realHost1d gather_column( realConst2d col , int nlev ) {
+    auto col_host = col.createHostCopy();
+    realHost1d send("column send",nlev*nens);
+    for (int n=0; n < nens; n++) {
+      for (int k=0; k < nlev; k++) { send(n*nlev+k) = col_host(k,n); }
+    }
+    std::vector<int> counts(group_size), displs(group_size);
+    for (int r=0; r < group_size; r++) {
+      counts[r] = nlev*rank_nens[r];
+      displs[r] = r == 0 ? 0 : displs[r-1] + counts[r-1];
     }
-    MPI_Barrier(MPI_COMM_WORLD);
+    realHost1d recv;
+    if (group_rank == 0) { recv = realHost1d("column recv",nlev*group_nens); }
+    MPI_Gatherv( send.data() , nlev*nens , mpi_real , group_rank == 0 ? recv.data() : nullptr ,
+                 counts.data() , displs.data() , mpi_real , 0 , group_comm );
+    if (group_rank != 0) { return recv; }
+    // (group_nens,nlev) -> (nlev,group_nens)
+    realHost1d out("column",nlev*group_nens);
+    for (int n=0; n < group_nens; n++) {
+      for (int k=0; k < nlev; k++) { out(k*group_nens+n) = recv(n*nlev+k); }
+    }
+    return out;
   }
-  MPI_Barrier(MPI_COMM_WORLD);
-}
+
+
+  void write_file( realHost1d const &gathered , real etime ) {
+    std::string fname = out_prefix + std::string("_") + std::to_string(group) + std::string(".nc");
+
+    std::lock_guard<std::mutex> lock(pam::netcdf_mutex());
+    yakl::SimpleNetCDF nc;
+    int ulIndex = 0; // Unlimited dimension index to place this data at
+    // Create or open the file
+    if (! created) {
+      nc.create(fname);
+
+      // x-coordinate
+      realHost1d xloc("xloc",nx);
+      realHost1d xp1loc("xp1loc",nx+1);
+      for (int i=0; i < nx  ; i++) { xloc(i)   = (i+0.5)*dx; }
+      for (int i=0; i < nx+1; i++) { xp1loc(i) = (i)*dx;     }
+      nc.write(xloc,"x",{"x"});
+      nc.write(xp1loc,"xp1",{"xp1"});
+
+      // y-coordinate
+      realHost1d yloc("yloc",ny);
+      realHost1d yp1loc("yp1loc",ny+1);
+      for (int i=0; i < ny  ; i++) { yloc(i)   = (i+0.5)*dy; }
+      for (int i=0; i < ny+1; i++) { yp1loc(i) = (i)*dy;     }
+      nc.write(yloc,"y",{"y"});
+      nc.write(yp1loc,"yp1",{"yp1"});
+
+      // z-coordinate
+      nc.write(realHost2d("zmid",zmid_host.data(),nz  ,group_nens),"z"  ,{"z"  ,"nens"});
+      nc.write(realHost2d("dz"  ,dz_host  .data(),nz  ,group_nens),"dz" ,{"z"  ,"nens"});
+      nc.write(realHost2d("zint",zint_host.data(),nz+1,group_nens),"zp1",{"zp1","nens"});
+
+      // where each ensemble entry comes from
+      if (group_size > 1) {
+        intHost1d ens_rank ("ens_rank" ,group_nens);
+        intHost1d ens_index("ens_index",group_nens);
+        for (int r=0, e=0; r < group_size; r++) {
+          for (int n=0; n < rank_nens[r]; n++, e++) {
+            ens_rank (e) = group*ranks_per_file + r;
+            ens_index(e) = n;
+          }
+        }
+        nc.write(ens_rank ,"ens_rank" ,{"nens"});
+        nc.write(ens_index,"ens_index",{"nens"});
+      }
+
+      // Create time variable
+      nc.write1(0._fp,"t",0,"t");
+      created = true;
+    } else {
+      nc.open(fname,yakl::NETCDF_MODE_WRITE);
+      ulIndex = nc.getDimSize("t");
+
+      // Write the elapsed time
+      nc.write1(etime,"t",ulIndex,"t");
+    }
+
+    // Reorder each rank's (nfields,nz,ny,nx,nens) block into one (nz,ny,nx,group_nens) array per field
+    int nfields = var_names.size();
+    realHost4d data("data",nz,ny,nx,group_nens);
+    for (int f=0; f < nfields; f++) {
+      for (int r=0, e0=0; r < group_size; r++) {
+        int rn = rank_nens[r];
+        real const *block = gathered.data() + rank_displs[r];
+        for (int k=0; k < nz; k++) {
+          for (int j=0; j < ny; j++) {
+            for (int i=0; i < nx; i++) {
+              for (int n=0; n < rn; n++) {
+                data(k,j,i,e0+n) = block[ (((f*nz + k)*ny + j)*nx + i)*rn + n ];
+              }
+            }
+          }
+        }
+        e0 += rn;
+      }
+      nc.write1(data,var_names[f],{"z","y","x","nens"},ulIndex,"t");
+    }
+
+    // Close the file
+    nc.close();
+  }
+
+};